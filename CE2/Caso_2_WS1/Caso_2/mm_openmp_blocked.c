@@ -1,12 +1,21 @@
 
 // mm_openmp_blocked.c — Multiplicación de matrices con bloqueo (tiling) y OpenMP
 // Autoría: adaptado para el curso a partir del trabajo previo del equipo (HPCG1).
-// Compilar:  gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_blocked.c -o mm_openmp_blocked
-// Uso:       ./mm_openmp_blocked <n> <threads> <block_size>
+// Compilar:  gcc -O3 -ffast-math -fopenmp -I../../../common mm_openmp_blocked.c ../../../common/bench.c ../../../common/perf_region.c ../../../common/freivalds.c ../../../common/arena.c ../../../common/trace.c -o mm_openmp_blocked -lm
+// Uso:       ./mm_openmp_blocked <n> <threads> <block_size> [2d|3d|task|auto]
 // Notas:
 //  - Se usa B transpuesta (BT) y bloqueo en i,j,k para mejorar localidad de caché.
-//  - Se paraleliza por bloques (i0,j0) con collapse(2).
+//  - Se paraleliza por bloques (i0,j0) con collapse(2); con menos de dos bloques
+//    por hilo (auto, por defecto) también se parte k: ver mm_plan_t.
+//  - Núcleos con una versión por nivel de ISA elegida al arrancar (cpu_isa.h,
+//    CPU_ISA=generic|sse4.2|avx2|avx512 la fuerza): sin -march=native.
 //  - Datos en double; considere float para matrices muy grandes si falta RAM.
+//  - Matrices en páginas de 2 MB alineadas a 64B (arena.h; ARENA_PAGES=4k para
+//    comparar fallos de dTLB).
+//  - C se verifica contra A·B con Freivalds en O(n^2) (VERIFY_TRIALS, freivalds.h);
+//    si falla el programa termina con código 3.
+//  - TRACE_JSON=mm.json deja la línea de tiempo por hilo (bloques y espera en
+//    la barrera final) para chrome://tracing o Perfetto (trace.h).
 
 #define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
@@ -15,6 +24,12 @@
 #include <string.h>
 #include <time.h>
 #include <omp.h>
+#include "bench.h"
+#include "perf_region.h"
+#include "freivalds.h"
+#include "cpu_isa.h"
+#include "arena.h"
+#include "trace.h"
 
 static inline double now_s(void){
     struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -22,9 +37,7 @@ static inline double now_s(void){
 }
 
 static inline void *xaligned_alloc(size_t nbytes){
-    void *p = NULL;
-    if (posix_memalign(&p, 64, nbytes)) return NULL;
-    return p;
+    return arena_alloc(nbytes); // alineado a 64B, páginas de 2 MB
 }
 
 static inline double *alloc_mat(size_t n, int zero){
@@ -39,56 +52,230 @@ static inline void fill_rand(double *A, size_t n, unsigned seed){
     for (size_t i=0;i<n*n;i++) A[i] = (double)(rand()%100)/10.0;
 }
 
+// Fila i de B -> columna i de BT
+static inline CPU_ISA_INLINE void transpose_row_body(const double *B, double *BT, size_t n, size_t i){
+    for (size_t j=0;j<n;j++){
+        BT[j*n + i] = B[i*n + j];
+    }
+}
+CPU_ISA_CLONES(transpose_row, void, (const double *B, double *BT, size_t n, size_t i), (B, BT, n, i))
+
 static inline void transpose(const double *B, double *BT, size_t n){
+    void (*row)(const double *, double *, size_t, size_t) = transpose_row_isa[cpu_isa_level];
     #pragma omp parallel for schedule(static)
     for (size_t i=0;i<n;i++){
-        for (size_t j=0;j<n;j++){
-            BT[j*n + i] = B[i*n + j];
+        row(B, BT, n, i);
+    }
+}
+
+// Bloque (i0..i_max, j0..j_max) de C += A · BT en el tramo k0..k_max:
+// C[i][j] += fila i de A · fila j de BT, solo las columnas k del tramo.
+// Ct apunta al elemento (i0, j0) de la matriz destino, de paso ldc: C + i0*n + j0
+// con ldc = n, o un bloque parcial de bs x bs con ldc = bs.
+static inline CPU_ISA_INLINE void tile_body(const double *A, const double *BT, double *Ct, size_t ldc, size_t n,
+                                            size_t i0, size_t i_max, size_t j0, size_t j_max,
+                                            size_t k0, size_t k_max){
+    for (size_t i=i0;i<i_max;i++){
+        const double *Ai = &A[i*n + k0];
+        double *Ci = &Ct[(i-i0)*ldc];   // fila i del bloque, desde la columna j0
+        for (size_t j=j0;j<j_max;j++){
+            const double *BTj = &BT[j*n + k0];
+            double s = 0.0;
+            #pragma omp simd reduction(+:s)
+            for (size_t k=0;k<k_max-k0;k++){
+                s += Ai[k] * BTj[k];
+            }
+            Ci[j-j0] += s;
         }
     }
 }
+CPU_ISA_CLONES(tile, void,
+               (const double *A, const double *BT, double *Ct, size_t ldc, size_t n, size_t i0, size_t i_max,
+                size_t j0, size_t j_max, size_t k0, size_t k_max),
+               (A, BT, Ct, ldc, n, i0, i_max, j0, j_max, k0, k_max))
+
+typedef void (*tile_fn)(const double *, const double *, double *, size_t, size_t, size_t, size_t,
+                        size_t, size_t, size_t, size_t);
+
+// Reparto del producto:
+//  - 2d:   bloques (i0,j0) con collapse(2) y schedule(static); cada hilo recorre
+//          todo k de sus bloques. Con pocos bloques (n=800, bs=256: 16) sobran hilos.
+//  - 3d:   además se parte k en ks tramos: (bloque, tramo) con schedule(dynamic).
+//          Cada hilo acumula su tramo en un bloque parcial propio y lo suma a C
+//          con el candado del bloque.
+//  - task: lo mismo con tareas: una por (bloque, tramo) escribe su parcial y
+//          una tarea de reducción por bloque, que depende de sus ks parciales,
+//          los suma a C (depend con iterator, OpenMP 5.0 / GCC >= 9).
+//  - auto: 2d si hay al menos dos bloques por hilo, si no 3d.
+typedef enum { SCHED_2D, SCHED_3D, SCHED_TASK, SCHED_AUTO } sched_t;
+static const char *const sched_names[] = { "2d", "3d", "task", "auto" };
+
+typedef struct {
+    sched_t sched;      // resuelto (nunca auto)
+    size_t nb;          // bloques por dimensión
+    size_t ks;          // tramos de k por bloque de C (1 = sin partir k)
+    double *scratch;    // 3d: un bloque bs x bs por hilo; task: uno por (bloque, tramo)
+    omp_lock_t *locks;  // 3d: uno por bloque de C
+} mm_plan_t;
+
+static int plan_init(mm_plan_t *pl, sched_t sched, size_t n, size_t bs, int threads){
+    memset(pl, 0, sizeof *pl);
+    pl->nb = (n + bs - 1) / bs;
+    size_t nt2 = pl->nb * pl->nb;
+    if (sched == SCHED_AUTO) sched = (nt2 >= 2*(size_t)threads) ? SCHED_2D : SCHED_3D;
+    pl->sched = sched;
+    pl->ks = 1;
+    if (sched == SCHED_2D || nt2 == 0) return 0;
+    // Al menos dos piezas por hilo, sin tramos de menos de un bloque de k
+    pl->ks = (2*(size_t)threads + nt2 - 1) / nt2;
+    if (pl->ks > pl->nb) pl->ks = pl->nb;
+    if (pl->ks <= 1){ pl->ks = 1; return 0; }
+    size_t nbuf = (sched == SCHED_3D) ? (size_t)threads : nt2 * pl->ks;
+    pl->scratch = (double*)xaligned_alloc(nbuf * bs * bs * sizeof(double));
+    if (!pl->scratch) return -1;
+    if (sched == SCHED_3D){
+        pl->locks = (omp_lock_t*)malloc(nt2 * sizeof(omp_lock_t));
+        if (!pl->locks) return -1;
+        for (size_t t=0;t<nt2;t++) omp_init_lock(&pl->locks[t]);
+    }
+    return 0;
+}
+
+static void plan_free(mm_plan_t *pl){
+    if (pl->locks){
+        for (size_t t=0;t<pl->nb*pl->nb;t++) omp_destroy_lock(&pl->locks[t]);
+        free(pl->locks);
+    }
+    arena_free(pl->scratch);
+}
+
+// Tramo kc de ks: bloques de k [kc*nb/ks, (kc+1)*nb/ks) del bloque t de C,
+// acumulados en Ct (paso ldc)
+static inline void tile_kchunk(tile_fn tile, const double *A, const double *BT, double *Ct, size_t ldc,
+                               size_t n, size_t bs, const mm_plan_t *pl, size_t t, size_t kc){
+    size_t i0 = (t / pl->nb) * bs, j0 = (t % pl->nb) * bs;
+    size_t i_max = (i0+bs<n)? i0+bs : n;
+    size_t j_max = (j0+bs<n)? j0+bs : n;
+    for (size_t kb = kc*pl->nb/pl->ks; kb < (kc+1)*pl->nb/pl->ks; kb++){
+        size_t k0 = kb*bs;
+        size_t k_max = (k0+bs<n)? k0+bs : n;
+        tile(A, BT, Ct, ldc, n, i0, i_max, j0, j_max, k0, k_max);
+    }
+}
 
-static void mm_blocked(const double *A, const double *BT, double *C, size_t n, size_t bs){
-    #pragma omp parallel for collapse(2) schedule(static)
-    for (size_t i0=0;i0<n;i0+=bs){
-        for (size_t j0=0;j0<n;j0+=bs){
-            for (size_t k0=0;k0<n;k0+=bs){
-                size_t i_max = (i0+bs<n)? i0+bs : n;
-                size_t j_max = (j0+bs<n)? j0+bs : n;
-                size_t k_max = (k0+bs<n)? k0+bs : n;
-                for (size_t i=i0;i<i_max;i++){
-                    double *Ci = &C[i*n + j0];
-                    for (size_t k=k0;k<k_max;k++){
-                        const double aik = A[i*n + k];
-                        const double *BTk = &BT[k*n + j0];
-                        #pragma omp simd
-                        for (size_t j=0;j<j_max-j0;j++){
-                            Ci[j] += aik * BTk[j];
+// C[bloque t] += P (bloque parcial de paso bs)
+static inline void tile_add(double *C, const double *P, size_t n, size_t bs, const mm_plan_t *pl, size_t t){
+    size_t i0 = (t / pl->nb) * bs, j0 = (t % pl->nb) * bs;
+    size_t ih = ((i0+bs<n)? i0+bs : n) - i0;
+    size_t jw = ((j0+bs<n)? j0+bs : n) - j0;
+    for (size_t i=0;i<ih;i++){
+        double *Ci = &C[(i0+i)*n + j0];
+        const double *Pi = &P[i*bs];
+        #pragma omp simd
+        for (size_t j=0;j<jw;j++) Ci[j] += Pi[j];
+    }
+}
+
+// pr: contadores por hilo del reparto (sin la barrera final); NULL = sin contar
+static void mm_blocked(const double *A, const double *BT, double *C, size_t n, size_t bs,
+                       const mm_plan_t *pl, perf_region_t *pr){
+    tile_fn tile = tile_isa[cpu_isa_level];
+    size_t nt2 = pl->nb * pl->nb, ks = pl->ks;
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        trace_thread_name("omp %d", tid);
+        perf_region_begin(pr, tid);
+        TRACE_BEGIN("tiles");
+        if (pl->sched == SCHED_2D || (pl->sched == SCHED_3D && ks == 1)){
+            #pragma omp for collapse(2) schedule(static) nowait
+            for (size_t i0=0;i0<n;i0+=bs){
+                for (size_t j0=0;j0<n;j0+=bs){
+                    for (size_t k0=0;k0<n;k0+=bs){
+                        size_t i_max = (i0+bs<n)? i0+bs : n;
+                        size_t j_max = (j0+bs<n)? j0+bs : n;
+                        size_t k_max = (k0+bs<n)? k0+bs : n;
+                        tile(A, BT, C + i0*n + j0, n, n, i0, i_max, j0, j_max, k0, k_max);
+                    }
+                }
+            }
+        } else if (pl->sched == SCHED_3D){
+            double *P = pl->scratch + (size_t)tid*bs*bs;
+            // Tramo por fuera: piezas vecinas caen en bloques de C distintos
+            // y los candados casi nunca se disputan
+            #pragma omp for schedule(dynamic,1) nowait
+            for (size_t it=0;it<nt2*ks;it++){
+                size_t t = it % nt2, kc = it / nt2;
+                memset(P, 0, bs*bs*sizeof(double));
+                tile_kchunk(tile, A, BT, P, bs, n, bs, pl, t, kc);
+                omp_set_lock(&pl->locks[t]);
+                tile_add(C, P, n, bs, pl, t);
+                omp_unset_lock(&pl->locks[t]);
+            }
+        } else {
+            // Un hilo crea las tareas; todos las ejecutan en la barrera del single
+            #pragma omp single
+            {
+                for (size_t t=0;t<nt2;t++){
+                    if (ks == 1){
+                        #pragma omp task firstprivate(t)
+                        tile_kchunk(tile, A, BT, C + (t/pl->nb)*bs*n + (t%pl->nb)*bs, n, n, bs, pl, t, 0);
+                        continue;
+                    }
+                    for (size_t kc=0;kc<ks;kc++){
+                        double *P = pl->scratch + (t*ks + kc)*bs*bs;
+                        #pragma omp task firstprivate(t, kc, P) depend(out: P[0])
+                        {
+                            memset(P, 0, bs*bs*sizeof(double));
+                            tile_kchunk(tile, A, BT, P, bs, n, bs, pl, t, kc);
                         }
                     }
+                    double *P0 = pl->scratch + t*ks*bs*bs;
+                    #pragma omp task firstprivate(t, P0) depend(iterator(kc=0:ks), in: P0[kc*bs*bs])
+                    {
+                        for (size_t kc=0;kc<ks;kc++) tile_add(C, P0 + kc*bs*bs, n, bs, pl, t);
+                    }
                 }
             }
         }
+        TRACE_END("tiles");
+        perf_region_end(pr, tid);
+        // Barrera explícita solo al trazar: deja a la vista cuánto espera cada
+        // hilo al más lento (todos los hilos toman la misma rama)
+        if (trace_enabled){
+            TRACE_BEGIN("barrier");
+            #pragma omp barrier
+            TRACE_END("barrier");
+        }
     }
 }
 
 int main(int argc, char **argv){
     if (argc < 4){
-        fprintf(stderr, "Uso: %s <n> <threads> <block_size>\n", argv[0]);
+        fprintf(stderr, "Uso: %s <n> <threads> <block_size> [2d|3d|task|auto]\n", argv[0]);
         return 1;
     }
     size_t n = strtoull(argv[1], NULL, 10);
     int threads = atoi(argv[2]);
     size_t bs = strtoull(argv[3], NULL, 10);
     if (bs==0){ fprintf(stderr,"block_size debe ser > 0\n"); return 1; }
+    sched_t sched = SCHED_AUTO;
+    if (argc > 4){
+        int found = 0;
+        for (int i=0;i<=SCHED_AUTO;i++){
+            if (strcmp(argv[4], sched_names[i]) == 0){ sched = (sched_t)i; found = 1; }
+        }
+        if (!found){ fprintf(stderr,"Reparto desconocido: %s (2d|3d|task|auto)\n", argv[4]); return 1; }
+    }
 
     omp_set_num_threads(threads);
     omp_set_dynamic(0);
+    trace_init("mm_openmp_blocked", 0);
 
     double *A = alloc_mat(n, 0);
     double *B = alloc_mat(n, 0);
     double *BT = alloc_mat(n, 0);
-    double *C = alloc_mat(n, 1);
+    double *C = alloc_mat(n, 0);
     if(!A||!B||!BT||!C){
         fprintf(stderr,"Fallo de memoria (n=%zu)\n", n);
         return 2;
@@ -97,14 +284,31 @@ int main(int argc, char **argv){
     fill_rand(A,n,1234); fill_rand(B,n,5678);
 
     double tT0 = now_s();
+    TRACE_BEGIN("transpose");
     transpose(B, BT, n);
+    TRACE_END("transpose");
     double tT1 = now_s();
 
-    double t0 = now_s();
-    mm_blocked(A, BT, C, n, bs);
-    double t1 = now_s();
+    mm_plan_t plan;
+    if (plan_init(&plan, sched, n, bs, threads)){
+        fprintf(stderr,"Fallo de memoria (bloques parciales, n=%zu)\n", n);
+        return 2;
+    }
 
-    double secs = t1 - t0;
+    bench_t b;
+    bench_init(&b, "mm_openmp_blocked", "n=%zu;threads=%d;bs=%zu;isa=%s;sched=%s;ks=%zu", n, threads, bs,
+               cpu_isa_name(), sched_names[plan.sched], plan.ks);
+    // Contadores de hardware del producto por hilo (PERF_CSV, perf_region.h)
+    perf_region_t pr;
+    perf_region_init(&pr, "mm_blocked", threads);
+    while (bench_next(&b)){
+        memset(C, 0, n*n*sizeof(double)); // el producto acumula sobre C
+        double t0 = now_s();
+        mm_blocked(A, BT, C, n, bs, &plan, bench_warming(&b) ? NULL : &pr);
+        bench_add(&b, now_s() - t0);
+    }
+
+    double secs = bench_median(&b);
     double secsT = tT1 - tT0;
     double flops = 2.0 * (double)n * (double)n * (double)n;
     double gflops = (flops / secs) / 1e9;
@@ -117,6 +321,25 @@ int main(int argc, char **argv){
     for (size_t i=0;i<n*n;i++) sink += C[i];
     fprintf(stderr,"checksum=%.3f\n", sink);
 
-    free(A); free(B); free(BT); free(C);
-    return 0;
+    // O(n^2): se puede dejar activa en los benchmarks
+    freivalds_t v;
+    TRACE_BEGIN("verify");
+    int ok = freivalds_check(A, B, C, n, freivalds_trials(), 42, &v);
+    TRACE_END("verify");
+    freivalds_print(&v);
+
+    bench_report(&b, flops, "flop");
+    // Roofline: por bloque de C se leen (n/bs) bloques de A y de BT y se lee
+    // y escribe el de C. Tráfico ~ 16n^3/bs + 16n^2 bytes, AI ~ bs/8
+    bench_roofline(&b, "flop", flops, 16.0*(double)n*(double)n*(double)n/(double)bs + 16.0*(double)n*(double)n);
+    bench_free(&b);
+    perf_region_report(&pr, "openmp_blocked", (long long)n, flops);
+    perf_region_free(&pr);
+
+    plan_free(&plan);
+    arena_free(A); arena_free(B); arena_free(BT); arena_free(C);
+    arena_report("mm_openmp_blocked");
+    arena_release();
+    trace_dump();
+    return ok ? 0 : 3;
 }
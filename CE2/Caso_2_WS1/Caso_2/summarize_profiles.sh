@@ -1,6 +1,6 @@
 #!/usr/bin/env bash
 # summarize_profiles.sh — Extrae métricas clave de results/<HOST> y produce un CSV
-# Lee: perf_stat_*.txt, time_*.txt, massif_*.txt
+# Lee: perf_stat_*.txt, time_*.txt, massif_*.txt, perf_regions.csv
 # Opcional: re-ejecuta mm_openmp_bt / mm_openmp_blocked para capturar GFLOPS de 2048 (t1 y tmax)
 set -euo pipefail
 
@@ -98,7 +98,10 @@ if [[ ${#HOSTS[@]} -eq 0 ]]; then
 fi
 
 # ---------- CSV header ----------
-echo "host,impl,n,threads,elapsed_s,max_rss_kb,ipc,instructions,cycles,cache_misses,cache_refs,task_clock_ms,gflops" > "$OUT_CSV"
+# region/dtlb_misses solo se llenan en las filas de perf_regions.csv (contadores
+# del producto, por hilo "nombre#tid" y total "nombre"); las de perf stat cubren
+# el binario completo y dejan region vacía
+echo "host,impl,n,threads,elapsed_s,max_rss_kb,ipc,instructions,cycles,cache_misses,cache_refs,task_clock_ms,gflops,region,dtlb_misses" > "$OUT_CSV"
 
 # ---------- Recorre cada host ----------
 for host in "${HOSTS[@]}"; do
@@ -121,7 +124,7 @@ for host in "${HOSTS[@]}"; do
 
     gflops=$(capture_gflops "$name" "$N_MED" "$th")
 
-    echo "$host,$name,$N_MED,$th,,,$ipc,$instr,$cycles,$cmiss,$cref,$tclk,$gflops" >> "$OUT_CSV"
+    echo "$host,$name,$N_MED,$th,,,$ipc,$instr,$cycles,$cmiss,$cref,$tclk,$gflops,," >> "$OUT_CSV"
   done
 
   timef="$d/time_omp_blocked_n${N_LARGE}_t${OMP_THREADS_MAX}.txt"
@@ -129,7 +132,11 @@ for host in "${HOSTS[@]}"; do
   if [[ -f "$timef" ]]; then
     IFS=, read -r elapsed rss <<< "$(extract_time_and_rss "$timef")"
     gflops=$(capture_gflops "openmp_blocked" "$N_LARGE" "$OMP_THREADS_MAX")
-    echo "$host,openmp_blocked,$N_LARGE,${OMP_THREADS_MAX},$elapsed,${rss:-},,,,,,,$gflops" >> "$OUT_CSV"
+    echo "$host,openmp_blocked,$N_LARGE,${OMP_THREADS_MAX},$elapsed,${rss:-},,,,,,,$gflops,," >> "$OUT_CSV"
+  fi
+  # Contadores por región (mismas columnas; sin encabezado)
+  if [[ -f "$d/perf_regions.csv" ]]; then
+    tail -n +2 "$d/perf_regions.csv" >> "$OUT_CSV"
   fi
   if [[ -f "$massif_txt" ]]; then
     peak=$(extract_massif_peak "$massif_txt")
@@ -1,13 +1,18 @@
 
 // mm_openmp_bt.c — Multiplicación de matrices A x B con B transpuesta (BT) y OpenMP
 // Autoría: adaptado para el curso a partir del trabajo previo del equipo (HPCG1).
-// Compilar:  gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_bt.c -o mm_openmp_bt
+// Compilar:  gcc -O3 -ffast-math -fopenmp -I../../../common mm_openmp_bt.c ../../../common/bench.c ../../../common/perf_region.c ../../../common/freivalds.c ../../../common/arena.c -o mm_openmp_bt -lm
 // Uso:       ./mm_openmp_bt <n> <threads>
 // Notas:
 //  - Datos en doble precisión (double). Cambiar a float si se requiere menor memoria.
-//  - Alineación a 64B para mejor vectorización/uso de caché.
+//  - Alineación a 64B para mejor vectorización/uso de caché, en páginas de 2 MB
+//    (arena.h; ARENA_PAGES=4k para comparar fallos de dTLB).
 //  - Paralelismo por filas y vectorización del bucle interno con omp simd.
+//  - Núcleos con una versión por nivel de ISA elegida al arrancar (cpu_isa.h,
+//    CPU_ISA=generic|sse4.2|avx2|avx512 la fuerza): sin -march=native.
 //  - Se imprime tiempo, GFLOPS y un checksum simple para evitar eliminación del cálculo.
+//  - C se verifica contra A·B con Freivalds en O(n^2) (VERIFY_TRIALS, freivalds.h);
+//    si falla el programa termina con código 3.
 
 #define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
@@ -16,6 +21,11 @@
 #include <string.h>
 #include <time.h>
 #include <omp.h>
+#include "bench.h"
+#include "perf_region.h"
+#include "freivalds.h"
+#include "cpu_isa.h"
+#include "arena.h"
 
 static inline double now_s(void){
     struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
@@ -23,9 +33,7 @@ static inline double now_s(void){
 }
 
 static inline void *xaligned_alloc(size_t nbytes){
-    void *p = NULL;
-    if (posix_memalign(&p, 64, nbytes)) return NULL; // alineado a 64B
-    return p;
+    return arena_alloc(nbytes); // alineado a 64B, páginas de 2 MB
 }
 
 static inline double *alloc_mat(size_t n, int zero){
@@ -40,28 +48,50 @@ static inline void fill_rand(double *A, size_t n, unsigned seed){
     for (size_t i=0;i<n*n;i++) A[i] = (double)(rand()%100)/10.0; // 0..9.9
 }
 
+// Fila i de B -> columna i de BT
+static inline CPU_ISA_INLINE void transpose_row_body(const double *B, double *BT, size_t n, size_t i){
+    for (size_t j=0;j<n;j++){
+        BT[j*n + i] = B[i*n + j];
+    }
+}
+CPU_ISA_CLONES(transpose_row, void, (const double *B, double *BT, size_t n, size_t i), (B, BT, n, i))
+
 static inline void transpose(const double *B, double *BT, size_t n){
+    void (*row)(const double *, double *, size_t, size_t) = transpose_row_isa[cpu_isa_level];
     #pragma omp parallel for schedule(static)
     for (size_t i=0;i<n;i++){
-        for (size_t j=0;j<n;j++){
-            BT[j*n + i] = B[i*n + j];
-        }
+        row(B, BT, n, i);
     }
 }
 
-// A(nxn) * B(nxn)  usando B^T para localidad fila-fila en el bucle interno
-static void mm_atimes_bt(const double *A, const double *BT, double *C, size_t n){
-    #pragma omp parallel for schedule(static)
-    for (size_t i=0;i<n;i++){
-        double *Ci = &C[i*n];
+// Fila de C = fila Ai de A · cada fila de BT
+static inline CPU_ISA_INLINE void bt_row_body(const double *Ai, const double *BT, double *Ci, size_t n){
+    for (size_t j=0;j<n;j++){
+        const double *BTj = &BT[j*n];
+        double s = 0.0;
+        #pragma omp simd reduction(+:s)
         for (size_t k=0;k<n;k++){
-            const double aik = A[i*n + k];
-            const double *BTk = &BT[k*n];
-            #pragma omp simd
-            for (size_t j=0;j<n;j++){
-                Ci[j] += aik * BTk[j];
-            }
+            s += Ai[k] * BTj[k];
         }
+        Ci[j] = s;
+    }
+}
+CPU_ISA_CLONES(bt_row, void, (const double *Ai, const double *BT, double *Ci, size_t n), (Ai, BT, Ci, n))
+
+// A(nxn) * B(nxn)  usando B^T para localidad fila-fila en el bucle interno:
+// C[i][j] = fila i de A · fila j de BT.
+// pr: contadores por hilo del reparto (sin la barrera final); NULL = sin contar
+static void mm_atimes_bt(const double *A, const double *BT, double *C, size_t n, perf_region_t *pr){
+    void (*row)(const double *, const double *, double *, size_t) = bt_row_isa[cpu_isa_level];
+    #pragma omp parallel
+    {
+        int tid = omp_get_thread_num();
+        perf_region_begin(pr, tid);
+        #pragma omp for schedule(static) nowait
+        for (size_t i=0;i<n;i++){
+            row(&A[i*n], BT, &C[i*n], n);
+        }
+        perf_region_end(pr, tid);
     }
 }
 
@@ -79,7 +109,7 @@ int main(int argc, char **argv){
     double *A = alloc_mat(n, 0);
     double *B = alloc_mat(n, 0);
     double *BT = alloc_mat(n, 0);
-    double *C = alloc_mat(n, 1);
+    double *C = alloc_mat(n, 0);
     if(!A||!B||!BT||!C){
         fprintf(stderr,"Fallo de memoria (n=%zu)\n", n);
         return 2;
@@ -91,11 +121,18 @@ int main(int argc, char **argv){
     transpose(B, BT, n);
     double tT1 = now_s();
 
-    double t0 = now_s();
-    mm_atimes_bt(A, BT, C, n);
-    double t1 = now_s();
+    bench_t b;
+    bench_init(&b, "mm_openmp_bt", "n=%zu;threads=%d;isa=%s", n, threads, cpu_isa_name());
+    // Contadores de hardware del producto por hilo (PERF_CSV, perf_region.h)
+    perf_region_t pr;
+    perf_region_init(&pr, "mm_atimes_bt", threads);
+    while (bench_next(&b)){
+        double t0 = now_s();
+        mm_atimes_bt(A, BT, C, n, bench_warming(&b) ? NULL : &pr);
+        bench_add(&b, now_s() - t0);
+    }
 
-    double secs = t1 - t0;
+    double secs = bench_median(&b);
     double secsT = tT1 - tT0;
     double flops = 2.0 * (double)n * (double)n * (double)n;
     double gflops = (flops / secs) / 1e9;
@@ -108,6 +145,21 @@ int main(int argc, char **argv){
     for (size_t i=0;i<n*n;i++) sink += C[i];
     fprintf(stderr,"checksum=%.3f\n", sink);
 
-    free(A); free(B); free(BT); free(C);
-    return 0;
+    // O(n^2): se puede dejar activa en los benchmarks
+    freivalds_t v;
+    int ok = freivalds_check(A, B, C, n, freivalds_trials(), 42, &v);
+    freivalds_print(&v);
+
+    bench_report(&b, flops, "flop");
+    // Roofline: cada fila i recorre BT completa (8n^2 bytes); la fila de C y
+    // la de A quedan en caché. Tráfico ~ 8n^3 + 16n^2 bytes, AI ~ 0.25
+    bench_roofline(&b, "flop", flops, 8.0*(double)n*(double)n*(double)n + 16.0*(double)n*(double)n);
+    bench_free(&b);
+    perf_region_report(&pr, "openmp_bt", (long long)n, flops);
+    perf_region_free(&pr);
+
+    arena_free(A); arena_free(B); arena_free(BT); arena_free(C);
+    arena_report("mm_openmp_bt");
+    arena_release();
+    return ok ? 0 : 3;
 }
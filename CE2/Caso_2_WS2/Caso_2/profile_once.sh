@@ -40,8 +40,8 @@ if [[ "$need_build" -eq 1 ]]; then
   if command -v make >/dev/null 2>&1 && [[ -f Makefile ]]; then
     make
   else
-    gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_bt.c -o mm_openmp_bt
-    gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_blocked.c -o mm_openmp_blocked
+    gcc -O3 -ffast-math -fopenmp -I../../../common mm_openmp_bt.c ../../../common/bench.c ../../../common/perf_region.c ../../../common/freivalds.c ../../../common/arena.c -o mm_openmp_bt -lm
+    gcc -O3 -ffast-math -fopenmp -I../../../common mm_openmp_blocked.c ../../../common/bench.c ../../../common/perf_region.c ../../../common/freivalds.c ../../../common/arena.c ../../../common/trace.c -o mm_openmp_blocked -lm
   fi
 fi
 
@@ -113,10 +113,23 @@ run_memory_tools() {
   fi
 }
 
+# ---------- Helper contadores por región (perf_region.h) ----------
+# A diferencia de perf stat, cuentan solo el producto y por hilo; si el
+# sistema no permite perf_event_open quedan solo los tiempos.
+run_perf_region() {
+  local label="$1"; shift
+  local cmd=("$@")
+  echo "[*] perf_region ($label) → ${OUTDIR}/perf_regions.csv"
+  PERF_CSV="${OUTDIR}/perf_regions.csv" "${cmd[@]}" 1>/dev/null 2>>"${OUTDIR}/perf_regions.err" || true
+}
+rm -f "${OUTDIR}/perf_regions.csv" "${OUTDIR}/perf_regions.err"
+
 # ---------- Perfilado: OpenMP BLOQUEADO (recomendado) ----------
 echo "[*] Perfilando OpenMP (blocked)"
 run_perf_stat "omp_blocked_n${N_MED}_t1"        "${OPENMP_BLK_BIN}" "${N_MED}" 1 "${BLOCK_SIZE}"
 run_perf_stat "omp_blocked_n${N_MED}_t${OMP_THREADS_MAX}" "${OPENMP_BLK_BIN}" "${N_MED}" "${OMP_THREADS_MAX}" "${BLOCK_SIZE}"
+run_perf_region "omp_blocked_n${N_MED}_t1"        "${OPENMP_BLK_BIN}" "${N_MED}" 1 "${BLOCK_SIZE}"
+run_perf_region "omp_blocked_n${N_MED}_t${OMP_THREADS_MAX}" "${OPENMP_BLK_BIN}" "${N_MED}" "${OMP_THREADS_MAX}" "${BLOCK_SIZE}"
 
 # Hotspots con tamaño grande y todos los hilos
 run_perf_record "omp_blocked_n${N_LARGE}_t${OMP_THREADS_MAX}" "${OPENMP_BLK_BIN}" "${N_LARGE}" "${OMP_THREADS_MAX}" "${BLOCK_SIZE}"
@@ -128,6 +141,8 @@ run_memory_tools "omp_blocked_n${N_LARGE}_t${OMP_THREADS_MAX}" "${OPENMP_BLK_BIN
 echo "[*] Perfilando OpenMP (BT)"
 run_perf_stat "omp_bt_n${N_MED}_t1"        "${OPENMP_BT_BIN}" "${N_MED}" 1
 run_perf_stat "omp_bt_n${N_MED}_t${OMP_THREADS_MAX}" "${OPENMP_BT_BIN}" "${N_MED}" "${OMP_THREADS_MAX}"
+run_perf_region "omp_bt_n${N_MED}_t1"        "${OPENMP_BT_BIN}" "${N_MED}" 1
+run_perf_region "omp_bt_n${N_MED}_t${OMP_THREADS_MAX}" "${OPENMP_BT_BIN}" "${N_MED}" "${OMP_THREADS_MAX}"
 
 # ---------- Resumen ----------
 echo
@@ -6,8 +6,18 @@ set -euo pipefail
 SIZES="${SIZES:-512 1024 1536 2048}"
 THREADS="${THREADS:-1 2 4 8 16}"
 BLOCK_SIZE="${BLOCK_SIZE:-128}"
+# Reparto de mm_openmp_blocked: 2d | 3d | task | auto
+SCHED="${SCHED:-auto}"
 REPS="${REPS:-3}"
 OUT="${OUT:-results.csv}"
+# Fila por ejecución con las estadísticas del núcleo medidas dentro del
+# programa (bench.h): BENCH_REPS repeticiones tras BENCH_WARMUP de calentamiento
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV="${BENCH_CSV:-results_bench.csv}"
+export BENCH_WARMUP="${BENCH_WARMUP:-1}"
+export BENCH_REPS="${BENCH_REPS:-5}"
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV="${ROOFLINE_CSV:-results_roofline.csv}"
 
 # Afinidad y comportamiento de OMP
 export OMP_PLACES=${OMP_PLACES:-cores}
@@ -15,6 +25,10 @@ export OMP_PROC_BIND=${OMP_PROC_BIND:-close}
 export OMP_DYNAMIC=${OMP_DYNAMIC:-false}
 
 echo "machine,compiler,n,prog,threads,block_size,run,time_s,gflops,transpose_s,checksum" > "$OUT"
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
 
 machine="$(hostname)"
 compiler="$(${CC:-gcc} -v 2>&1 | tail -n1 | sed 's/^Configured with://;s/^[ ]*//g' || true)"
@@ -65,9 +79,9 @@ for n in $SIZES; do
   for t in $THREADS; do
     for run in $(seq 1 "$REPS"); do
       run_prog mm_openmp_bt "$n" "$t"
-      run_prog mm_openmp_blocked "$n" "$t" "$BLOCK_SIZE"
+      run_prog mm_openmp_blocked "$n" "$t" "$BLOCK_SIZE" "$SCHED"
     done
   done
 done
 
-echo "Resultados guardados en $OUT"
+echo "Resultados guardados en $OUT (núcleo: $BENCH_CSV)"
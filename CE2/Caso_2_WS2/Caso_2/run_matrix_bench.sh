@@ -15,6 +15,20 @@ PROCS=(${PROCS:-0 2 4 8 16 32})
 RAW_CSV="${RAW_CSV:-results_raw.csv}"
 AVG_CSV="${AVG_CSV:-results_avg.csv}"
 LOG_DIR="${LOG_DIR:-logs}"
+# Tiempos del núcleo medidos dentro de cada programa OpenMP (bench.h): una
+# fila por ejecución con mediana, mínimo, desviación e IC95 de BENCH_REPS
+# repeticiones tras BENCH_WARMUP de calentamiento
+COMMON="${COMMON:-../../../common}"
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV="${BENCH_CSV:-results_bench.csv}"
+export BENCH_WARMUP="${BENCH_WARMUP:-0}"
+export BENCH_REPS="${BENCH_REPS:-1}"
+# Coordenadas roofline por ejecución (bench_roofline); los techos de la
+# máquina salen de $COMMON/roofline.c (ver README)
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV="${ROOFLINE_CSV:-results_roofline.csv}"
+# Páginas de las matrices (arena.h): huge | thp | 4k (línea base de dTLB)
+export ARENA_PAGES="${ARENA_PAGES:-huge}"
 
 # -------- Helpers --------
 
@@ -95,7 +109,7 @@ fi
 
 # OpenMP (BT y Bloques)
 if [[ -f mm_openmp_bt.c ]]; then
-  gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_bt.c -o mm_openmp_bt
+  gcc -O3 -ffast-math -fopenmp -I"$COMMON" mm_openmp_bt.c "$COMMON/bench.c" "$COMMON/perf_region.c" "$COMMON/freivalds.c" "$COMMON/arena.c" -o mm_openmp_bt -lm
   HAVE_OMP_BT=1
 else
   log "ADVERTENCIA: mm_openmp_bt.c no encontrado. Se omite OpenMP (BT)."
@@ -103,7 +117,7 @@ else
 fi
 
 if [[ -f mm_openmp_blocked.c ]]; then
-  gcc -O3 -march=native -ffast-math -fopenmp mm_openmp_blocked.c -o mm_openmp_blocked
+  gcc -O3 -ffast-math -fopenmp -I"$COMMON" mm_openmp_blocked.c "$COMMON/bench.c" "$COMMON/perf_region.c" "$COMMON/freivalds.c" "$COMMON/arena.c" "$COMMON/trace.c" -o mm_openmp_blocked -lm
   HAVE_OMP_BLOCKED=1
 else
   log "ADVERTENCIA: mm_openmp_blocked.c no encontrado. Se omite OpenMP (blocked)."
@@ -115,6 +129,10 @@ log "Compilación completada."
 # -------- Prepare outputs --------
 mkdir -p "$LOG_DIR"
 echo "impl,size,workers,iter,seconds" > "$RAW_CSV"
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
 
 # Afinidad y comportamiento recomendado de OpenMP (sobrescribible por env)
 export OMP_PLACES=${OMP_PLACES:-cores}
@@ -178,7 +196,7 @@ if [[ "$HAVE_OMP_BT" -eq 1 || "$HAVE_OMP_BLOCKED" -eq 1 ]]; then
         fi
         if [[ "$HAVE_OMP_BLOCKED" -eq 1 ]]; then
           bs="${BLOCK_SIZE:-128}"
-          secs=$(run_with_timing ./mm_openmp_blocked "$size" "$th" "$bs")
+          secs=$(run_with_timing ./mm_openmp_blocked "$size" "$th" "$bs" "${SCHED:-auto}")
           echo "openmp_blocked,$size,$th,$it,$secs" >> "$RAW_CSV"
           echo "openmp_blocked size=$size threads=$th bs=$bs iter=$it -> $secs s" >> "$LOG_DIR/openmp.log"
         fi
@@ -202,5 +220,6 @@ END {
 log "Listo. Resultados:"
 log "  - Crudos:   $RAW_CSV"
 log "  - Promedio: $AVG_CSV"
+log "  - Núcleo:   $BENCH_CSV"
 log "  - Logs:     $LOG_DIR/*.log"
 log "  - Respaldo del script original: run_matrix_bench.original.sh"
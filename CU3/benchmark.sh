@@ -18,6 +18,22 @@ MATRIX_SIZES=(600 1200 1800 2400)
 NUM_PROCESSES=(1 2 4 6)
 REPETITIONS=10
 
+# Arnés de medición común (copia de <repo>/common en el directorio compartido):
+# cada ejecución añade a BENCH_CSV la mediana, desviación e IC95 de BENCH_REPS
+# repeticiones del núcleo tras BENCH_WARMUP de calentamiento
+COMMON=${COMMON:-/shared/common}
+export BENCH_CSV=${BENCH_CSV:-$OUTPUT_DIR/bench_$TIMESTAMP.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+# Coordenadas roofline por ejecución (bench_roofline); ver generate_summary.py --roofline
+export ROOFLINE_CSV=${ROOFLINE_CSV:-$OUTPUT_DIR/roofline_$TIMESTAMP.csv}
+# Pruebas de Freivalds por ejecución sobre C (freivalds.h); 0 las desactiva
+export VERIFY_TRIALS=${VERIFY_TRIALS:-2}
+# Nivel de ISA de los núcleos (cpu_isa.h): native = el mayor de cada nodo
+export CPU_ISA=${CPU_ISA:-native}
+# Páginas de las matrices (arena.h): huge | thp | 4k
+export ARENA_PAGES=${ARENA_PAGES:-huge}
+
 echo "========================================================"
 echo "    BENCHMARK COMPLETO - MULTIPLICACION DE MATRICES"
 echo "========================================================"
@@ -48,7 +64,7 @@ for size in "${MATRIX_SIZES[@]}"; do
     sed "s/SIZE_PLACEHOLDER/$size/g" /shared/matrix_mult_template.c > /shared/matrix_temp.c
     
     # Compilar el programa
-    mpicc -o /shared/matrix_temp /shared/matrix_temp.c -lm 2>/dev/null
+    mpicc -O3 -fopenmp-simd -I$COMMON -o /shared/matrix_temp /shared/matrix_temp.c $COMMON/bench.c $COMMON/freivalds.c $COMMON/arena.c -lm 2>/dev/null
     
     if [ $? -ne 0 ]; then
         echo "Error compilando para tamano $size"
@@ -68,10 +84,11 @@ for size in "${MATRIX_SIZES[@]}"; do
             
             # Ejecutar el benchmark
             if [ $np -eq 1 ]; then
-                RESULT=$(mpirun -np 1 /shared/matrix_temp 2>/dev/null)
+                RESULT=$(mpirun -np 1 -x BENCH_CSV -x BENCH_WARMUP -x BENCH_REPS -x ROOFLINE_CSV -x VERIFY_TRIALS -x CPU_ISA -x ARENA_PAGES /shared/matrix_temp 2>/dev/null)
             else
-                RESULT=$(mpirun -np $np --hostfile /shared/hostfile /shared/matrix_temp 2>/dev/null)
+                RESULT=$(mpirun -np $np --hostfile /shared/hostfile -x BENCH_CSV -x BENCH_WARMUP -x BENCH_REPS -x ROOFLINE_CSV -x VERIFY_TRIALS -x CPU_ISA -x ARENA_PAGES /shared/matrix_temp 2>/dev/null)
             fi
+            RC=$?
             
             # Extraer tiempo y GFLOPS
             TIME=$(echo $RESULT | cut -d',' -f1)
@@ -81,6 +98,9 @@ for size in "${MATRIX_SIZES[@]}"; do
             echo "$size,$np,$rep,$TIME,$GFLOPS" >> $CSV_FILE
             
             printf "Tiempo: %.4fs, GFLOPS: %.2f\n" $TIME $GFLOPS
+            if [ $RC -eq 3 ]; then
+                echo "    ADVERTENCIA: C no paso la verificacion de Freivalds"
+            fi
             
             # Pequeña pausa entre ejecuciones
             sleep 0.5
@@ -90,14 +110,51 @@ for size in "${MATRIX_SIZES[@]}"; do
     echo ""
 done
 
+# Producto disperso (sp_mpi.c + sparse.c): A de n x n con SPARSE_NNZ no ceros
+# por fila, repartida por no ceros; tiempo, GFLOPS y GB/s efectivos
+SPARSE_SIZES=(${SPARSE_SIZES:-250000 1000000})
+SPARSE_NNZ=${SPARSE_NNZ:-16}
+SPARSE_GEN=${SPARSE_GEN:-skew}
+SPARSE_CSV="$OUTPUT_DIR/sparse_$TIMESTAMP.csv"
+if [ -f /shared/sp_mpi.c ]; then
+    mpicc -O3 -fopenmp-simd -I$COMMON -o /shared/sp_mpi /shared/sp_mpi.c $COMMON/sparse.c $COMMON/bench.c $COMMON/arena.c -lm 2>/dev/null
+    if [ $? -ne 0 ]; then
+        echo "Error compilando sp_mpi"
+    else
+        echo "================================================"
+        echo "  PRODUCTO DISPERSO ($SPARSE_GEN, $SPARSE_NNZ no ceros por fila)"
+        echo "================================================"
+        echo "Tamano_Matriz,Num_Procesos,Repeticion,Tiempo_Segundos,GFLOPS,GBs" > $SPARSE_CSV
+        for size in "${SPARSE_SIZES[@]}"; do
+            for np in "${NUM_PROCESSES[@]}"; do
+                for rep in $(seq 1 $REPETITIONS); do
+                    if [ $np -eq 1 ]; then
+                        RESULT=$(mpirun -np 1 -x BENCH_CSV -x BENCH_WARMUP -x BENCH_REPS -x ROOFLINE_CSV -x CPU_ISA -x ARENA_PAGES /shared/sp_mpi $size $SPARSE_NNZ $SPARSE_GEN 2>/dev/null)
+                    else
+                        RESULT=$(mpirun -np $np --hostfile /shared/hostfile -x BENCH_CSV -x BENCH_WARMUP -x BENCH_REPS -x ROOFLINE_CSV -x CPU_ISA -x ARENA_PAGES /shared/sp_mpi $size $SPARSE_NNZ $SPARSE_GEN 2>/dev/null)
+                    fi
+                    if [ $? -eq 3 ]; then
+                        echo "    ADVERTENCIA: Y no paso la verificacion (n=$size, np=$np)"
+                    fi
+                    echo "$size,$np,$rep,$RESULT" >> $SPARSE_CSV
+                done
+                printf "  n=%d np=%d -> %s\n" $size $np "$RESULT"
+            done
+        done
+        echo ""
+    fi
+fi
+
 # Limpiar archivos temporales
-rm -f /shared/matrix_temp /shared/matrix_temp.c
+rm -f /shared/matrix_temp /shared/matrix_temp.c /shared/sp_mpi
 
 echo "========================================================"
 echo "           BENCHMARKING COMPLETADO"
 echo "========================================================"
 echo ""
 echo "Resultados guardados en: $CSV_FILE"
+echo "Estadisticas del nucleo en: $BENCH_CSV"
+[ -f $SPARSE_CSV ] && echo "Producto disperso en: $SPARSE_CSV"
 echo "Total de pruebas realizadas: $CURRENT_TEST"
 echo ""
 
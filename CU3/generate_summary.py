@@ -106,9 +106,85 @@ def generate_summary(csv_file):
         print(f"Error al procesar el archivo: {e}")
         sys.exit(1)
 
+def plot_roofline(machine_csv, runs_csv, output_png):
+    """
+    Sitúa cada corrida en el modelo roofline de su máquina
+
+    Args:
+        machine_csv: techos de common/roofline.c (host,threads,peak_gflops,...)
+        runs_csv: coordenadas de bench_roofline (ROOFLINE_CSV)
+        output_png: gráfica de salida (solo si matplotlib está disponible)
+    """
+    try:
+        machines = pd.read_csv(machine_csv).groupby('host').last()
+        runs = pd.read_csv(runs_csv)
+    except FileNotFoundError as e:
+        print(f"Error: No se encontró el archivo {e.filename}")
+        sys.exit(1)
+
+    levels = [('l1_gbs', 'L1'), ('l2_gbs', 'L2'), ('l3_gbs', 'L3'), ('dram_gbs', 'DRAM')]
+
+    print("\n" + "="*70)
+    print("                    MODELO ROOFLINE")
+    print("="*70 + "\n")
+    print(f"  {'Programa':<24} {'Host':<14} {'AI':>8} {'Gop/s':>10} {'Techo':>10} {'%':>6}  Límite")
+    for _, run in runs.iterrows():
+        if run['host'] not in machines.index:
+            continue
+        m = machines.loc[run['host']]
+        ai = run['ai']
+        # Sin tráfico (AI vacía) el único techo es el de cómputo
+        mem_roof = m['dram_gbs'] * ai if pd.notna(ai) else float('inf')
+        # Los autómatas hacen operaciones enteras: solo el techo de memoria aplica
+        roof = mem_roof if run['op'] != 'flop' else min(m['peak_gflops'], mem_roof)
+        bound = 'memoria' if roof == mem_roof else 'cómputo'
+        ai_txt = f"{ai:.3f}" if pd.notna(ai) else '-'
+        print(f"  {run['prog']:<24} {run['host']:<14} {ai_txt:>8} {run['gops_s']:>10.3f} {roof:>10.3f} "
+              f"{100.0 * run['gops_s'] / roof:>6.1f}  {bound}")
+    print("\n" + "="*70 + "\n")
+
+    try:
+        import matplotlib
+        matplotlib.use('Agg')
+        import matplotlib.pyplot as plt
+        import numpy as np
+    except ImportError:
+        print("Nota: instala matplotlib para la gráfica (python3-matplotlib)")
+        return
+
+    fig, ax = plt.subplots(figsize=(9, 6))
+    finite = runs['ai'].dropna()
+    ai_max = max(64.0, finite.max() * 4 if len(finite) else 64.0)
+    x = np.logspace(-3, np.log10(ai_max), 200)
+    for host, m in machines.iterrows():
+        for col, name in levels:
+            ax.plot(x, np.minimum(m['peak_gflops'], m[col] * x), '--', linewidth=1,
+                    label=f"{host} {name} ({m[col]:.0f} GB/s)")
+        ax.axhline(m['peak_gflops'], color='gray', linewidth=1)
+    for prog, group in runs.groupby('prog'):
+        # Núcleos sin tráfico de memoria: al extremo derecho del eje
+        xs = group['ai'].fillna(ai_max)
+        ax.scatter(xs, group['gops_s'], label=prog, zorder=3)
+    ax.set_xscale('log')
+    ax.set_yscale('log')
+    ax.set_xlabel('Intensidad aritmética (op/byte)')
+    ax.set_ylabel('Rendimiento (Gop/s)')
+    ax.set_title('Roofline')
+    ax.grid(True, which='both', alpha=0.3)
+    ax.legend(fontsize=7)
+    fig.tight_layout()
+    fig.savefig(output_png, dpi=150)
+    print(f"Gráfica guardada en: {output_png}\n")
+
 def main():
+    if len(sys.argv) >= 4 and sys.argv[1] == '--roofline':
+        output_png = sys.argv[4] if len(sys.argv) > 4 else 'roofline.png'
+        plot_roofline(sys.argv[2], sys.argv[3], output_png)
+        return
+
     if len(sys.argv) < 2:
         print("Uso: python3 generate_summary.py <archivo_csv>")
+        print("     python3 generate_summary.py --roofline <roofline_machine.csv> <roofline_runs.csv> [salida.png]")
         print("Ejemplo: python3 generate_summary.py resultados/benchmark_20241120.csv")
         sys.exit(1)
     
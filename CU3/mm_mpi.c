@@ -5,12 +5,25 @@
  * usando paralelismo con MPI distribuyendo filas de la matriz A
  * entre múltiples procesos.
  * 
+ * Compilar: mpicc -O3 -fopenmp-simd -I../common mm_mpi.c ../common/bench.c ../common/freivalds.c ../common/arena.c -o mm_mpi -lm
+ * (con N sustituido en SIZE_PLACEHOLDER, ver benchmark.sh). El tiempo es la
+ * mediana de BENCH_REPS repeticiones tras BENCH_WARMUP de calentamiento
+ * (bench.h). Rank 0 verifica C = A·B con Freivalds en O(N^2) (VERIFY_TRIALS,
+ * freivalds.h) y termina con código 3 si falla. El producto local tiene una
+ * versión por nivel de ISA elegida al arrancar en cada rank (cpu_isa.h;
+ * CPU_ISA la fuerza), así los nodos de un clúster heterogéneo usan cada uno
+ * la suya con el mismo binario. Las matrices van en páginas de 2 MB (arena.h;
+ * ARENA_PAGES=4k para comparar fallos de dTLB).
  */
 
 #include <mpi.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include "bench.h"
+#include "freivalds.h"
+#include "cpu_isa.h"
+#include "arena.h"
 
 #define N SIZE_PLACEHOLDER
 
@@ -23,6 +36,26 @@ void initialize_matrix(double *matrix, int rows, int cols) {
     }
 }
 
+/**
+ * Fila de C = fila Ai de A × B, en orden i-k-j: el bucle interno recorre una
+ * fila de B y una de C de forma contigua y se vectoriza. Cada C[i][j] suma
+ * los productos en el mismo orden de k que el bucle i-j-k.
+ */
+static inline CPU_ISA_INLINE void mm_row_body(const double *Ai, const double *B, double *Ci) {
+    for (int j = 0; j < N; j++) {
+        Ci[j] = 0.0;
+    }
+    for (int k = 0; k < N; k++) {
+        const double aik = Ai[k];
+        const double *Bk = &B[k * N];
+        #pragma omp simd
+        for (int j = 0; j < N; j++) {
+            Ci[j] += aik * Bk[j];
+        }
+    }
+}
+CPU_ISA_CLONES(mm_row, void, (const double *Ai, const double *B, double *Ci), (Ai, B, Ci))
+
 int main(int argc, char *argv[]) {
     int rank, size_proc;
     double *A = NULL;       // Matriz A (completa, solo en rank 0)
@@ -31,6 +64,7 @@ int main(int argc, char *argv[]) {
     double *local_A = NULL; // Porción de A para cada proceso
     double *local_C = NULL; // Porción de C para cada proceso
     double start_time, end_time, total_time;
+    int ok = 1;
     
     MPI_Init(&argc, &argv);
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -46,9 +80,9 @@ int main(int argc, char *argv[]) {
     
     // Inicializar matrices en el proceso maestro (rank 0)
     if (rank == 0) {
-        A = (double *)malloc(N * N * sizeof(double));
-        B = (double *)malloc(N * N * sizeof(double));
-        C = (double *)malloc(N * N * sizeof(double));
+        A = (double *)arena_alloc(N * N * sizeof(double));
+        B = (double *)arena_alloc(N * N * sizeof(double));
+        C = (double *)arena_alloc(N * N * sizeof(double));
         
         srand(time(NULL));
         initialize_matrix(A, N, N);
@@ -57,60 +91,70 @@ int main(int argc, char *argv[]) {
     
     // Todos los procesos necesitan la matriz B completa
     if (rank != 0) {
-        B = (double *)malloc(N * N * sizeof(double));
+        B = (double *)arena_alloc(N * N * sizeof(double));
     }
     
     // Broadcast: enviar matriz B a todos los procesos
     MPI_Bcast(B, N * N, MPI_DOUBLE, 0, MPI_COMM_WORLD);
     
     // Cada proceso recibe su porción de A y reserva espacio para su porción de C
-    local_A = (double *)malloc(rows_per_process * N * sizeof(double));
-    local_C = (double *)malloc(rows_per_process * N * sizeof(double));
-    
-    // Sincronizar antes de medir tiempo
-    MPI_Barrier(MPI_COMM_WORLD);
-    start_time = MPI_Wtime();
+    local_A = (double *)arena_alloc(rows_per_process * N * sizeof(double));
+    local_C = (double *)arena_alloc(rows_per_process * N * sizeof(double));
     
-    // Scatter: distribuir filas de A entre los procesos
-    MPI_Scatter(A, rows_per_process * N, MPI_DOUBLE,
-                local_A, rows_per_process * N, MPI_DOUBLE,
-                0, MPI_COMM_WORLD);
-    
-    // Cada proceso calcula su porción de C = local_A × B
-    for (int i = 0; i < rows_per_process; i++) {
-        for (int j = 0; j < N; j++) {
-            local_C[i * N + j] = 0.0;
-            for (int k = 0; k < N; k++) {
-                local_C[i * N + j] += local_A[i * N + k] * B[k * N + j];
-            }
+    // Repeticiones del arnés: rank 0 decide cuántas para que todos coincidan
+    bench_t bench;
+    bench_init(&bench, "mm_mpi", "n=%d;procs=%d;isa=%s", N, size_proc, cpu_isa_name());
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    while (bench_next(&bench)) {
+        // Sincronizar antes de medir tiempo
+        MPI_Barrier(MPI_COMM_WORLD);
+        start_time = MPI_Wtime();
+        
+        // Scatter: distribuir filas de A entre los procesos
+        MPI_Scatter(A, rows_per_process * N, MPI_DOUBLE,
+                    local_A, rows_per_process * N, MPI_DOUBLE,
+                    0, MPI_COMM_WORLD);
+        
+        // Cada proceso calcula su porción de C = local_A × B
+        for (int i = 0; i < rows_per_process; i++) {
+            mm_row_isa[cpu_isa_level](&local_A[i * N], B, &local_C[i * N]);
         }
+        
+        // Gather: recolectar resultados parciales en el proceso maestro
+        MPI_Gather(local_C, rows_per_process * N, MPI_DOUBLE,
+                   C, rows_per_process * N, MPI_DOUBLE,
+                   0, MPI_COMM_WORLD);
+        
+        // Sincronizar después del cálculo: el tiempo de rank 0 es el del más lento
+        MPI_Barrier(MPI_COMM_WORLD);
+        end_time = MPI_Wtime();
+        bench_add(&bench, end_time - start_time);
     }
-    
-    // Gather: recolectar resultados parciales en el proceso maestro
-    MPI_Gather(local_C, rows_per_process * N, MPI_DOUBLE,
-               C, rows_per_process * N, MPI_DOUBLE,
-               0, MPI_COMM_WORLD);
-    
-    // Sincronizar después del cálculo
-    MPI_Barrier(MPI_COMM_WORLD);
-    end_time = MPI_Wtime();
-    total_time = end_time - start_time;
+    total_time = bench_median(&bench);
     
     // El proceso maestro imprime los resultados
     if (rank == 0) {
         double gflops = (2.0 * N * N * N) / (total_time * 1e9);
         printf("%.6f,%.2f\n", total_time, gflops);
+        bench_report(&bench, 2.0 * N * N * N, "flop");
+        // Roofline: cada fila de local_A recorre B completa por filas
+        // (8N^2 bytes; la fila de C sigue en caché).
+        // Tráfico ~ 8N^3 + 16N^2 bytes, AI ~ 0.25 (sin Scatter/Gather)
+        bench_roofline(&bench, "flop", 2.0 * N * N * N, 8.0 * N * N * N + 16.0 * N * N);
+
+        // C de la última repetición contra A·B, sin referencia O(N^3)
+        freivalds_t v;
+        ok = freivalds_check(A, B, C, N, freivalds_trials(), 42, &v);
+        freivalds_print(&v);
     }
+    bench_free(&bench);
     
-    // Liberar memoria
-    free(local_A);
-    free(local_C);
-    free(B);
-    if (rank == 0) {
-        free(A);
-        free(C);
-    }
+    // Liberar memoria (rank 0 resume antes qué quedó en páginas grandes)
+    if (rank == 0) arena_report("mm_mpi");
+    arena_release();
     
     MPI_Finalize();
-    return 0;
+    return ok ? 0 : 3;
 }
\ No newline at end of file
@@ -0,0 +1,232 @@
+/**
+ * Producto Matriz Dispersa × Densa Paralelo con MPI
+ *
+ * Descripción: Calcula Y = A × X con A dispersa de N×N (CSR o BSR,
+ * sparse.h) y X densa de N×K, distribuyendo filas de A entre procesos
+ * como mm_mpi.c. Las filas no se reparten en partes iguales sino por
+ * número de no ceros: con el generador "skew" las primeras filas son
+ * mucho más densas que el resto.
+ *
+ * Compilar: mpicc -O3 -fopenmp-simd -I../common sp_mpi.c ../common/sparse.c ../common/bench.c ../common/arena.c -o sp_mpi -lm
+ * Uso:      mpirun -np P ./sp_mpi <n> <nnz_fila> [random|skew|banded] [k] [b]
+ * (k = 1: SpMV; b > 1: cada rank pasa sus filas a bloques de b×b).
+ *
+ * Rank 0 genera A y la reparte una sola vez (la matriz queda distribuida,
+ * como en un solver iterativo); cada repetición difunde X, multiplica las
+ * filas locales y junta Y en rank 0. El tiempo es la mediana de BENCH_REPS
+ * repeticiones tras BENCH_WARMUP (bench.h). Salida: tiempo,GFLOPS,GB/s con
+ * las 2·nnz·K operaciones útiles y el tráfico mínimo de sparse_bytes. Rank 0
+ * compara Y con un producto CSR secuencial y termina con código 3 si falla.
+ */
+
+#include <mpi.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "sparse.h"
+#include "cpu_isa.h"
+#include "arena.h"
+
+// rowptr es size_t: mismo ancho en todos los nodos de 64 bits
+#define MPI_SIZE_T (sizeof(size_t) == 8 ? MPI_UINT64_T : MPI_UINT32_T)
+
+/**
+ * Inicializa una matriz con valores aleatorios entre 0 y 9
+ */
+void initialize_matrix(double *matrix, size_t rows, size_t cols) {
+    for (size_t i = 0; i < rows * cols; i++) {
+        matrix[i] = (double)(rand() % 10);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int rank, size_proc;
+    sparse_t A;             // Matriz completa (solo en rank 0, CSR)
+    sparse_t local_A;       // Filas de A de cada proceso (CSR)
+    sparse_t local_B;       // local_A en bloques (si b > 1)
+    double *X = NULL;       // Matriz densa (completa, en todos los procesos)
+    double *Y = NULL;       // Resultado (completo, solo en rank 0)
+    double *local_Y = NULL; // Filas de Y de cada proceso
+    double start_time, end_time, total_time;
+    int ok = 1;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size_proc);
+
+    if (argc < 3) {
+        if (rank == 0) fprintf(stderr, "Uso: %s <n> <nnz_fila> [random|skew|banded] [k] [b]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+    size_t n = strtoull(argv[1], NULL, 10);
+    double per_row = atof(argv[2]);
+    const char *gen = argc > 3 ? argv[3] : "random";
+    size_t k = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+    int bsz = argc > 5 ? atoi(argv[5]) : 1;
+    if (k == 0 || bsz < 1 || bsz > SPARSE_MAX_B ||
+        (strcmp(gen, "random") != 0 && strcmp(gen, "skew") != 0 && strcmp(gen, "banded") != 0)) {
+        if (rank == 0) fprintf(stderr, "Argumentos inválidos (generador random|skew|banded, k > 0, 1 <= b <= %d)\n",
+                               SPARSE_MAX_B);
+        MPI_Finalize();
+        return 1;
+    }
+    // Bcast de X y Gatherv de Y cuentan en int (n·k elementos)
+    if (n > (size_t)INT32_MAX / k) {
+        if (rank == 0) fprintf(stderr, "n·k = %zu·%zu no cabe en un int (conteos de MPI)\n", n, k);
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Rank 0 genera A y decide qué filas van a cada proceso
+    int *rows = (int *)malloc(size_proc * sizeof(int));     // filas por proceso
+    int *nnzs = (int *)malloc(size_proc * sizeof(int));     // no ceros por proceso
+    int *row_off = (int *)malloc(size_proc * sizeof(int));
+    int *nnz_off = (int *)malloc(size_proc * sizeof(int));
+    int rc = 0;
+    memset(&A, 0, sizeof A);
+    if (rank == 0) {
+        if (strcmp(gen, "banded") == 0) {
+            rc = sparse_banded(&A, n, per_row > 1.0 ? (size_t)((per_row - 1.0) / 2.0) : 0, 1234);
+        } else {
+            rc = sparse_random(&A, n, per_row, strcmp(gen, "skew") == 0 ? 1.0 : 0.0, 1234);
+        }
+        sparse_part_t part = { 0, NULL };
+        if (rc == 0) rc = sparse_partition(&part, &A, size_proc, SPARSE_PART_NNZ);
+        // Scatterv cuenta en int
+        if (rc == 0 && A.nnz > (size_t)INT32_MAX) rc = -1;
+        for (int r = 0; rc == 0 && r < size_proc; r++) {
+            rows[r] = (int)(part.bounds[r + 1] - part.bounds[r]);
+            nnzs[r] = (int)(A.rowptr[part.bounds[r + 1]] - A.rowptr[part.bounds[r]]);
+            row_off[r] = (int)part.bounds[r];
+            nnz_off[r] = (int)A.rowptr[part.bounds[r]];
+        }
+        if (rc == 0) {
+            fprintf(stderr, "sp_mpi: nnz=%zu imbalance=%.2f\n", A.nnz, sparse_part_imbalance(&part, &A));
+        }
+        sparse_part_free(&part);
+    }
+    MPI_Bcast(&rc, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rc != 0) {
+        if (rank == 0) fprintf(stderr, "Fallo de memoria (n=%zu)\n", n);
+        MPI_Finalize();
+        return 2;
+    }
+
+    // Cada proceso recibe cuántas filas y no ceros le tocan
+    int my_rows, my_nnz;
+    MPI_Scatter(rows, 1, MPI_INT, &my_rows, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Scatter(nnzs, 1, MPI_INT, &my_nnz, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    // Scatterv: rowptr (sin el final de cada tramo), columnas y valores
+    memset(&local_A, 0, sizeof local_A);
+    local_A.nrows = local_A.nbrows = (size_t)my_rows;
+    local_A.ncols = n;
+    local_A.b = 1;
+    local_A.nnz = local_A.nnzb = (size_t)my_nnz;
+    local_A.rowptr = (size_t *)arena_alloc(((size_t)my_rows + 1) * sizeof(size_t));
+    local_A.col = (int *)arena_alloc(((size_t)my_nnz + 1) * sizeof(int));
+    local_A.val = (double *)arena_alloc(((size_t)my_nnz + 1) * sizeof(double));
+    MPI_Scatterv(A.rowptr, rows, row_off, MPI_SIZE_T, local_A.rowptr, my_rows, MPI_SIZE_T, 0, MPI_COMM_WORLD);
+    MPI_Scatterv(A.col, nnzs, nnz_off, MPI_INT, local_A.col, my_nnz, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Scatterv(A.val, nnzs, nnz_off, MPI_DOUBLE, local_A.val, my_nnz, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // rowptr local desde 0
+    size_t base = my_rows > 0 ? local_A.rowptr[0] : 0;
+    for (int i = 0; i < my_rows; i++) local_A.rowptr[i] -= base;
+    local_A.rowptr[my_rows] = (size_t)my_nnz;
+
+    const sparse_t *M = &local_A;
+    memset(&local_B, 0, sizeof local_B);
+    if (bsz > 1) {
+        rc = sparse_to_bsr(&local_B, &local_A, bsz);
+        M = &local_B;
+    }
+    sparse_part_t local_part = { 0, NULL };
+    if (rc == 0) rc = sparse_partition(&local_part, M, 1, SPARSE_PART_NNZ);
+
+    // Todos los procesos necesitan la matriz X completa
+    X = (double *)arena_alloc(n * k * sizeof(double));
+    local_Y = (double *)arena_alloc(((size_t)my_rows + 1) * k * sizeof(double));
+    if (rank == 0) {
+        Y = (double *)arena_alloc((n + 1) * k * sizeof(double));
+        srand(5678);
+        initialize_matrix(X, n, k);
+    }
+    int lost = (rc != 0 || !X || !local_Y || !local_A.rowptr || !local_A.col || !local_A.val || (rank == 0 && !Y));
+    MPI_Allreduce(MPI_IN_PLACE, &lost, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    if (lost) {
+        if (rank == 0) fprintf(stderr, "Fallo de memoria (n=%zu)\n", n);
+        MPI_Finalize();
+        return 2;
+    }
+
+    // Filas de Y por proceso (Gatherv cuenta en int)
+    int *ycounts = NULL, *yoffs = NULL;
+    if (rank == 0) {
+        ycounts = (int *)malloc(size_proc * sizeof(int));
+        yoffs = (int *)malloc(size_proc * sizeof(int));
+        for (int r = 0; r < size_proc; r++) {
+            ycounts[r] = rows[r] * (int)k;
+            yoffs[r] = row_off[r] * (int)k;
+        }
+    }
+
+    // Repeticiones del arnés: rank 0 decide cuántas para que todos coincidan
+    bench_t bench;
+    bench_init(&bench, "sp_mpi", "n=%zu;procs=%d;gen=%s;k=%zu;b=%d;isa=%s", n, size_proc, gen, k, bsz,
+               cpu_isa_name());
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+    while (bench_next(&bench)) {
+        // Sincronizar antes de medir tiempo
+        MPI_Barrier(MPI_COMM_WORLD);
+        start_time = MPI_Wtime();
+
+        // Broadcast: enviar X a todos los procesos
+        MPI_Bcast(X, (int)(n * k), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+        // Cada proceso calcula sus filas de Y = A × X
+        sparse_spmm(M, &local_part, X, k, local_Y);
+
+        // Gatherv: recolectar filas de Y en el proceso maestro
+        MPI_Gatherv(local_Y, my_rows * (int)k, MPI_DOUBLE, Y, ycounts, yoffs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+        // Sincronizar después del cálculo: el tiempo de rank 0 es el del más lento
+        MPI_Barrier(MPI_COMM_WORLD);
+        end_time = MPI_Wtime();
+        bench_add(&bench, end_time - start_time);
+    }
+    total_time = bench_median(&bench);
+
+    // El proceso maestro imprime los resultados
+    if (rank == 0) {
+        // Operaciones y tráfico de la matriz completa (relleno de bloques
+        // aparte: los bytes de A son los de la CSR)
+        double flops = sparse_flops(&A, k);
+        double bytes = sparse_bytes(&A, k);
+        printf("%.6f,%.2f,%.2f\n", total_time, flops / (total_time * 1e9), bytes / (total_time * 1e9));
+        bench_report(&bench, flops, "flop");
+        bench_roofline(&bench, "flop", flops, bytes);
+
+        double max_rel;
+        size_t bad_row;
+        ok = sparse_check(&A, X, k, Y, &max_rel, &bad_row);
+        if (ok) fprintf(stderr, "verify=ok max_rel=%.3g\n", max_rel);
+        else fprintf(stderr, "verify=FALLO fila=%zu max_rel=%.3g\n", bad_row, max_rel);
+    }
+    bench_free(&bench);
+
+    // Liberar memoria (rank 0 resume antes qué quedó en páginas grandes)
+    sparse_part_free(&local_part);
+    free(rows); free(nnzs); free(row_off); free(nnz_off);
+    free(ycounts); free(yoffs);
+    if (rank == 0) arena_report("sp_mpi");
+    arena_release();
+
+    MPI_Bcast(&ok, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return ok ? 0 : 3;
+}
@@ -7,6 +7,7 @@
 #include <math.h>
 #include "rng.h"
 #include "timer.h"
+#include "bench.h"
 
 
 static unsigned long long run_chunk(long long n, uint32_t seed){
@@ -28,28 +29,38 @@ int main(int argc, char** argv){
 
     int (*pipes)[2] = malloc(sizeof(int[2])*P);
     long long chunk = (N + P - 1)/P;
-    double t0 = now_sec();
-    for(int i=0;i<P;i++){
-    pipe(pipes[i]);
-    pid_t pid = fork();
-    if(pid==0){ // child
-        close(pipes[i][0]);
-        long long start=i*chunk, end=((i+1)*chunk>N?N:(i+1)*chunk);
-        unsigned long long inside = run_chunk(end-start, seed0 ^ (0x9E3779B9u*(i+1)));
-        write(pipes[i][1], &inside, sizeof(inside));
-        close(pipes[i][1]);
-        _exit(0);
-    } else {
-        close(pipes[i][1]);
-    }
-    }
+    // Cada muestra incluye crear y esperar los procesos hijos, no solo el núcleo
+    bench_t bench;
+    bench_init(&bench, "dart_fork", "N=%lld;P=%d;seed=%u", N, P, seed0);
     unsigned long long inside=0ULL;
-    for(int i=0;i<P;i++){
-        unsigned long long v; read(pipes[i][0], &v, sizeof(v)); close(pipes[i][0]);
-        inside += v; wait(NULL);
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        for(int i=0;i<P;i++){
+        pipe(pipes[i]);
+        pid_t pid = fork();
+        if(pid==0){ // child
+            close(pipes[i][0]);
+            long long start=i*chunk, end=((i+1)*chunk>N?N:(i+1)*chunk);
+            unsigned long long inside = run_chunk(end-start, seed0 ^ (0x9E3779B9u*(i+1)));
+            write(pipes[i][1], &inside, sizeof(inside));
+            close(pipes[i][1]);
+            _exit(0);
+        } else {
+            close(pipes[i][1]);
+        }
+        }
+        inside = 0ULL;
+        for(int i=0;i<P;i++){
+            unsigned long long v; read(pipes[i][0], &v, sizeof(v)); close(pipes[i][0]);
+            inside += v; wait(NULL);
+        }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec(); free(pipes);
+    free(pipes);
+    double secs = bench_median(&bench);
     double pi = 4.0 * (double)inside / (double)N;
-    printf("pi=%.9f\tN=%lld\tP=%d\tt=%.3fs\n", pi, N, P, t1-t0);
+    printf("pi=%.9f\tN=%lld\tP=%d\tt=%.3fs\n", pi, N, P, secs);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
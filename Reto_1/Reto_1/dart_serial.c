@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "rng.h"
 #include "timer.h"
+#include "bench.h"
 
 
 int main(int argc, char** argv){
@@ -12,14 +13,23 @@ int main(int argc, char** argv){
 
 
     long long inside = 0;
-    double t0 = now_sec();
-    for(long long i=0;i<N;i++){
-        double x = rng32_next01(&rng);
-        double y = rng32_next01(&rng);
-        if (x*x + y*y <= 1.0) inside++;
+    bench_t bench;
+    bench_init(&bench, "dart_serial", "N=%lld;seed=%u", N, seed);
+    while (bench_next(&bench)) {
+        inside = 0;
+        rng32_seed(&rng, seed);
+        double t0 = now_sec();
+        for(long long i=0;i<N;i++){
+            double x = rng32_next01(&rng);
+            double y = rng32_next01(&rng);
+            if (x*x + y*y <= 1.0) inside++;
+        }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double pi = 4.0 * (double)inside / (double)N;
-    printf("pi=%.9f\tN=%lld\tt=%.3fs\n", pi, N, t1-t0);
+    printf("pi=%.9f\tN=%lld\tt=%.3fs\n", pi, N, secs);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
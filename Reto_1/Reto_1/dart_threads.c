@@ -8,6 +8,7 @@
 #include <sched.h>
 #include "rng.h"
 #include "timer.h"
+#include "bench.h"
 
 
 #ifndef CACHELINE
@@ -47,21 +48,29 @@ int main(int argc, char** argv){
 
 
     long long chunk = (N + T - 1)/T;
-    double t0 = now_sec();
-    for(int i=0;i<T;i++){
-        tasks[i].start = i*chunk;
-        long long end = (i+1)*chunk; if (end>N) end=N; tasks[i].end=end;
-        tasks[i].seed = seed0 ^ (0x9E3779B9u * (i+1));
-        tasks[i].inside = 0ULL;
-        pthread_create(&th[i], NULL, worker, &tasks[i]);
-    }
+    bench_t bench;
+    bench_init(&bench, "dart_threads", "N=%lld;T=%d;seed=%u", N, T, seed0);
     unsigned long long inside=0ULL;
-    for(int i=0;i<T;i++){ 
-        pthread_join(th[i], NULL); inside += tasks[i].inside; 
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        for(int i=0;i<T;i++){
+            tasks[i].start = i*chunk;
+            long long end = (i+1)*chunk; if (end>N) end=N; tasks[i].end=end;
+            tasks[i].seed = seed0 ^ (0x9E3779B9u * (i+1));
+            tasks[i].inside = 0ULL;
+            pthread_create(&th[i], NULL, worker, &tasks[i]);
+        }
+        inside = 0ULL;
+        for(int i=0;i<T;i++){ 
+            pthread_join(th[i], NULL); inside += tasks[i].inside; 
+        }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double pi = 4.0 * (double)inside / (double)N;
-    printf("pi=%.9f\tN=%lld\tT=%d\tt=%.3fs\n", pi, N, T, t1-t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\tt=%.3fs\n", pi, N, T, secs);
     free(th); free(tasks);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <math.h>
 #include "rng.h"
 #include "timer.h"
+#include "bench.h"
 
 
 #ifndef CACHELINE
@@ -50,21 +51,29 @@ int main(int argc, char** argv){
 
 
     long long chunk = (N + T - 1)/T;
-    double t0 = now_sec();
-    for(int i=0;i<T;i++){
-        tasks[i] = (task_t){ .start=i*chunk, .end=((i+1)*chunk>N?N:(i+1)*chunk), .L=L, .ell=ell,
-        .seed=(seed0 ^ (0x9E3779B9u*(i+1))), .crosses=0ULL };
-        pthread_create(&th[i], NULL, worker, &tasks[i]);
-    }
+    bench_t bench;
+    bench_init(&bench, "needle_threads", "N=%lld;T=%d;L=%g;ell=%g;seed=%u", N, T, L, ell, seed0);
     unsigned long long crosses=0ULL;
-    for(int i=0;i<T;i++){ 
-        pthread_join(th[i], NULL); crosses += tasks[i].crosses; 
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        for(int i=0;i<T;i++){
+            tasks[i] = (task_t){ .start=i*chunk, .end=((i+1)*chunk>N?N:(i+1)*chunk), .L=L, .ell=ell,
+            .seed=(seed0 ^ (0x9E3779B9u*(i+1))), .crosses=0ULL };
+            pthread_create(&th[i], NULL, worker, &tasks[i]);
+        }
+        crosses = 0ULL;
+        for(int i=0;i<T;i++){ 
+            pthread_join(th[i], NULL); crosses += tasks[i].crosses; 
+        }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double p = (double)crosses / (double)N;
     double pi_est = (2.0*L)/(ell*p);
-    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\tt=%.3fs\n", pi_est, N, T, L, ell, t1-t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\tt=%.3fs\n", pi_est, N, T, L, ell, secs);
     free(th); 
     free(tasks);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
@@ -14,9 +14,18 @@ NEEDLE_ELL=1.0
 RAW_CSV="pi_results_raw.csv"
 AVG_CSV="pi_results_avg.csv"
 LOG_DIR="logs_pi"
+# Tiempos del núcleo medidos dentro de cada programa (../../common/bench.h);
+# compilar con -I../../common ../../common/bench.c -lm
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV="${BENCH_CSV:-pi_results_bench.csv}"
+export BENCH_WARMUP="${BENCH_WARMUP:-0}"
+export BENCH_REPS="${BENCH_REPS:-1}"
 
 mkdir -p "$LOG_DIR"
 echo "algo,impl,N,workers,iter,seconds,pi" > "$RAW_CSV"
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
 
 cleanup() { rm -f tmp.out tmp.err; }
 trap cleanup EXIT
@@ -24,7 +33,7 @@ trap cleanup EXIT
 ensure_bin() {
   local b="$1"
   if [[ ! -x "./$b" ]]; then
-    echo "[ERROR] No existe ejecutable ./$b. Compílalo antes (recuerda -lm en needle)." | tee -a "$LOG_DIR/errors.setup.log"
+    echo "[ERROR] No existe ejecutable ./$b. Compílalo antes (con -I../../common ../../common/bench.c -lm)." | tee -a "$LOG_DIR/errors.setup.log"
     exit 1
   fi
 }
@@ -141,4 +150,5 @@ END {
 echo "Listo."
 echo "  - Resultados crudos: $RAW_CSV"
 echo "  - Promedios:         $AVG_CSV"
+echo "  - Núcleo (bench.h):  $BENCH_CSV"
 echo "  - Logs:              $LOG_DIR/*.log y $LOG_DIR/*.err.log"
@@ -0,0 +1,141 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+// Afinidad de hilos/procesos para los backends pthreads, fork y OpenMP.
+//
+// Políticas (último argumento opcional de cada programa):
+//   none            sin fijar (comportamiento original)
+//   compact         trabajador i -> i-ésima CPU llenando núcleo, luego socket
+//   scatter         reparte primero entre sockets y núcleos, los hermanos SMT al final
+//   list:0,2,4-7    lista explícita (también se acepta "0,2,4-7"); se recorre en ciclo
+// El trabajador i usa cpus[i % ncpu]. Solo se consideran las CPU permitidas
+// por la máscara del proceso (taskset, cgroups, mpirun --bind-to ...): una
+// lista con CPU fuera de ella es inválida. Si fijar un trabajador falla, el
+// programa termina con código 2 en lugar de informar una afinidad que no se
+// aplicó (aff_pin_error).
+#include <sched.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef AFF_MAX_CPUS
+#define AFF_MAX_CPUS 1024
+#endif
+
+enum { AFF_NONE = 0, AFF_COMPACT, AFF_SCATTER, AFF_LIST };
+
+typedef struct {
+    int kind;
+    int ncpu;
+    int cpus[AFF_MAX_CPUS];
+} aff_policy_t;
+
+typedef struct { int cpu, pkg, core, slot, smt; } aff_topo_t;
+
+static inline int aff_read_int(const char* fmt, int cpu, int dflt){
+    char path[128]; snprintf(path, sizeof(path), fmt, cpu);
+    FILE* f = fopen(path, "r");
+    int v = dflt;
+    if (f) { if (fscanf(f, "%d", &v) != 1) v = dflt; fclose(f); }
+    return v;
+}
+
+static int aff_cmp_topo(const void* a, const void* b){
+    const aff_topo_t *x = a, *y = b;
+    if (x->pkg != y->pkg)   return x->pkg - y->pkg;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+static int aff_cmp_scatter(const void* a, const void* b){
+    const aff_topo_t *x = a, *y = b;
+    if (x->smt != y->smt)   return x->smt - y->smt;
+    if (x->slot != y->slot) return x->slot - y->slot;
+    if (x->pkg != y->pkg)   return x->pkg - y->pkg;
+    return x->cpu - y->cpu;
+}
+
+// Ordena las CPU permitidas según la topología de /sys (compact o scatter).
+static inline void aff_topology_order(aff_policy_t* p, int scatter){
+    cpu_set_t set; CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) { p->ncpu = 0; return; }
+    aff_topo_t t[AFF_MAX_CPUS]; int n = 0;
+    for (int c = 0; c < CPU_SETSIZE && n < AFF_MAX_CPUS; c++) {
+        if (!CPU_ISSET(c, &set)) continue;
+        t[n].cpu  = c;
+        t[n].pkg  = aff_read_int("/sys/devices/system/cpu/cpu%d/topology/physical_package_id", c, 0);
+        t[n].core = aff_read_int("/sys/devices/system/cpu/cpu%d/topology/core_id", c, c);
+        n++;
+    }
+    qsort(t, n, sizeof(*t), aff_cmp_topo);
+    // slot = índice del núcleo dentro del socket, smt = índice del hermano dentro del núcleo
+    for (int i = 0, slot = 0, smt = 0; i < n; i++) {
+        if (i > 0 && t[i].pkg != t[i-1].pkg) { slot = 0; smt = 0; }
+        else if (i > 0 && t[i].core != t[i-1].core) { slot++; smt = 0; }
+        else if (i > 0) smt++;
+        t[i].slot = slot; t[i].smt = smt;
+    }
+    if (scatter) qsort(t, n, sizeof(*t), aff_cmp_scatter);
+    for (int i = 0; i < n; i++) p->cpus[i] = t[i].cpu;
+    p->ncpu = n;
+}
+
+// Devuelve 0 si la especificación es válida.
+static inline int aff_parse(const char* spec, aff_policy_t* p){
+    memset(p, 0, sizeof(*p));
+    if (!spec || !*spec || strcmp(spec, "none") == 0) { p->kind = AFF_NONE; return 0; }
+    if (strcmp(spec, "compact") == 0) { p->kind = AFF_COMPACT; aff_topology_order(p, 0); return p->ncpu ? 0 : -1; }
+    if (strcmp(spec, "scatter") == 0) { p->kind = AFF_SCATTER; aff_topology_order(p, 1); return p->ncpu ? 0 : -1; }
+    if (strncmp(spec, "list:", 5) == 0) spec += 5;
+    p->kind = AFF_LIST;
+    const char* s = spec;
+    while (*s) {
+        char* end;
+        long a = strtol(s, &end, 10), b = a;
+        if (end == s || a < 0) return -1;
+        if (*end == '-') { s = end + 1; b = strtol(s, &end, 10); if (end == s || b < a) return -1; }
+        for (long c = a; c <= b && p->ncpu < AFF_MAX_CPUS; c++) p->cpus[p->ncpu++] = (int)c;
+        s = end;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    // Solo CPU de la máscara del proceso: las demás no se pueden fijar
+    cpu_set_t set; CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return -1;
+    for (int i = 0; i < p->ncpu; i++) {
+        if (p->cpus[i] >= CPU_SETSIZE || !CPU_ISSET(p->cpus[i], &set)) {
+            fprintf(stderr, "afinidad: la CPU %d no está permitida para este proceso\n", p->cpus[i]);
+            return -1;
+        }
+    }
+    return p->ncpu ? 0 : -1;
+}
+
+static inline const char* aff_name(const aff_policy_t* p){
+    static const char* names[] = { "none", "compact", "scatter", "list" };
+    return names[p->kind];
+}
+
+// CPU asignada al trabajador w, o -1 si no se fija.
+static inline int aff_cpu(const aff_policy_t* p, int w){
+    return (p->kind == AFF_NONE || p->ncpu == 0) ? -1 : p->cpus[w % p->ncpu];
+}
+
+// Fija el hilo/proceso que llama (fork u OpenMP).
+static inline int aff_pin_self(int cpu){
+    if (cpu < 0) return 0;
+    cpu_set_t set; CPU_ZERO(&set); CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set);
+}
+
+// Fija un pthread concreto.
+static inline int aff_pin_thread(pthread_t th, int cpu){
+    if (cpu < 0) return 0;
+    cpu_set_t set; CPU_ZERO(&set); CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(th, sizeof(set), &set);
+}
+
+// Aviso de un trabajador que no se pudo fijar (el programa termina con 2).
+static inline void aff_pin_error(int w, int cpu){
+    fprintf(stderr, "afinidad: no se pudo fijar el trabajador %d a la CPU %d\n", w, cpu);
+}
+#endif
@@ -0,0 +1,95 @@
+// dart_mpi.c — dardos distribuidos: MPI entre procesos + OpenMP dentro de cada rank
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "rng.h"
+#include "bench.h"
+#include "cpu_isa.h"
+
+// Rango global [lo, hi) de muestras del rank (reparto casi uniforme).
+static void rank_range(long long N, int rank, int size, long long* lo, long long* hi){
+    long long base = N / size, rem = N % size;
+    *lo = base * rank + (rank < rem ? rank : rem);
+    *hi = *lo + base + (rank < rem);
+}
+
+// Muestras [a, b) que caen en el círculo. Sin estado entre muestras (rng por
+// contador), así el bucle se vectoriza; una versión por nivel de ISA (cpu_isa.h).
+static inline CPU_ISA_INLINE unsigned long long dart_count_body(uint64_t key, long long a, long long b) {
+    unsigned long long c = 0ULL;
+    #pragma omp simd reduction(+:c)
+    for (long long i = a; i < b; i++) {
+        double x, y;
+        rng64_pair01(key, (uint64_t)i, &x, &y);
+        c += (x * x + y * y <= 1.0);
+    }
+    return c;
+}
+CPU_ISA_CLONES(dart_count, unsigned long long, (uint64_t key, long long a, long long b), (key, a, b))
+
+int main(int argc, char** argv) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // N = número total de puntos (todas las réplicas)
+    long long N = (argc > 1) ? atoll(argv[1]) : 100000000LL;
+    // T = hilos OpenMP por rank
+    int T = (argc > 2) ? atoi(argv[2]) : 4;
+    // semilla base
+    uint32_t seed0 = (argc > 3) ? (uint32_t)atoi(argv[3]) : 12345u;
+
+    long long lo, hi;
+    rank_range(N, rank, size, &lo, &hi);
+    // La muestra i usa rng64_at(key, i): los flujos de ranks e hilos no se solapan
+    // y el resultado es idéntico para cualquier combinación de ranks x hilos.
+    uint64_t key = rng64_mix(seed0);
+
+    bench_t bench;
+    bench_init(&bench, "dart_mpi", "N=%lld;R=%d;T=%d;seed=%u;isa=%s", N, size, T, seed0, cpu_isa_name());
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    unsigned long long inside = 0ULL;
+    while (bench_next(&bench)) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+
+        unsigned long long inside_local = 0ULL;
+        #pragma omp parallel num_threads(T) reduction(+:inside_local)
+        {
+            // Tramo contiguo del hilo, como schedule(static)
+            int t = omp_get_thread_num(), nt = omp_get_num_threads();
+            long long a = lo + (hi - lo) * t / nt, b = lo + (hi - lo) * (t + 1) / nt;
+            inside_local += dart_count_isa[cpu_isa_level](key, a, b);
+        }
+
+        inside = 0ULL;
+        MPI_Reduce(&inside_local, &inside, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        // La muestra es el tiempo del rank más lento
+        double dt = MPI_Wtime() - t0, slowest = dt;
+        MPI_Reduce(&dt, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) bench_add(&bench, slowest);
+    }
+
+    if (rank == 0) {
+        double secs = bench_median(&bench);
+        double pi = 4.0 * (double)inside / (double)N;
+        printf("pi=%.9f\tN=%lld\tR=%d\tT=%d\tt=%.3fs\trate=%.3e/s\n",
+               pi, N, size, T, secs, (double)N / secs);
+        bench_report(&bench, (double)N, "samples");
+        // Roofline: 5 flops por muestra (2 escalados del rng, x*x + y*y) y sin
+        // tráfico de memoria: el núcleo está limitado por cómputo
+        bench_roofline(&bench, "flop", 5.0 * (double)N, 0.0);
+    }
+
+    bench_free(&bench);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -7,6 +7,8 @@
 #include <omp.h>
 #include "rng.h"
 #include "timer.h"
+#include "affinity.h"
+#include "bench.h"
 
 int main(int argc, char** argv) {
     // N = número de puntos
@@ -15,29 +17,49 @@ int main(int argc, char** argv) {
     int T = (argc > 2) ? atoi(argv[2]) : 4;
     // semilla base
     uint32_t seed0 = (argc > 3) ? (uint32_t)atoi(argv[3]) : 12345u;
+    // afinidad: none | compact | scatter | list:0,2,4-7
+    aff_policy_t aff;
+    if (aff_parse((argc > 4) ? argv[4] : "none", &aff) != 0) {
+        fprintf(stderr, "Afinidad inválida: %s (none|compact|scatter|list:0,2,4-7)\n", argv[4]);
+        return 1;
+    }
 
-    double t0 = now_sec();
+    bench_t bench;
+    bench_init(&bench, "dart_omp", "N=%lld;T=%d;seed=%u;aff=%s", N, T, seed0, aff_name(&aff));
     unsigned long long inside = 0ULL;
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        inside = 0ULL;
+        int pin_err = 0;
 
-    #pragma omp parallel num_threads(T) reduction(+:inside)
-    {
-        int tid = omp_get_thread_num();
-        // semilla distinta por hilo
-        uint32_t myseed = seed0 ^ (0x9E3779B9u * (tid + 1));
-        rng32_t rng;
-        rng32_seed(&rng, myseed);
+        #pragma omp parallel num_threads(T) reduction(+:inside) reduction(|:pin_err)
+        {
+            int tid = omp_get_thread_num();
+            if (aff_pin_self(aff_cpu(&aff, tid)) != 0){ aff_pin_error(tid, aff_cpu(&aff, tid)); pin_err = 1; }
+            // semilla distinta por hilo
+            uint32_t myseed = seed0 ^ (0x9E3779B9u * (tid + 1));
+            rng32_t rng;
+            rng32_seed(&rng, myseed);
 
-        #pragma omp for schedule(static)
-        for (long long i = 0; i < N; i++) {
-            double x = rng32_next01(&rng);
-            double y = rng32_next01(&rng);
-            if (x * x + y * y <= 1.0)
-                inside++;
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < N; i++) {
+                double x = rng32_next01(&rng);
+                double y = rng32_next01(&rng);
+                if (x * x + y * y <= 1.0)
+                    inside++;
+            }
         }
-    }
 
-    double t1 = now_sec();
+        if (pin_err){ bench_free(&bench); return 2; }
+        bench_add(&bench, now_sec() - t0);
+    }
+    double secs = bench_median(&bench);
     double pi = 4.0 * (double)inside / (double)N;
-    printf("pi=%.9f\tN=%lld\tT=%d\tt=%.3fs\n", pi, N, T, t1 - t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\taff=%s\tt=%.3fs\n", pi, N, T, aff_name(&aff), secs);
+    bench_report(&bench, (double)N, "samples");
+    // Roofline: 5 flops por muestra (2 escalados del rng, x*x + y*y) y sin
+    // tráfico de memoria: el núcleo está limitado por cómputo
+    bench_roofline(&bench, "flop", 5.0 * (double)N, 0.0);
+    bench_free(&bench);
     return 0;
 }
@@ -8,6 +8,9 @@
 #include <sched.h>
 #include "rng.h"
 #include "timer.h"
+#include "affinity.h"
+#include "bench.h"
+#include "trace.h"
 
 
 #ifndef CACHELINE
@@ -18,20 +21,31 @@
 typedef struct {
     long long start, end;
     uint32_t seed;
+    int id;
+    int cpu;
+    int pin_err;
     _Alignas(CACHELINE) unsigned long long inside;
 } task_t;
 
 
 static void* worker(void* arg){
     task_t* t = (task_t*)arg;
+    trace_thread_name("worker %d", t->id);
+    TRACE_BEGIN("setup");
+    t->pin_err = aff_pin_thread(pthread_self(), t->cpu);
     rng32_t r; rng32_seed(&r, t->seed);
+    TRACE_END("setup");
     unsigned long long local = 0ULL;
+    TRACE_BEGIN("darts");
     for(long long i=t->start;i<t->end;i++){
     double x = rng32_next01(&r);
     double y = rng32_next01(&r);
     local += (x*x + y*y <= 1.0);
     }
+    TRACE_END("darts");
     t->inside = local;
+    // Los hilos se crean en cada repetición: el siguiente reutiliza este carril
+    trace_thread_exit();
     return NULL;
 }
 
@@ -40,28 +54,57 @@ int main(int argc, char** argv){
     long long N = (argc>1)? atoll(argv[1]) : 100000000LL;
     int T = (argc>2)? atoi(argv[2]) : 4;
     uint32_t seed0 = (argc>3)? (uint32_t)atoi(argv[3]) : 12345u;
+    aff_policy_t aff;
+    if (aff_parse((argc>4)? argv[4] : "none", &aff) != 0){
+        fprintf(stderr, "Afinidad inválida: %s (none|compact|scatter|list:0,2,4-7)\n", argv[4]);
+        return 1;
+    }
+
 
+    // Línea de tiempo por hilo (TRACE_JSON, trace.h)
+    trace_init("dart_threads", 0);
+    trace_thread_name("main");
 
     pthread_t* th = calloc(T, sizeof(*th));
     task_t* tasks = aligned_alloc(CACHELINE, T*sizeof(*tasks));
 
 
     long long chunk = (N + T - 1)/T;
-    double t0 = now_sec();
-    for(int i=0;i<T;i++){
-        tasks[i].start = i*chunk;
-        long long end = (i+1)*chunk; if (end>N) end=N; tasks[i].end=end;
-        tasks[i].seed = seed0 ^ (0x9E3779B9u * (i+1));
-        tasks[i].inside = 0ULL;
-        pthread_create(&th[i], NULL, worker, &tasks[i]);
-    }
+    bench_t bench;
+    bench_init(&bench, "dart_threads", "N=%lld;T=%d;seed=%u;aff=%s", N, T, seed0, aff_name(&aff));
     unsigned long long inside=0ULL;
-    for(int i=0;i<T;i++){ 
-        pthread_join(th[i], NULL); inside += tasks[i].inside; 
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        TRACE_BEGIN("spawn");
+        for(int i=0;i<T;i++){
+            tasks[i].start = i*chunk;
+            long long end = (i+1)*chunk; if (end>N) end=N; tasks[i].end=end;
+            tasks[i].seed = seed0 ^ (0x9E3779B9u * (i+1));
+            tasks[i].id = i;
+            tasks[i].cpu = aff_cpu(&aff, i);
+            tasks[i].pin_err = 0;
+            tasks[i].inside = 0ULL;
+            pthread_create(&th[i], NULL, worker, &tasks[i]);
+        }
+        TRACE_END("spawn");
+        TRACE_BEGIN("join");
+        inside = 0ULL;
+        int pin_err = 0;
+        for(int i=0;i<T;i++){ 
+            pthread_join(th[i], NULL);
+            if (tasks[i].pin_err){ aff_pin_error(i, tasks[i].cpu); pin_err = 1; }
+            inside += tasks[i].inside;
+        }
+        TRACE_END("join");
+        if (pin_err){ free(th); free(tasks); bench_free(&bench); return 2; }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double pi = 4.0 * (double)inside / (double)N;
-    printf("pi=%.9f\tN=%lld\tT=%d\tt=%.3fs\n", pi, N, T, t1-t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\taff=%s\tt=%.3fs\n", pi, N, T, aff_name(&aff), secs);
     free(th); free(tasks);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
+    trace_dump();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+// dart_vr.c — dardos con muestreo estratificado (K x K) y pares antitéticos
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <omp.h>
+#include "rng.h"
+#include "timer.h"
+#include "vr.h"
+#include "bench.h"
+
+static inline int in_circle(double x, double y){
+    return x*x + y*y <= 1.0;
+}
+
+int main(int argc, char** argv) {
+    // N = número de puntos
+    long long N = (argc > 1) ? atoll(argv[1]) : 100000000LL;
+    // T = número de hilos
+    int T = (argc > 2) ? atoi(argv[2]) : 4;
+    // K = estratos por dimensión (K*K en total)
+    int K = (argc > 3) ? atoi(argv[3]) : 64;
+    // anti = 1 usa pares antitéticos dentro de cada estrato
+    int anti = (argc > 4) ? atoi(argv[4]) : 1;
+    // semilla base
+    uint32_t seed0 = (argc > 5) ? (uint32_t)atoi(argv[5]) : 12345u;
+
+    if (K < 1) K = 1;
+    int S = K * K;
+    int k = anti ? 2 : 1;
+    long long units = N / k;
+    if (units < 2LL * S) {
+        fprintf(stderr, "N=%lld demasiado pequeño para %d estratos (min %lld)\n",
+                N, S, 2LL * S * k);
+        return 1;
+    }
+
+    vr_acc_t* acc = aligned_alloc(CACHELINE, ((S*sizeof(*acc) + CACHELINE-1)/CACHELINE)*CACHELINE);
+    if (!acc) { fprintf(stderr, "Fallo de memoria (S=%d)\n", S); return 2; }
+
+    bench_t bench;
+    bench_init(&bench, "dart_vr", "N=%lld;T=%d;K=%d;anti=%d;seed=%u", units * k, T, K, anti, seed0);
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+
+        // Cada hilo recibe un bloque contiguo de estratos; un rng por estrato
+        // para que el resultado no dependa de T.
+        #pragma omp parallel for num_threads(T) schedule(static)
+        for (int s = 0; s < S; s++) {
+            int ci = s / K, cj = s % K;
+            rng32_t rng;
+            rng32_seed(&rng, seed0 ^ (0x9E3779B9u * (uint32_t)(s + 1)));
+            unsigned long long m = vr_units_for(units, S, s);
+            unsigned long long hits = 0ULL, hits2 = 0ULL;
+            for (unsigned long long u = 0; u < m; u++) {
+                double a = rng32_next01(&rng);
+                double b = rng32_next01(&rng);
+                unsigned h = in_circle(vr_cell(ci, K, a), vr_cell(cj, K, b));
+                if (anti)
+                    h += in_circle(vr_cell(ci, K, 1.0 - a), vr_cell(cj, K, 1.0 - b));
+                hits  += h;
+                hits2 += h * h;
+            }
+            acc[s] = (vr_acc_t){ .units = m, .hits = hits, .hits2 = hits2 };
+        }
+
+        bench_add(&bench, now_sec() - t0);
+    }
+    double secs = bench_median(&bench);
+    vr_result_t r = vr_combine(acc, S, k);
+    free(acc);
+
+    double pi = 4.0 * r.p;
+    double se = 4.0 * sqrt(r.var);
+    printf("pi=%.9f\tN=%lld\tT=%d\tK=%d\tanti=%d\tse=%.3e\tvrf=%.2f\tt=%.3fs\n",
+           pi, units * k, T, K, anti, se, r.vrf, secs);
+    bench_report(&bench, (double)(units * k), "samples");
+    bench_free(&bench);
+    return 0;
+}
@@ -0,0 +1,105 @@
+// needle_mpi.c — aguja de Buffon distribuida: MPI entre procesos + OpenMP por rank
+#define _GNU_SOURCE
+#define _USE_MATH_DEFINES
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include "rng.h"
+#include "bench.h"
+#include "cpu_isa.h"
+
+// Rango global [lo, hi) de lanzamientos del rank (reparto casi uniforme).
+static void rank_range(long long N, int rank, int size, long long* lo, long long* hi){
+    long long base = N / size, rem = N % size;
+    *lo = base * rank + (rank < rem ? rank : rem);
+    *hi = *lo + base + (rank < rem);
+}
+
+// Agujas [a, b) que cruzan una línea. Sin estado entre muestras (rng por
+// contador), así el bucle se vectoriza; una versión por nivel de ISA (cpu_isa.h).
+static inline CPU_ISA_INLINE unsigned long long needle_count_body(uint64_t key, long long a, long long b,
+                                                                   double L, double ell) {
+    unsigned long long c = 0ULL;
+    #pragma omp simd reduction(+:c)
+    for (long long i = a; i < b; i++) {
+        double u, v;
+        rng64_pair01(key, (uint64_t)i, &u, &v);
+        double x = u * ell;
+        double theta = v * M_PI;
+        double halfproj = 0.5 * L * sin(theta);
+        c += (x + halfproj > ell || x - halfproj < 0.0);
+    }
+    return c;
+}
+CPU_ISA_CLONES(needle_count, unsigned long long, (uint64_t key, long long a, long long b, double L, double ell),
+               (key, a, b, L, ell))
+
+int main(int argc, char** argv) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // N = número total de lanzamientos
+    long long N    = (argc > 1) ? atoll(argv[1]) : 100000000LL;
+    // T = hilos OpenMP por rank
+    int T          = (argc > 2) ? atoi(argv[2]) : 4;
+    // longitud de la aguja
+    double L       = (argc > 3) ? atof(argv[3]) : 0.5;
+    // distancia entre líneas
+    double ell     = (argc > 4) ? atof(argv[4]) : 1.0;
+    // semilla base
+    uint32_t seed0 = (argc > 5) ? (uint32_t)atoi(argv[5]) : 12345u;
+
+    long long lo, hi;
+    rank_range(N, rank, size, &lo, &hi);
+    uint64_t key = rng64_mix(seed0);
+
+    bench_t bench;
+    bench_init(&bench, "needle_mpi", "N=%lld;R=%d;T=%d;L=%g;ell=%g;seed=%u;isa=%s", N, size, T, L, ell, seed0, cpu_isa_name());
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    unsigned long long crosses = 0ULL;
+    while (bench_next(&bench)) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double t0 = MPI_Wtime();
+
+        unsigned long long crosses_local = 0ULL;
+        #pragma omp parallel num_threads(T) reduction(+:crosses_local)
+        {
+            // Tramo contiguo del hilo, como schedule(static)
+            int t = omp_get_thread_num(), nt = omp_get_num_threads();
+            long long a = lo + (hi - lo) * t / nt, b = lo + (hi - lo) * (t + 1) / nt;
+            crosses_local += needle_count_isa[cpu_isa_level](key, a, b, L, ell);
+        }
+
+        crosses = 0ULL;
+        MPI_Reduce(&crosses_local, &crosses, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+        // La muestra es el tiempo del rank más lento
+        double dt = MPI_Wtime() - t0, slowest = dt;
+        MPI_Reduce(&dt, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) bench_add(&bench, slowest);
+    }
+
+    if (rank == 0) {
+        double secs = bench_median(&bench);
+        double p = (double)crosses / (double)N;
+        double pi_est = (2.0 * L) / (ell * p);
+        printf("pi=%.9f\tN=%lld\tR=%d\tT=%d\tL=%.3f\tell=%.3f\tt=%.3fs\trate=%.3e/s\n",
+               pi_est, N, size, T, L, ell, secs, (double)N / secs);
+        bench_report(&bench, (double)N, "samples");
+        // Roofline: 9 flops por muestra (2 escalados del rng, x, theta,
+        // 0.5*L*sin con sin() como una operación y las dos comparaciones de
+        // extremos) y sin tráfico de memoria
+        bench_roofline(&bench, "flop", 9.0 * (double)N, 0.0);
+    }
+
+    bench_free(&bench);
+
+    MPI_Finalize();
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include <omp.h>
 #include "rng.h"
 #include "timer.h"
+#include "affinity.h"
+#include "bench.h"
 
 int main(int argc, char** argv) {
     // N = número de lanzamientos de aguja
@@ -20,35 +22,56 @@ int main(int argc, char** argv) {
     double ell     = (argc > 4) ? atof(argv[4]) : 1.0;
     // semilla base
     uint32_t seed0 = (argc > 5) ? (uint32_t)atoi(argv[5]) : 12345u;
+    // afinidad: none | compact | scatter | list:0,2,4-7
+    aff_policy_t aff;
+    if (aff_parse((argc > 6) ? argv[6] : "none", &aff) != 0) {
+        fprintf(stderr, "Afinidad inválida: %s (none|compact|scatter|list:0,2,4-7)\n", argv[6]);
+        return 1;
+    }
 
-    double t0 = now_sec();
+    bench_t bench;
+    bench_init(&bench, "needle_omp", "N=%lld;T=%d;L=%g;ell=%g;seed=%u;aff=%s", N, T, L, ell, seed0, aff_name(&aff));
     unsigned long long crosses = 0ULL;
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        crosses = 0ULL;
+        int pin_err = 0;
 
-    #pragma omp parallel num_threads(T) reduction(+:crosses)
-    {
-        int tid = omp_get_thread_num();
-        uint32_t myseed = seed0 ^ (0x9E3779B9u * (tid + 1));
-        rng32_t rng;
-        rng32_seed(&rng, myseed);
+        #pragma omp parallel num_threads(T) reduction(+:crosses) reduction(|:pin_err)
+        {
+            int tid = omp_get_thread_num();
+            if (aff_pin_self(aff_cpu(&aff, tid)) != 0){ aff_pin_error(tid, aff_cpu(&aff, tid)); pin_err = 1; }
+            uint32_t myseed = seed0 ^ (0x9E3779B9u * (tid + 1));
+            rng32_t rng;
+            rng32_seed(&rng, myseed);
 
-        #pragma omp for schedule(static)
-        for (long long i = 0; i < N; i++) {
-            // x: posición de la mitad de la aguja respecto a una línea
-            double x     = rng32_next01(&rng) * ell;
-            // theta: ángulo de la aguja
-            double theta = rng32_next01(&rng) * M_PI;
-            // proyección de la mitad de la aguja
-            double halfproj = 0.5 * L * sin(theta);
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < N; i++) {
+                // x: posición de la mitad de la aguja respecto a una línea
+                double x     = rng32_next01(&rng) * ell;
+                // theta: ángulo de la aguja
+                double theta = rng32_next01(&rng) * M_PI;
+                // proyección de la mitad de la aguja
+                double halfproj = 0.5 * L * sin(theta);
 
-            if (x + halfproj > ell || x - halfproj < 0.0)
-                crosses++;
+                if (x + halfproj > ell || x - halfproj < 0.0)
+                    crosses++;
+            }
         }
-    }
 
-    double t1 = now_sec();
+        if (pin_err){ bench_free(&bench); return 2; }
+        bench_add(&bench, now_sec() - t0);
+    }
+    double secs = bench_median(&bench);
     double p = (double)crosses / (double)N;
     double pi_est = (2.0 * L) / (ell * p);
-    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\tt=%.3fs\n",
-           pi_est, N, T, L, ell, t1 - t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\taff=%s\tt=%.3fs\n",
+           pi_est, N, T, L, ell, aff_name(&aff), secs);
+    bench_report(&bench, (double)N, "samples");
+    // Roofline: 9 flops por muestra (2 escalados del rng, x, theta,
+    // 0.5*L*sin con sin() como una operación y las dos comparaciones de
+    // extremos) y sin tráfico de memoria
+    bench_roofline(&bench, "flop", 9.0 * (double)N, 0.0);
+    bench_free(&bench);
     return 0;
 }
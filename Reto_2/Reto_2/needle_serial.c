@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "rng.h"
 #include "timer.h"
+#include "bench.h"
 #include <stdlib.h>
 
 #define _USE_MATH_DEFINES
@@ -15,17 +16,30 @@ int main(int argc, char** argv){
 
     rng32_t rng; rng32_seed(&rng, seed);
     long long crosses = 0;
-    double t0 = now_sec();
-    for(long long i=0;i<N;i++){
-        double x = rng32_next01(&rng) * ell; // x en [0, ell]
-        double theta = rng32_next01(&rng) * M_PI; // [0, pi]
-        double halfproj = 0.5 * L * sin(theta);
-        if (x + halfproj > ell || x - halfproj < 0.0) crosses++;
+    bench_t bench;
+    bench_init(&bench, "needle_serial", "N=%lld;L=%g;ell=%g;seed=%u", N, L, ell, seed);
+    while (bench_next(&bench)) {
+        crosses = 0;
+        rng32_seed(&rng, seed);
+        double t0 = now_sec();
+        for(long long i=0;i<N;i++){
+            double x = rng32_next01(&rng) * ell; // x en [0, ell]
+            double theta = rng32_next01(&rng) * M_PI; // [0, pi]
+            double halfproj = 0.5 * L * sin(theta);
+            if (x + halfproj > ell || x - halfproj < 0.0) crosses++;
+        }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double p = (double)crosses / (double)N;
     double pi_est = (2.0*L)/(ell*p); // de P = 2L/(pi*ell)
-    printf("pi=%.9f\tN=%lld\tL=%.3f\tell=%.3f\tt=%.3fs\n", pi_est, N, L, ell, t1-t0);
+    printf("pi=%.9f\tN=%lld\tL=%.3f\tell=%.3f\tt=%.3fs\n", pi_est, N, L, ell, secs);
     
+    bench_report(&bench, (double)N, "samples");
+    // Roofline: 9 flops por muestra (2 escalados del rng, x, theta,
+    // 0.5*L*sin con sin() como una operación y las dos comparaciones de
+    // extremos) y sin tráfico de memoria
+    bench_roofline(&bench, "flop", 9.0 * (double)N, 0.0);
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
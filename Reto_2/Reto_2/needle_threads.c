@@ -7,6 +7,8 @@
 #include <math.h>
 #include "rng.h"
 #include "timer.h"
+#include "affinity.h"
+#include "bench.h"
 
 
 #ifndef CACHELINE
@@ -18,14 +20,16 @@ typedef struct {
     long long start, end;
     double L, ell;
     uint32_t seed;
+    int cpu;
+    int pin_err;
     _Alignas(CACHELINE) unsigned long long crosses;
 } task_t;
 
 
 static void* worker(void* arg){
     task_t* t = (task_t*)arg;
-    rng32_t r; 
-    rng32_seed(&r, t->seed);
+    t->pin_err = aff_pin_thread(pthread_self(), t->cpu);
+    rng32_t r; rng32_seed(&r, t->seed);
     unsigned long long local = 0ULL;
     for(long long i=t->start;i<t->end;i++){
         double x = rng32_next01(&r) * t->ell;
@@ -33,7 +37,8 @@ static void* worker(void* arg){
         double halfproj = 0.5 * t->L * sin(theta);
         if (x + halfproj > t->ell || x - halfproj < 0.0) local++;
     }
-    t->crosses = local; return NULL;
+    t->crosses = local;
+    return NULL;
 }
 
 
@@ -43,6 +48,11 @@ int main(int argc, char** argv){
     double L = (argc>3)? atof(argv[3]) : 0.5;
     double ell = (argc>4)? atof(argv[4]) : 1.0;
     uint32_t seed0 = (argc>5)? (uint32_t)atoi(argv[5]) : 12345u;
+    aff_policy_t aff;
+    if (aff_parse((argc>6)? argv[6] : "none", &aff) != 0){
+        fprintf(stderr, "Afinidad inválida: %s (none|compact|scatter|list:0,2,4-7)\n", argv[6]);
+        return 1;
+    }
 
 
     pthread_t* th = calloc(T, sizeof(*th));
@@ -50,21 +60,33 @@ int main(int argc, char** argv){
 
 
     long long chunk = (N + T - 1)/T;
-    double t0 = now_sec();
-    for(int i=0;i<T;i++){
-        tasks[i] = (task_t){ .start=i*chunk, .end=((i+1)*chunk>N?N:(i+1)*chunk), .L=L, .ell=ell,
-        .seed=(seed0 ^ (0x9E3779B9u*(i+1))), .crosses=0ULL };
-        pthread_create(&th[i], NULL, worker, &tasks[i]);
-    }
+    bench_t bench;
+    bench_init(&bench, "needle_threads", "N=%lld;T=%d;L=%g;ell=%g;seed=%u;aff=%s", N, T, L, ell, seed0, aff_name(&aff));
     unsigned long long crosses=0ULL;
-    for(int i=0;i<T;i++){ 
-        pthread_join(th[i], NULL); crosses += tasks[i].crosses; 
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+        for(int i=0;i<T;i++){
+            tasks[i] = (task_t){ .start=i*chunk, .end=((i+1)*chunk>N?N:(i+1)*chunk), .L=L, .ell=ell,
+            .seed=(seed0 ^ (0x9E3779B9u*(i+1))), .cpu=aff_cpu(&aff, i) };
+            pthread_create(&th[i], NULL, worker, &tasks[i]);
+        }
+        crosses = 0ULL;
+        int pin_err = 0;
+        for(int i=0;i<T;i++){ 
+            pthread_join(th[i], NULL);
+            if (tasks[i].pin_err){ aff_pin_error(i, tasks[i].cpu); pin_err = 1; }
+            crosses += tasks[i].crosses;
+        }
+        if (pin_err){ free(th); free(tasks); bench_free(&bench); return 2; }
+        bench_add(&bench, now_sec() - t0);
     }
-    double t1 = now_sec();
+    double secs = bench_median(&bench);
     double p = (double)crosses / (double)N;
     double pi_est = (2.0*L)/(ell*p);
-    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\tt=%.3fs\n", pi_est, N, T, L, ell, t1-t0);
+    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\taff=%s\tt=%.3fs\n", pi_est, N, T, L, ell, aff_name(&aff), secs);
     free(th); 
     free(tasks);
+    bench_report(&bench, (double)N, "samples");
+    bench_free(&bench);
     return 0;
 }
\ No newline at end of file
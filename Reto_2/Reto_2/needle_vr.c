@@ -0,0 +1,97 @@
+// needle_vr.c — aguja de Buffon con muestreo estratificado y pares antitéticos
+#define _GNU_SOURCE
+#define _USE_MATH_DEFINES
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <omp.h>
+#include "rng.h"
+#include "timer.h"
+#include "vr.h"
+#include "bench.h"
+
+// Por simetría se muestrea el dominio reducido (d, theta) con
+// d = distancia a la línea más cercana en [0, ell/2] y theta en [0, pi/2];
+// la probabilidad de cruce es la misma que en (x, theta) sobre [0,ell]x[0,pi].
+// El indicador es monótono en cada coordenada, requisito para que el par
+// antitético (1-u, 1-v) tenga correlación negativa.
+static inline int crosses(double u, double v, double halfL, double ell){
+    double d = u * 0.5 * ell;
+    double theta = v * (0.5 * M_PI);
+    return d < halfL * sin(theta);
+}
+
+int main(int argc, char** argv) {
+    // N = número de lanzamientos de aguja
+    long long N    = (argc > 1) ? atoll(argv[1]) : 100000000LL;
+    // T = hilos
+    int T          = (argc > 2) ? atoi(argv[2]) : 4;
+    // longitud de la aguja
+    double L       = (argc > 3) ? atof(argv[3]) : 0.5;
+    // distancia entre líneas
+    double ell     = (argc > 4) ? atof(argv[4]) : 1.0;
+    // K = estratos por dimensión (K*K en total)
+    int K          = (argc > 5) ? atoi(argv[5]) : 64;
+    // anti = 1 usa pares antitéticos dentro de cada estrato
+    int anti       = (argc > 6) ? atoi(argv[6]) : 1;
+    // semilla base
+    uint32_t seed0 = (argc > 7) ? (uint32_t)atoi(argv[7]) : 12345u;
+
+    if (L > ell) {
+        fprintf(stderr, "Se requiere aguja corta (L <= ell)\n");
+        return 1;
+    }
+    if (K < 1) K = 1;
+    int S = K * K;
+    int k = anti ? 2 : 1;
+    long long units = N / k;
+    if (units < 2LL * S) {
+        fprintf(stderr, "N=%lld demasiado pequeño para %d estratos (min %lld)\n",
+                N, S, 2LL * S * k);
+        return 1;
+    }
+
+    vr_acc_t* acc = aligned_alloc(CACHELINE, ((S*sizeof(*acc) + CACHELINE-1)/CACHELINE)*CACHELINE);
+    if (!acc) { fprintf(stderr, "Fallo de memoria (S=%d)\n", S); return 2; }
+
+    double halfL = 0.5 * L;
+    bench_t bench;
+    bench_init(&bench, "needle_vr", "N=%lld;T=%d;L=%g;ell=%g;K=%d;anti=%d;seed=%u", units * k, T, L, ell, K, anti, seed0);
+    while (bench_next(&bench)) {
+        double t0 = now_sec();
+
+        #pragma omp parallel for num_threads(T) schedule(static)
+        for (int s = 0; s < S; s++) {
+            int ci = s / K, cj = s % K;
+            rng32_t rng;
+            rng32_seed(&rng, seed0 ^ (0x9E3779B9u * (uint32_t)(s + 1)));
+            unsigned long long m = vr_units_for(units, S, s);
+            unsigned long long hits = 0ULL, hits2 = 0ULL;
+            for (unsigned long long u = 0; u < m; u++) {
+                double a = rng32_next01(&rng);
+                double b = rng32_next01(&rng);
+                unsigned h = crosses(vr_cell(ci, K, a), vr_cell(cj, K, b), halfL, ell);
+                if (anti)
+                    h += crosses(vr_cell(ci, K, 1.0 - a), vr_cell(cj, K, 1.0 - b), halfL, ell);
+                hits  += h;
+                hits2 += h * h;
+            }
+            acc[s] = (vr_acc_t){ .units = m, .hits = hits, .hits2 = hits2 };
+        }
+
+        bench_add(&bench, now_sec() - t0);
+    }
+    double secs = bench_median(&bench);
+    vr_result_t r = vr_combine(acc, S, k);
+    free(acc);
+
+    // pi = 2L/(ell p); error propagado por el método delta
+    double pi_est = (2.0 * L) / (ell * r.p);
+    double se = (2.0 * L) / (ell * r.p * r.p) * sqrt(r.var);
+    printf("pi=%.9f\tN=%lld\tT=%d\tL=%.3f\tell=%.3f\tK=%d\tanti=%d\tse=%.3e\tvrf=%.2f\tt=%.3fs\n",
+           pi_est, units * k, T, L, ell, K, anti, se, r.vrf, secs);
+    bench_report(&bench, (double)(units * k), "samples");
+    bench_free(&bench);
+    return 0;
+}
@@ -15,4 +15,23 @@ static inline double rng32_next01(rng32_t* r) {
     // 53-bit mantissa approx: usar 24 bits es suficiente p/ [0,1)
     return (rng32_next(r) >> 8) * (1.0/16777216.0);
 }
+
+// Generador basado en contador (splitmix64): la muestra i se obtiene como
+// función pura de (semilla, i). Rangos de índices disjuntos dan flujos
+// disjuntos, sin importar cuántos procesos/hilos se repartan el trabajo,
+// y el periodo (2^64) alcanza para >10^12 muestras.
+static inline uint64_t rng64_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+static inline uint64_t rng64_at(uint64_t key, uint64_t i) {
+    return rng64_mix(key + (i + 1) * 0x9E3779B97F4A7C15ull);
+}
+// Dos uniformes en [0,1) de 32 bits cada una a partir de la muestra i.
+static inline void rng64_pair01(uint64_t key, uint64_t i, double* a, double* b) {
+    uint64_t z = rng64_at(key, i);
+    *a = (uint32_t)(z >> 32) * (1.0/4294967296.0);
+    *b = (uint32_t)z * (1.0/4294967296.0);
+}
 #endif
\ No newline at end of file
@@ -13,6 +13,13 @@ SEED=42
 NEEDLE_L=0.5
 NEEDLE_ELL=1.0
 
+# afinidad para threads/fork/omp: none | compact | scatter | list:0,2,4-7
+AFFINITY=${AFFINITY:-compact}
+
+# estratos por dimensión y pares antitéticos para *_vr
+VR_STRATA=64
+VR_ANTI=1
+
 RAW_CSV="pi_results_raw.csv"
 AVG_CSV="pi_results_avg.csv"
 LOG_DIR="logs_pi"
@@ -28,6 +35,17 @@ OPT_LEVEL="-O3"
 
 CC=${CC:-gcc}
 
+# Arnés de medición común (bench.h): cada programa añade a BENCH_CSV una fila
+# con la mediana, mínimo, desviación e IC95 del núcleo (sin arranque de proceso)
+COMMON=${COMMON:-../../common}
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV=${BENCH_CSV:-pi_results_bench.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+# Coordenadas roofline (bench_roofline): flops por muestra, sin tráfico
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV=${ROOFLINE_CSV:-pi_results_roofline.csv}
+
 # ---- fuentes ----
 # Asumo que tienes en el mismo dir:
 #  dart_serial.c dart_threads.c dart_fork.c
@@ -39,8 +57,8 @@ compile() {
   local src="$1"
   local out="$2"
   local extra="$3"
-  echo "  $CC $OPT_LEVEL $src -o $out $extra"
-  $CC $OPT_LEVEL "$src" -o "$out" $extra
+  echo "  $CC $OPT_LEVEL -I$COMMON $src $COMMON/bench.c -o $out $extra"
+  $CC $OPT_LEVEL -I"$COMMON" "$src" "$COMMON/bench.c" -o "$out" $extra
 }
 
 # serial
@@ -48,7 +66,7 @@ compile dart_serial.c   dart_serial_o2   "-lm"
 compile needle_serial.c needle_serial_o2 "-lm"
 
 # pthreads
-compile dart_threads.c   dart_threads_o2   "-lm -pthread"
+compile dart_threads.c   dart_threads_o2   "$COMMON/trace.c -lm -pthread"
 compile needle_threads.c needle_threads_o2 "-lm -pthread"
 
 # fork
@@ -59,12 +77,20 @@ compile needle_fork.c needle_fork_o2 "-lm"
 compile dart_omp.c   dart_omp_o2   "-lm -fopenmp"
 compile needle_omp.c needle_omp_o2 "-lm -fopenmp"
 
+# reducción de varianza (estratificado + antitético, OpenMP)
+compile dart_vr.c   dart_vr_o2   "-lm -fopenmp"
+compile needle_vr.c needle_vr_o2 "-lm -fopenmp"
+
 echo "[INFO] Compilación terminada."
 
 # ==================================================
 # 2. EJECUCIÓN DE BENCHMARKS
 # ==================================================
 echo "algo,impl,N,workers,iter,seconds,pi" > "$RAW_CSV"
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
 
 cleanup() { rm -f tmp.out tmp.err; }
 trap cleanup EXIT
@@ -122,7 +148,8 @@ for b in \
   dart_serial_o2 needle_serial_o2 \
   dart_threads_o2 needle_threads_o2 \
   dart_fork_o2 needle_fork_o2 \
-  dart_omp_o2 needle_omp_o2
+  dart_omp_o2 needle_omp_o2 \
+  dart_vr_o2 needle_vr_o2
 do
   ensure_bin "$b"
 done
@@ -150,13 +177,13 @@ for algo in dart needle; do
     for th in "${THREADS[@]}"; do
       for ((it=1; it<=REPEATS; it++)); do
         if [[ "$algo" == "dart" ]]; then
-          read -r secs rc < <(run_with_timing ./dart_threads_o2 "$N" "$th" "$SEED")
+          read -r secs rc < <(run_with_timing ./dart_threads_o2 "$N" "$th" "$SEED" "$AFFINITY")
         else
-          read -r secs rc < <(run_with_timing ./needle_threads_o2 "$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED")
+          read -r secs rc < <(run_with_timing ./needle_threads_o2 "$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED" "$AFFINITY")
         fi
         pi=$(extract_pi)
         echo "$algo,threads,$N,$th,$it,$secs,$pi" >> "$RAW_CSV"
-        append_logs "$algo" "threads" "N=$N T=$th it=$it rc=$rc"
+        append_logs "$algo" "threads" "N=$N T=$th aff=$AFFINITY it=$it rc=$rc"
       done
     done
   done
@@ -166,13 +193,13 @@ for algo in dart needle; do
     for pc in "${PROCS[@]}"; do
       for ((it=1; it<=REPEATS; it++)); do
         if [[ "$algo" == "dart" ]]; then
-          read -r secs rc < <(run_with_timing ./dart_fork_o2 "$N" "$pc" "$SEED")
+          read -r secs rc < <(run_with_timing ./dart_fork_o2 "$N" "$pc" "$SEED" "$AFFINITY")
         else
-          read -r secs rc < <(run_with_timing ./needle_fork_o2 "$N" "$pc" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED")
+          read -r secs rc < <(run_with_timing ./needle_fork_o2 "$N" "$pc" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED" "$AFFINITY")
         fi
         pi=$(extract_pi)
         echo "$algo,fork,$N,$pc,$it,$secs,$pi" >> "$RAW_CSV"
-        append_logs "$algo" "fork" "N=$N P=$pc it=$it rc=$rc"
+        append_logs "$algo" "fork" "N=$N P=$pc aff=$AFFINITY it=$it rc=$rc"
       done
     done
   done
@@ -182,13 +209,29 @@ for algo in dart needle; do
     for th in "${THREADS[@]}"; do
       for ((it=1; it<=REPEATS; it++)); do
         if [[ "$algo" == "dart" ]]; then
-          read -r secs rc < <(run_with_timing OMP_NUM_THREADS=$th ./dart_omp_o2 "$N" "$th" "$SEED")
+          read -r secs rc < <(run_with_timing OMP_NUM_THREADS=$th ./dart_omp_o2 "$N" "$th" "$SEED" "$AFFINITY")
         else
-          read -r secs rc < <(run_with_timing OMP_NUM_THREADS=$th ./needle_omp_o2 "$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED")
+          read -r secs rc < <(run_with_timing OMP_NUM_THREADS=$th ./needle_omp_o2 "$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED" "$AFFINITY")
         fi
         pi=$(extract_pi)
         echo "$algo,omp,$N,$th,$it,$secs,$pi" >> "$RAW_CSV"
-        append_logs "$algo" "omp" "N=$N T=$th it=$it rc=$rc"
+        append_logs "$algo" "omp" "N=$N T=$th aff=$AFFINITY it=$it rc=$rc"
+      done
+    done
+  done
+
+  # ===== Reducción de varianza (OpenMP) =====
+  for N in "${NPOINTS[@]}"; do
+    for th in "${THREADS[@]}"; do
+      for ((it=1; it<=REPEATS; it++)); do
+        if [[ "$algo" == "dart" ]]; then
+          read -r secs rc < <(run_with_timing ./dart_vr_o2 "$N" "$th" "$VR_STRATA" "$VR_ANTI" "$SEED")
+        else
+          read -r secs rc < <(run_with_timing ./needle_vr_o2 "$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$VR_STRATA" "$VR_ANTI" "$SEED")
+        fi
+        pi=$(extract_pi)
+        echo "$algo,vr,$N,$th,$it,$secs,$pi" >> "$RAW_CSV"
+        append_logs "$algo" "vr" "N=$N T=$th K=$VR_STRATA anti=$VR_ANTI it=$it rc=$rc"
       done
     done
   done
@@ -214,4 +257,5 @@ END {
 echo "[OK] Listo."
 echo "  - Resultados crudos: $RAW_CSV"
 echo "  - Promedios:         $AVG_CSV"
+echo "  - Núcleo (bench.h):  $BENCH_CSV"
 echo "  - Logs:              $LOG_DIR/"
@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# =========================================
+# Benchmark del backend MPI + OpenMP (dart_mpi / needle_mpi)
+# Se puede probar con varios ranks en un solo equipo:
+#   MPIRUN_FLAGS="--oversubscribe" ./run_mpi.sh
+# En el clúster: MPIRUN_FLAGS="--hostfile hosts" NPOINTS="1000000000000" ./run_mpi.sh
+# =========================================
+read -r -a NPOINTS <<< "${NPOINTS:-200000000 800000000 1600000000}"
+read -r -a RANKS   <<< "${RANKS:-1 2 4}"
+read -r -a THREADS <<< "${THREADS:-1 2 4}"
+REPEATS=${REPEATS:-3}
+SEED=${SEED:-42}
+
+NEEDLE_L=0.5
+NEEDLE_ELL=1.0
+
+MPIRUN=${MPIRUN:-mpirun}
+MPIRUN_FLAGS=${MPIRUN_FLAGS:-}
+MPICC=${MPICC:-mpicc}
+OPT_LEVEL="-O3"
+COMMON=${COMMON:-../../common}
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV=${BENCH_CSV:-pi_results_mpi_bench.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV=${ROOFLINE_CSV:-pi_results_mpi_roofline.csv}
+
+RAW_CSV="pi_results_mpi.csv"
+LOG_DIR="logs_pi"
+mkdir -p "$LOG_DIR"
+
+echo "[INFO] Compilando binarios MPI..."
+echo "  $MPICC $OPT_LEVEL -I$COMMON dart_mpi.c $COMMON/bench.c -o dart_mpi_o2 -lm -fopenmp"
+$MPICC $OPT_LEVEL -I"$COMMON" dart_mpi.c "$COMMON/bench.c" -o dart_mpi_o2 -lm -fopenmp
+echo "  $MPICC $OPT_LEVEL -I$COMMON needle_mpi.c $COMMON/bench.c -o needle_mpi_o2 -lm -fopenmp"
+$MPICC $OPT_LEVEL -I"$COMMON" needle_mpi.c "$COMMON/bench.c" -o needle_mpi_o2 -lm -fopenmp
+
+field() { grep -o "$1=[^[:space:]]*" tmp_mpi.out | cut -d'=' -f2 | sed 's/[s\/]*$//'; }
+trap 'rm -f tmp_mpi.out' EXIT
+
+echo "algo,impl,N,ranks,threads,iter,seconds,pi,rate" > "$RAW_CSV"
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
+
+for algo in dart needle; do
+  for N in "${NPOINTS[@]}"; do
+    for np in "${RANKS[@]}"; do
+      for th in "${THREADS[@]}"; do
+        for ((it=1; it<=REPEATS; it++)); do
+          if [[ "$algo" == "dart" ]]; then
+            args=("$N" "$th" "$SEED")
+          else
+            args=("$N" "$th" "$NEEDLE_L" "$NEEDLE_ELL" "$SEED")
+          fi
+          # shellcheck disable=SC2086
+          OMP_NUM_THREADS=$th $MPIRUN -np "$np" $MPIRUN_FLAGS "./${algo}_mpi_o2" "${args[@]}" > tmp_mpi.out
+          cat tmp_mpi.out >> "$LOG_DIR/${algo}_mpi.log"
+          echo "$algo,mpi,$N,$np,$th,$it,$(field t),$(field pi),$(field rate)" >> "$RAW_CSV"
+        done
+      done
+    done
+  done
+done
+
+echo "[OK] Resultados en $RAW_CSV (núcleo: $BENCH_CSV)"
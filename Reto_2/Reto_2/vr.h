@@ -0,0 +1,64 @@
+#ifndef VR_H
+#define VR_H
+#include <stdint.h>
+#include <math.h>
+
+// Reducción de varianza: muestreo estratificado + antitético.
+//
+// El dominio (normalizado a [0,1]^2) se parte en K x K estratos de igual área.
+// Cada estrato recibe m_s "unidades": una muestra simple, o un par antitético
+// (u,v) / (u',v') reflejado dentro del propio estrato. Por estrato se guardan
+// la suma y la suma de cuadrados del número de aciertos por unidad (enteros de
+// 64 bits, sin error de redondeo) y al final se combinan con pesos w_s = 1/S.
+
+#ifndef CACHELINE
+#define CACHELINE 64
+#endif
+
+typedef struct {
+    unsigned long long units;   // unidades evaluadas (muestra o par)
+    unsigned long long hits;    // sum h  (h = aciertos en la unidad: 0..k)
+    unsigned long long hits2;   // sum h^2
+} vr_acc_t;
+
+typedef struct {
+    double p;        // estimación combinada de la probabilidad de acierto
+    double var;      // varianza estimada del estimador combinado
+    double var_mc;   // varianza de MC simple con el mismo número de muestras
+    double vrf;      // factor de reducción: var_mc / var
+} vr_result_t;
+
+// Unidades que le tocan al estrato s (el resto se reparte en los primeros).
+static inline unsigned long long vr_units_for(long long units_total, int S, int s){
+    unsigned long long base = (unsigned long long)units_total / (unsigned long long)S;
+    unsigned long long rem  = (unsigned long long)units_total % (unsigned long long)S;
+    return base + ((unsigned long long)s < rem);
+}
+
+// Coordenada en [lo, lo+1/K) del estrato a partir de u en [0,1).
+static inline double vr_cell(int idx, int K, double u){
+    return (idx + u) / (double)K;
+}
+
+// Combina los S acumuladores. k = muestras por unidad (1 simple, 2 antitético).
+static inline vr_result_t vr_combine(const vr_acc_t* acc, int S, int k){
+    vr_result_t r = {0.0, 0.0, 0.0, 0.0};
+    double w = 1.0 / (double)S;
+    unsigned long long samples = 0ULL;
+    for(int s=0;s<S;s++){
+        double m = (double)acc[s].units;
+        if (m < 1.0) continue;
+        double mean = (double)acc[s].hits / m;                // media de h
+        r.p += w * mean / k;
+        if (m > 1.0){
+            double s2 = ((double)acc[s].hits2 - m*mean*mean) / (m - 1.0);
+            if (s2 < 0.0) s2 = 0.0;
+            r.var += w*w * (s2 / (k*k)) / m;                   // var de la media de g = h/k
+        }
+        samples += acc[s].units * (unsigned long long)k;
+    }
+    r.var_mc = (samples > 0) ? r.p*(1.0 - r.p) / (double)samples : 0.0;
+    r.vrf = (r.var > 0.0) ? r.var_mc / r.var : INFINITY;
+    return r;
+}
+#endif
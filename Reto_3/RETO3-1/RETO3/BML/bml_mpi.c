@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <mpi.h>
+#include "../common/ca_opts.h"
+#include "../common/ca_bits.h"
+#include "bench.h"
+
+// Modelo de tráfico 2D de Biham–Middleton–Levine sobre una malla periódica
+// de R filas x C columnas. Dos tipos de coche: los del este avanzan una
+// columna a la derecha y los del norte una fila hacia arriba (fila - 1), solo
+// si la celda destino está vacía. Cada iteración son dos subpasos: primero se
+// mueven todos los del este y después todos los del norte.
+//
+// Descomposición 2D con MPI_Cart_create: cada rank tiene un bloque de
+// lr x lc celdas con una celda fantasma por lado. Antes del subpaso este se
+// intercambian columnas y antes del norte filas, con tipos derivados (vector
+// para columnas, contiguo para filas), sin empaquetar a mano. Las esquinas
+// no se usan.
+
+// Estado inicial por celda a partir de un hash de (semilla, celda global):
+// independiente de la descomposición, cada rank genera su bloque.
+enum { BML_EMPTY = 0, BML_EAST = 1, BML_NORTH = 2 };
+
+static inline uint64_t bml_hash(uint64_t seed, uint64_t cell) {
+    uint64_t z = seed + (cell + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Mitad de la densidad para cada tipo.
+static inline int bml_init_cell(uint64_t seed, double density, long long C, long long gi, long long gj) {
+    double u = (double)(bml_hash(seed, (uint64_t)(gi * C + gj)) >> 11) * 0x1.0p-53;
+    return (u < 0.5 * density) ? BML_EAST : (u < density) ? BML_NORTH : BML_EMPTY;
+}
+
+typedef struct {
+    MPI_Comm cart;
+    int up, down, left, right;  // vecinos: fila-1, fila+1, columna-1, columna+1
+    long long R, C;
+    int lr, lc;                 // bloque local
+    long long gi0, gj0;         // celda global (0,0) del bloque
+    int iterations;
+    double density;
+    uint64_t seed;
+} bml_t;
+
+typedef struct {
+    long long cars;     // coches totales (global)
+    double secs;        // tiempo del bucle
+    double wait;        // tiempo local en intercambios de halos
+} bml_result_t;
+
+// Motor de un byte por celda. Malla local (lr+2) x (lc+2).
+static long long run_u8(const bml_t *g, bml_result_t *res) {
+    int lr = g->lr, lc = g->lc;
+    int S = lc + 2;  // stride de fila
+    uint8_t *grid = (uint8_t *)calloc((size_t)(lr + 2) * S, 1);
+    uint8_t *row_tmp = (uint8_t *)malloc(S);
+    uint8_t *prev = (uint8_t *)malloc(S);
+
+    if (!grid || !row_tmp || !prev) {
+        fprintf(stderr, "Error de memoria.\n");
+        free(grid);
+        free(row_tmp);
+        free(prev);
+        return -1;
+    }
+
+    long long cars_local = 0;
+    for (int i = 1; i <= lr; i++) {
+        for (int j = 1; j <= lc; j++) {
+            uint8_t v = (uint8_t)bml_init_cell(g->seed, g->density, g->C, g->gi0 + i - 1, g->gj0 + j - 1);
+            grid[(size_t)i * S + j] = v;
+            cars_local += (v != BML_EMPTY);
+        }
+    }
+    MPI_Allreduce(&cars_local, &res->cars, 1, MPI_LONG_LONG, MPI_SUM, g->cart);
+
+    // Columna: lr bytes separados por S; fila: lc bytes contiguos
+    MPI_Datatype col_t, row_t;
+    MPI_Type_vector(lr, 1, S, MPI_UINT8_T, &col_t);
+    MPI_Type_commit(&col_t);
+    MPI_Type_contiguous(lc, MPI_UINT8_T, &row_t);
+    MPI_Type_commit(&row_t);
+
+    long long local_moves = 0;
+    double start_time = MPI_Wtime();
+
+    for (int iter = 0; iter < g->iterations; iter++) {
+        double tw = MPI_Wtime();
+        MPI_Sendrecv(&grid[S + 1], 1, col_t, g->left, 0,
+                     &grid[S + lc + 1], 1, col_t, g->right, 0, g->cart, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(&grid[S + lc], 1, col_t, g->right, 1,
+                     &grid[S], 1, col_t, g->left, 1, g->cart, MPI_STATUS_IGNORE);
+        res->wait += MPI_Wtime() - tw;
+
+        // Subpaso este: cada fila depende solo de sí misma
+        for (int i = 1; i <= lr; i++) {
+            uint8_t *c = &grid[(size_t)i * S];
+            long long m = 0;
+            for (int j = 1; j <= lc; j++) {
+                uint8_t L = c[j - 1], X = c[j], Rr = c[j + 1];
+                uint8_t stay = (X == BML_EAST) & (Rr != BML_EMPTY);
+                uint8_t arrive = (X == BML_EMPTY) & (L == BML_EAST);
+                row_tmp[j] = (uint8_t)(((X == BML_NORTH) << 1) | stay | arrive);
+                m += (X == BML_EAST) & (Rr == BML_EMPTY);
+            }
+            memcpy(&c[1], &row_tmp[1], lc);
+            local_moves += m;
+        }
+
+        tw = MPI_Wtime();
+        MPI_Sendrecv(&grid[S + 1], 1, row_t, g->up, 2,
+                     &grid[(size_t)(lr + 1) * S + 1], 1, row_t, g->down, 2, g->cart, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(&grid[(size_t)lr * S + 1], 1, row_t, g->down, 3,
+                     &grid[1], 1, row_t, g->up, 3, g->cart, MPI_STATUS_IGNORE);
+        res->wait += MPI_Wtime() - tw;
+
+        // Subpaso norte, en el sitio de arriba abajo: prev guarda la fila
+        // anterior antes de actualizarla
+        memcpy(prev, grid, S);
+        for (int i = 1; i <= lr; i++) {
+            uint8_t *c = &grid[(size_t)i * S];
+            const uint8_t *dn = c + S;
+            long long m = 0;
+            for (int j = 1; j <= lc; j++) {
+                uint8_t X = c[j], U = prev[j], D = dn[j];
+                uint8_t stay = (X == BML_NORTH) & (U != BML_EMPTY);
+                uint8_t arrive = (X == BML_EMPTY) & (D == BML_NORTH);
+                row_tmp[j] = (uint8_t)((X == BML_EAST) | ((stay | arrive) << 1));
+                m += (X == BML_NORTH) & (U == BML_EMPTY);
+            }
+            memcpy(prev, c, S);
+            memcpy(&c[1], &row_tmp[1], lc);
+            local_moves += m;
+        }
+    }
+
+    long long global_moves = 0;
+    MPI_Reduce(&local_moves, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, g->cart);
+    res->secs = MPI_Wtime() - start_time;
+
+    MPI_Type_free(&col_t);
+    MPI_Type_free(&row_t);
+    free(grid);
+    free(row_tmp);
+    free(prev);
+    return global_moves;
+}
+
+// Motor empaquetado: dos planos de bits (este y norte), 64 celdas por
+// palabra. Cada fila ocupa WR = W + 2 palabras: [0] fantasma izquierdo (la
+// última palabra real del vecino), [1..W] reales y [W+1] fantasma derecho (la
+// primera del vecino). Todos los bloques tienen el mismo lc, así que la celda a
+// la izquierda de la columna 0 es el bit tail-1 del fantasma izquierdo.
+// Los dos planos van en una sola reserva para que un único tipo derivado
+// (hvector sobre los planos) mueva columna o fila de ambos.
+static long long run_bits(const bml_t *g, bml_result_t *res) {
+    int lr = g->lr, lc = g->lc;
+    size_t W = ca_bits_words(lc);
+    unsigned tail = ca_bits_tail(lc);
+    uint64_t mask = ca_bits_tailmask(tail);
+    size_t WR = W + 2;
+    size_t plane = (size_t)(lr + 2) * WR;
+    uint64_t *grid = (uint64_t *)calloc(2 * plane, sizeof(uint64_t));
+    uint64_t *row_tmp = (uint64_t *)malloc(WR * sizeof(uint64_t));
+    uint64_t *prev_occ = (uint64_t *)malloc(WR * sizeof(uint64_t));
+
+    if (!grid || !row_tmp || !prev_occ) {
+        fprintf(stderr, "Error de memoria.\n");
+        free(grid);
+        free(row_tmp);
+        free(prev_occ);
+        return -1;
+    }
+    uint64_t *east = grid, *north = grid + plane;
+
+    long long cars_local = 0;
+    for (int i = 1; i <= lr; i++) {
+        for (int j = 0; j < lc; j++) {
+            int v = bml_init_cell(g->seed, g->density, g->C, g->gi0 + i - 1, g->gj0 + j);
+            ca_bits_set(&east[(size_t)i * WR + 1], j, v == BML_EAST);
+            ca_bits_set(&north[(size_t)i * WR + 1], j, v == BML_NORTH);
+            cars_local += (v != BML_EMPTY);
+        }
+    }
+    MPI_Allreduce(&cars_local, &res->cars, 1, MPI_LONG_LONG, MPI_SUM, g->cart);
+
+    // Columna de palabras (una por fila) y fila de W palabras, en ambos planos
+    MPI_Datatype col1, col_t, row_t;
+    MPI_Type_vector(lr, 1, (int)WR, MPI_UINT64_T, &col1);
+    MPI_Type_create_hvector(2, 1, (MPI_Aint)(plane * sizeof(uint64_t)), col1, &col_t);
+    MPI_Type_commit(&col_t);
+    MPI_Type_create_hvector(2, (int)W, (MPI_Aint)(plane * sizeof(uint64_t)), MPI_UINT64_T, &row_t);
+    MPI_Type_commit(&row_t);
+
+    long long local_moves = 0;
+    double start_time = MPI_Wtime();
+
+    for (int iter = 0; iter < g->iterations; iter++) {
+        double tw = MPI_Wtime();
+        MPI_Sendrecv(&grid[WR + 1], 1, col_t, g->left, 0,
+                     &grid[WR + W + 1], 1, col_t, g->right, 0, g->cart, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(&grid[WR + W], 1, col_t, g->right, 1,
+                     &grid[WR], 1, col_t, g->left, 1, g->cart, MPI_STATUS_IGNORE);
+        res->wait += MPI_Wtime() - tw;
+
+        // Subpaso este: E' = (E & occ>>1) | (E<<1 & ~occ), occ = E | N
+        for (int i = 1; i <= lr; i++) {
+            const uint64_t *e = &east[(size_t)i * WR];
+            const uint64_t *n = &north[(size_t)i * WR];
+            uint64_t carry = (e[0] >> (tail - 1)) & 1ULL;
+            long long m = 0;
+            for (size_t j = 1; j <= W; j++) {
+                uint64_t ew = e[j];
+                uint64_t occ = ew | n[j];
+                uint64_t occ_next = (j < W) ? ((e[j + 1] | n[j + 1]) << 63)
+                                            : (((e[W + 1] | n[W + 1]) & 1ULL) << (tail - 1));
+                uint64_t R = (occ >> 1) | occ_next;
+                uint64_t L = (ew << 1) | carry;
+                uint64_t nw = (ew & R) | (L & ~occ);
+                if (j == W) nw &= mask;
+                row_tmp[j] = nw;
+                m += __builtin_popcountll(ew & ~R);
+                carry = ew >> 63;
+            }
+            memcpy((uint64_t *)&e[1], &row_tmp[1], W * sizeof(uint64_t));
+            local_moves += m;
+        }
+
+        tw = MPI_Wtime();
+        MPI_Sendrecv(&grid[WR + 1], 1, row_t, g->up, 2,
+                     &grid[(size_t)(lr + 1) * WR + 1], 1, row_t, g->down, 2, g->cart, MPI_STATUS_IGNORE);
+        MPI_Sendrecv(&grid[(size_t)lr * WR + 1], 1, row_t, g->down, 3,
+                     &grid[1], 1, row_t, g->up, 3, g->cart, MPI_STATUS_IGNORE);
+        res->wait += MPI_Wtime() - tw;
+
+        // Subpaso norte, palabra a palabra sin desplazamientos:
+        // N' = (N & occ_arriba) | (N_abajo & ~occ). prev_occ guarda la
+        // ocupación de la fila de arriba antes de actualizarla.
+        for (size_t j = 1; j <= W; j++) {
+            prev_occ[j] = east[j] | north[j];
+        }
+        for (int i = 1; i <= lr; i++) {
+            const uint64_t *e = &east[(size_t)i * WR];
+            uint64_t *n = &north[(size_t)i * WR];
+            const uint64_t *nd = n + WR;
+            long long m = 0;
+            for (size_t j = 1; j <= W; j++) {
+                uint64_t nw = n[j];
+                uint64_t occ = e[j] | nw;
+                uint64_t up = prev_occ[j];
+                prev_occ[j] = occ;
+                n[j] = (nw & up) | (nd[j] & ~occ);
+                m += __builtin_popcountll(nw & ~up);
+            }
+            local_moves += m;
+        }
+    }
+
+    long long global_moves = 0;
+    MPI_Reduce(&local_moves, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, g->cart);
+    res->secs = MPI_Wtime() - start_time;
+
+    MPI_Type_free(&col1);
+    MPI_Type_free(&col_t);
+    MPI_Type_free(&row_t);
+    free(grid);
+    free(row_tmp);
+    free(prev_occ);
+    return global_moves;
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    if (argc < 4) {
+        if (rank == 0) {
+            fprintf(stderr, "Uso: %s <rows> <cols> <iterations> [engine=u8|bits] [density=D] [seed=S] [py=P] [px=P] [waits=0|1]\n", argv[0]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    long long R = atoll(argv[1]);
+    long long C = atoll(argv[2]);
+    int iterations = atoi(argv[3]);
+
+    if (R <= 0 || C <= 0 || iterations <= 0) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: rows, cols e iterations deben ser positivos.\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (ca_opts_check(argc, argv, 4, "engine density seed py px waits")) {
+        MPI_Finalize();
+        return 1;
+    }
+    const char *engine = ca_opt_str(argc, argv, 4, "engine", "bits");
+    int use_bits = (strcmp(engine, "bits") == 0);
+    if (!use_bits && strcmp(engine, "u8") != 0) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: engine desconocido '%s' (u8|bits).\n", engine);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Malla de procesos: py filas x px columnas (0 = la elige MPI_Dims_create)
+    int dims[2] = { (int)ca_opt_ll(argc, argv, 4, "py", 0), (int)ca_opt_ll(argc, argv, 4, "px", 0) };
+    if (dims[0] < 0 || dims[1] < 0 || MPI_Dims_create(size, 2, dims) != MPI_SUCCESS || dims[0] * dims[1] != size) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: py x px debe ser igual al número de procesos (%d).\n", size);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    // Para simplificar, bloques iguales
+    if (R % dims[0] != 0 || C % dims[1] != 0) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: rows (%lld) y cols (%lld) deben ser divisibles por la malla %dx%d.\n",
+                    R, C, dims[0], dims[1]);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    bml_t g = {
+        .R = R,
+        .C = C,
+        .lr = (int)(R / dims[0]),
+        .lc = (int)(C / dims[1]),
+        .iterations = iterations,
+        .density = ca_opt_dbl(argc, argv, 4, "density", 0.3),
+        .seed = (uint64_t)ca_opt_ll(argc, argv, 4, "seed", 1),
+    };
+    int waits = (int)ca_opt_ll(argc, argv, 4, "waits", 0) != 0;
+
+    int periods[2] = { 1, 1 };
+    int coords[2];
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &g.cart);
+    MPI_Comm_rank(g.cart, &rank);
+    MPI_Cart_coords(g.cart, rank, 2, coords);
+    MPI_Cart_shift(g.cart, 0, 1, &g.up, &g.down);
+    MPI_Cart_shift(g.cart, 1, 1, &g.left, &g.right);
+    g.gi0 = (long long)coords[0] * g.lr;
+    g.gj0 = (long long)coords[1] * g.lc;
+
+    // Repeticiones medidas (BENCH_WARMUP/BENCH_REPS, bench.h); la muestra es
+    // el tiempo del bucle del rank más lento y res.secs pasa a ser su mediana
+    bench_t bench;
+    bench_init(&bench, "bml_mpi", "rows=%lld;cols=%lld;iterations=%d;engine=%s;ranks=%d;density=%g;seed=%llu", R, C,
+               iterations, engine, size, g.density, (unsigned long long)g.seed);
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, g.cart);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, g.cart);
+
+    bml_result_t res = { 0, 0.0, 0.0 };
+    long long global_moves = 0;
+    while (bench_next(&bench)) {
+        res = (bml_result_t){ 0, 0.0, 0.0 };
+        global_moves = use_bits ? run_bits(&g, &res) : run_u8(&g, &res);
+        if (global_moves < 0) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        // La muestra es el bucle del rank más lento
+        double slowest = res.secs;
+        MPI_Reduce(&res.secs, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, g.cart);
+        if (rank == 0) {
+            bench_add(&bench, slowest);
+        }
+    }
+    if (rank == 0) {
+        res.secs = bench_median(&bench);
+    }
+
+    // Tiempo de espera de halos por rank (stderr, para no romper el CSV)
+    if (waits) {
+        double *all_waits = (rank == 0) ? (double *)malloc(size * sizeof(double)) : NULL;
+        MPI_Gather(&res.wait, 1, MPI_DOUBLE, all_waits, 1, MPI_DOUBLE, 0, g.cart);
+        if (rank == 0) {
+            for (int r = 0; r < size; r++) {
+                fprintf(stderr, "[waits] rank=%d wait=%.6f s (%.1f%% del bucle)\n",
+                        r, all_waits[r], res.secs > 0.0 ? 100.0 * all_waits[r] / res.secs : 0.0);
+            }
+            free(all_waits);
+        }
+    }
+
+    // moves, tiempo, velocidad media y sitios actualizados por segundo
+    if (rank == 0) {
+        double sites = (double)R * (double)C * iterations;
+        if (res.cars == 0) {
+            printf("0, %f, 0.0, %.6e\n", res.secs, res.secs > 0.0 ? sites / res.secs : 0.0);
+        } else {
+            double average_velocity = (double)global_moves / ((double)iterations * res.cars);
+            printf("%lld, %f, %f, %.6e\n", global_moves, res.secs, average_velocity,
+                   res.secs > 0.0 ? sites / res.secs : 0.0);
+        }
+        bench_report(&bench, sites, "site_updates");
+    }
+    bench_free(&bench);
+
+    MPI_Comm_free(&g.cart);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Compilar el programa BML 2D con optimización
+COMMON=${COMMON:-../../../../common}
+mpicc -O3 -Wall -I"$COMMON" -o bml_mpi_exe bml_mpi.c "$COMMON/bench.c" -lm
+echo "Compilación del programa BML completada."
+
+# Tiempos del bucle con mediana, mínimo, desviación e IC95 (bench.h)
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV=${BENCH_CSV:-results_bml_bench.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+
+# Mismo formato que results_mpi.csv, con dos columnas más al final
+echo "Tipo, Tamaño, Repeticion, Movimientos totales, Tiempo total, Velocidad promedio, Sitios por segundo, Procesos" > results_bml.csv
+
+# Parámetros de simulación
+iterations=1000
+procs=(1 2 4)
+# Escalamiento fuerte: malla fija de lado strong_side
+strong_side=${STRONG_SIDE:-1024}
+# Escalamiento débil: weak_side filas por proceso x weak_side columnas
+weak_side=${WEAK_SIDE:-512}
+# Motor: bits (dos planos de bits) o u8 (un byte por celda)
+engine=${ENGINE:-bits}
+density=${DENSITY:-0.3}
+
+run_bml() {
+    local tipo=$1 rows=$2 cols=$3 np=$4 rep=$5
+    local out
+    out=$(mpirun -np "$np" ./bml_mpi_exe "$rows" "$cols" "$iterations" engine="$engine" density="$density")
+    if [ $? -eq 0 ]; then
+        echo "$tipo, ${rows}x${cols}, $rep, $out, $np" >> results_bml.csv
+    else
+        echo "Fallo en la ejecución BML ($tipo) para ${rows}x${cols} con $np procesos"
+    fi
+}
+
+if command -v mpirun >/dev/null 2>&1; then
+    for i in {1..10}; do
+        echo "Iniciando repetición $i de 10..."
+        for np in "${procs[@]}"; do
+            run_bml "BML-fuerte" "$strong_side" "$strong_side" "$np" "$i"
+            run_bml "BML-debil" $((weak_side * np)) "$weak_side" "$np" "$i"
+        done
+        echo "" >> results_bml.csv
+    done
+    echo "Todas las simulaciones BML han finalizado con éxito."
+else
+    echo "MPI no está disponible, omitiendo la ejecución BML."
+fi
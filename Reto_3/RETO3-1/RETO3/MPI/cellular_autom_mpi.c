@@ -1,25 +1,1225 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
 #include <mpi.h>
+#include "../common/ca_opts.h"
+#include "../common/ca_bits.h"
+#include "../common/ca_ff.h"
+#include "../common/ca_init.h"
+#include "../common/ca_roofline.h"
+#include "../common/ca_rules.h"
+#include "../common/ca_nasch.h"
+#include "../common/ca_snap_mpi.h"
+#include "../common/ca_sparse.h"
+#include "../common/ca_sweep.h"
+#include "../common/ca_u8.h"
+#include "bench.h"
+#include "arena.h"
+#include "trace.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Parámetros de la simulación (opciones clave=valor) y resultados por rank.
+typedef struct {
+    MPI_Comm comm;  // procesos de la corrida: MPI_COMM_WORLD o un grupo del barrido
+    int halo;       // ancho de halo k
+    int progress;   // informe de progreso cada P iteraciones (0 = no)
+    int overlap;    // 1: halos con peticiones persistentes solapados con el interior
+    int rule;       // regla elemental del motor bits (0..255)
+    int vmax;       // velocidad máxima del motor nasch
+    int ff;         // avance rápido: comprobar régimen estacionario cada P pasos (0 = no)
+    ca_init_t init; // generador de la carretera inicial (semilla y densidad)
+    ca_nasch_t nasch;
+} ca_cfg_t;
+
+typedef struct {
+    long long cars;     // coches totales (global)
+    double secs;        // tiempo del bucle
+    double wait;        // tiempo local bloqueado en el intercambio de halos
+    ca_ff_t ff;         // paso y pasos extrapolados por el avance rápido
+} ca_result_t;
+
+// Progreso opcional (progress=P): cada P iteraciones se lanza un
+// MPI_Iallreduce no bloqueante de los movimientos acumulados, que se solapa
+// con los pasos siguientes; rank 0 lo informa por stderr al completarse.
+typedef struct {
+    int every;
+    int iterations;
+    int active;
+    int iter;
+    long long send, recv;
+    MPI_Request req;
+    MPI_Comm comm;
+} progress_t;
+
+static void progress_report(progress_t *p, int rank) {
+    if (rank == 0) {
+        fprintf(stderr, "[progreso] iter=%d/%d moves=%lld\n", p->iter, p->iterations, p->recv);
+    }
+    p->active = 0;
+}
+
+static void progress_step(progress_t *p, int rank, int iter, long long local_moves) {
+    if (p->every <= 0) {
+        return;
+    }
+    if (p->active) {
+        int done = 0;
+        MPI_Test(&p->req, &done, MPI_STATUS_IGNORE);
+        if (done) {
+            progress_report(p, rank);
+        }
+    }
+    if (iter % p->every == 0 && iter < p->iterations) {
+        if (p->active) {
+            TRACE_BEGIN("progress_wait");
+            MPI_Wait(&p->req, MPI_STATUS_IGNORE);
+            TRACE_END("progress_wait");
+            progress_report(p, rank);
+        }
+        p->send = local_moves;
+        p->iter = iter;
+        MPI_Iallreduce(&p->send, &p->recv, 1, MPI_LONG_LONG, MPI_SUM, p->comm, &p->req);
+        p->active = 1;
+    }
+}
+
+static void progress_end(progress_t *p, int rank) {
+    if (p->active) {
+        MPI_Wait(&p->req, MPI_STATUS_IGNORE);
+        progress_report(p, rank);
+    }
+}
+
+// Snapshots (snap=P, snapfile=F) y reanudación (restart=F) con MPI-IO. Con
+// restart cada rank parte de su tramo del último marco, en su paso y con los
+// movimientos acumulados (sumados en rank 0), así que la salida final es la
+// de una corrida ininterrumpida; el número de procesos puede cambiar. Solo
+// en la corrida única (MPI_COMM_WORLD), no en el barrido.
+typedef struct {
+    long long every;        // un marco cada P pasos (0 = sin snapshots)
+    const char *path;
+    const char *restart;
+    int rule;
+    uint64_t *init;         // tramo local restaurado (NULL = aleatorio)
+    int start;              // primer paso a simular
+    long long moves0;       // movimientos globales hasta start
+    long long cars0;        // coches del encabezado
+    uint64_t *seg;          // tramo local empaquetado para el marco
+    ca_snap_mpi_t f;
+    int frames;
+    double io;              // segundos en snapshots (empaquetado, reducción y esperas)
+} snap_t;
+
+static int snap_open(snap_t *sn, int rank, long long N, long long g0, int local_N, long long cars) {
+    if (sn->every <= 0) {
+        return 0;
+    }
+    sn->seg = (uint64_t *)calloc(ca_bits_words(local_N) + 1, sizeof(uint64_t));
+    if (!sn->seg) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        return 1;
+    }
+    int append = sn->restart && strcmp(sn->restart, sn->path) == 0;
+    return ca_snap_mpi_open(&sn->f, MPI_COMM_WORLD, sn->path, (uint64_t)N, (uint32_t)sn->rule, (uint64_t)cars,
+                            g0, g0 + local_N, append);
+}
+
+static inline int snap_due(const snap_t *sn, int iter) {
+    return sn->every > 0 && (iter + 1) % sn->every == 0;
+}
+
+// Colectiva: el motor ya dejó su tramo en sn->seg. El marco se escribe en
+// segundo plano mientras siguen los pasos.
+static void snap_write(snap_t *sn, int iter, long long local_moves_total, double t0) {
+    long long moves = 0;
+    TRACE_BEGIN("snap");
+    MPI_Reduce(&local_moves_total, &moves, 1, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    ca_snap_mpi_write(&sn->f, (uint64_t)iter + 1, (uint64_t)moves, sn->seg);
+    TRACE_END("snap");
+    sn->frames++;
+    sn->io += MPI_Wtime() - t0;
+}
+
+// Colectiva: si el paso iter ya movió min(coches, huecos) coches, el estado
+// es una traslación pura (ca_ff.h); todos los ranks deciden lo mismo y rank 0
+// suma los movimientos de los pasos restantes.
+static int ff_step(ca_ff_t *ff, MPI_Comm comm, int rank, int iter, int iterations, long long local_moves,
+                   long long *local_moves_total) {
+    long long moves = 0;
+    TRACE_BEGIN("ff_allreduce");
+    MPI_Allreduce(&local_moves, &moves, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    TRACE_END("ff_allreduce");
+    if (!ca_ff_check(ff, iter, iterations, moves)) {
+        return 0;
+    }
+    if (rank == 0) {
+        *local_moves_total += ca_ff_moves(ff);
+    }
+    return 1;
+}
+
+static void snap_close(snap_t *sn) {
+    double t0 = MPI_Wtime();
+    ca_snap_mpi_close(&sn->f);
+    sn->io += MPI_Wtime() - t0;
+    free(sn->seg);
+    free(sn->init);
+    sn->seg = NULL;
+    sn->init = NULL;
+}
+
+// Aplica la regla a las celdas [lo, hi); si count, devuelve los coches que se mueven.
+static inline long long rule_int(const int *road, int *new_road, int lo, int hi, int count) {
+    long long moves = 0;
+    for (int i = lo; i < hi; i++) {
+        int L = road[i - 1];
+        int C = road[i];
+        int R = road[i + 1];
+
+        // C' = 1 si (L=1,C=0) o (C=1,R=1), si no 0
+        if ((L == 1 && C == 0) || (C == 1 && R == 1)) {
+            new_road[i] = 1;
+        } else {
+            new_road[i] = 0;
+        }
+
+        // Conteo de coches que se mueven (C=1, R=0)
+        if (count && C == 1 && R == 0) {
+            moves++;
+        }
+    }
+    return moves;
+}
+
+// Motor original: un int por celda.
+// Halo profundo de k celdas: cada k pasos se intercambian k celdas por lado y
+// entre intercambios se recalcula de forma redundante la zona fantasma, que se
+// encoge una celda por paso. Con k = 1 es el esquema clásico (un intercambio
+// por iteración).
+// Devuelve los movimientos globales (válidos en rank 0) o -1 si falla.
+static long long run_int(int rank, int size, long long N, long long g0, int local_N, int iterations,
+                         const ca_cfg_t *cfg, snap_t *sn, ca_result_t *res) {
+    int k = cfg->halo;
+    // Arrays locales con halos: [0,k) y [k+local_N, 2k+local_N) son fantasma
+    int E = local_N + 2 * k;
+    int *local_road = (int *)arena_alloc(E * sizeof(int));
+    int *new_local_road = (int *)arena_alloc(E * sizeof(int));
+
+    if (!local_road || !new_local_road) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return -1;
+    }
+
+    if (sn->init) {
+        ca_snap_unpack_int(&local_road[k], sn->init, local_N);
+    } else {
+        // Cada rank genera su tramo: celda real i = celda global g0 + i
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < local_N; i++) {
+            local_road[k + i] = ca_init_at(&cfg->init, g0 + i);
+        }
+    }
+
+    // Contar coches locales y reducir a total global
+    long long total_cars_local = 0;
+    for (int i = k; i < k + local_N; i++) {
+        total_cars_local += local_road[i];
+    }
+
+    long long total_cars_global = 0;
+    MPI_Allreduce(&total_cars_local, &total_cars_global, 1, MPI_LONG_LONG, MPI_SUM, cfg->comm);
+    if (sn->init) {
+        total_cars_global = sn->cars0;
+    }
+    res->cars = total_cars_global;
+    res->secs = 0.0;
+    res->wait = 0.0;
+
+    if (total_cars_global == 0) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return 0;
+    }
+
+    res->ff.every = cfg->ff;
+    ca_ff_init(&res->ff, N, total_cars_global);
+    if (snap_open(sn, rank, N, g0, local_N, total_cars_global)) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return -1;
+    }
+
+    int left_neighbor  = (rank == 0) ? size - 1 : rank - 1;
+    int right_neighbor = (rank == size - 1) ? 0 : rank + 1;
+
+    // Movimientos acumulados localmente; una sola reducción al final
+    long long local_moves_total = (rank == 0) ? sn->moves0 : 0;
+    progress_t prog = { .every = cfg->progress, .iterations = iterations, .comm = cfg->comm };
+
+    double start_time = MPI_Wtime();
+
+    // Modo solapado: peticiones persistentes creadas una vez. Como los buffers
+    // se alternan cada paso, hay un juego de 4 peticiones por buffer.
+    int *bufs[2] = { local_road, new_local_road };
+    MPI_Request reqs[2][4];
+    if (cfg->overlap) {
+        for (int b = 0; b < 2; b++) {
+            MPI_Send_init(&bufs[b][k], k, MPI_INT, left_neighbor, 0, cfg->comm, &reqs[b][0]);
+            MPI_Recv_init(&bufs[b][k + local_N], k, MPI_INT, right_neighbor, 0, cfg->comm, &reqs[b][1]);
+            MPI_Send_init(&bufs[b][local_N], k, MPI_INT, right_neighbor, 1, cfg->comm, &reqs[b][2]);
+            MPI_Recv_init(&bufs[b][0], k, MPI_INT, left_neighbor, 1, cfg->comm, &reqs[b][3]);
+        }
+    }
+    int cur = 0;  // buffer que contiene el estado actual
+
+    for (int iter = sn->start; iter < iterations; iter++) {
+        TRACE_BEGIN("step");
+        int s = (iter - sn->start) % k;  // pasos desde el último intercambio
+        long long local_moves;
+
+        if (s == 0 && cfg->overlap) {
+            // Se lanzan los halos y, mientras viajan, se actualiza el interior
+            // real, que no depende de ninguna celda fantasma.
+            MPI_Startall(4, reqs[cur]);
+            local_moves = rule_int(local_road, new_local_road, k + 1, k + local_N - 1, 1);
+
+            double tw = MPI_Wtime();
+            TRACE_BEGIN("halo_wait");
+            MPI_Waitall(4, reqs[cur], MPI_STATUSES_IGNORE);
+            TRACE_END("halo_wait");
+            res->wait += MPI_Wtime() - tw;
+
+            // Zonas fantasma y las dos celdas reales de los bordes
+            rule_int(local_road, new_local_road, 1, k, 0);
+            local_moves += rule_int(local_road, new_local_road, k, k + 1, 1);
+            if (local_N > 1) {
+                local_moves += rule_int(local_road, new_local_road, k + local_N - 1, k + local_N, 1);
+            }
+            rule_int(local_road, new_local_road, k + local_N, E - 1, 0);
+        } else {
+            if (s == 0) {
+                double tw = MPI_Wtime();
+                TRACE_BEGIN("halo");
+
+                // Intercambio de halos (k celdas):
+                // - Las k primeras celdas reales se envían al vecino izquierdo
+                //   y recibimos en [k+local_N, E) las primeras del vecino derecho
+                MPI_Sendrecv(&local_road[k], k, MPI_INT, left_neighbor, 0,
+                             &local_road[k + local_N], k, MPI_INT, right_neighbor, 0,
+                             cfg->comm, MPI_STATUS_IGNORE);
+
+                // - Las k últimas celdas reales se envían al vecino derecho
+                //   y recibimos en [0, k) las últimas del vecino izquierdo
+                MPI_Sendrecv(&local_road[local_N], k, MPI_INT, right_neighbor, 1,
+                             &local_road[0], k, MPI_INT, left_neighbor, 1,
+                             cfg->comm, MPI_STATUS_IGNORE);
+
+                TRACE_END("halo");
+                res->wait += MPI_Wtime() - tw;
+            }
+
+            // Aplicamos la misma regla que en la versión serial (Rule-184-like).
+            // Tras s pasos solo [s, E-s) es válido: calculamos [s+1, E-1-s) y
+            // contamos movimientos únicamente en las celdas reales.
+            rule_int(local_road, new_local_road, s + 1, k, 0);
+            local_moves = rule_int(local_road, new_local_road, k, k + local_N, 1);
+            rule_int(local_road, new_local_road, k + local_N, E - 1 - s, 0);
+        }
+
+        // Intercambio de buffers
+        int *tmp = local_road;
+        local_road = new_local_road;
+        new_local_road = tmp;
+        cur ^= 1;
+
+        TRACE_END("step");
+        local_moves_total += local_moves;
+        progress_step(&prog, rank, iter + 1, local_moves_total);
+
+        if (snap_due(sn, iter)) {
+            double t0 = MPI_Wtime();
+            ca_snap_pack_int(sn->seg, &local_road[k], local_N);
+            snap_write(sn, iter, local_moves_total, t0);
+        }
+
+        if (ca_ff_due(&res->ff, iter) &&
+            ff_step(&res->ff, cfg->comm, rank, iter, iterations, local_moves, &local_moves_total)) {
+            break;
+        }
+    }
+
+    progress_end(&prog, rank);
+    long long global_moves = 0;
+    TRACE_BEGIN("reduce");
+    MPI_Reduce(&local_moves_total, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, cfg->comm);
+    TRACE_END("reduce");
+
+    double end_time = MPI_Wtime();
+    res->secs = end_time - start_time;
+
+    if (cfg->overlap) {
+        for (int b = 0; b < 2; b++) {
+            for (int r = 0; r < 4; r++) {
+                MPI_Request_free(&reqs[b][r]);
+            }
+        }
+    }
+
+    arena_free(local_road);
+    arena_free(new_local_road);
+    return global_moves;
+}
+
+// Motor empaquetado: 64 celdas por uint64_t, cualquier regla elemental
+// (radio 1, así que el esquema de halo profundo vale igual para todas).
+// Arreglo extendido de E = local_N + 2k bits contiguos: [0,k) fantasma
+// izquierdo, [k, k+local_N) reales, [k+local_N, E) fantasma derecho. Los bordes
+// del arreglo extendido usan 0 como vecino; el error avanza una celda por paso
+// y nunca alcanza las celdas reales antes del siguiente intercambio.
+static long long run_bits(int rank, int size, long long N, long long g0, int local_N, int iterations,
+                          const ca_cfg_t *cfg, snap_t *sn, ca_result_t *res) {
+    int k = cfg->halo;
+    ca_eca_step_fn step = ca_eca_steps[cpu_isa_level][cfg->rule];
+    size_t W = ca_bits_words(local_N);
+    long long E = (long long)local_N + 2LL * k;
+    size_t WE = ca_bits_words(E);
+    unsigned tail = ca_bits_tail(E);
+    size_t HW = ca_bits_words(k);  // palabras por mensaje de halo
+
+    uint64_t *seg = (uint64_t *)calloc(W, sizeof(uint64_t));
+    uint64_t *local_road = (uint64_t *)arena_calloc(WE, sizeof(uint64_t));
+    uint64_t *new_local_road = (uint64_t *)arena_calloc(WE, sizeof(uint64_t));
+    uint64_t *halo_buf = (uint64_t *)arena_calloc(4 * HW, sizeof(uint64_t));
+
+    if (!seg || !local_road || !new_local_road || !halo_buf) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        free(seg);
+        arena_free(local_road);
+        arena_free(new_local_road);
+        arena_free(halo_buf);
+        return -1;
+    }
+    uint64_t *send_l = halo_buf, *send_r = halo_buf + HW;
+    uint64_t *recv_l = halo_buf + 2 * HW, *recv_r = halo_buf + 3 * HW;
+
+    if (sn->init) {
+        memcpy(seg, sn->init, W * sizeof(uint64_t));
+    } else {
+        // Cada rank genera su tramo empaquetado, sin carretera global
+        ca_init_bits(seg, g0, local_N, &cfg->init);
+    }
+
+    ca_bits_copy(local_road, k, seg, 0, local_N);
+    free(seg);
+
+    long long total_cars_local = ca_bits_count(local_road, WE);
+    long long total_cars_global = 0;
+    MPI_Allreduce(&total_cars_local, &total_cars_global, 1, MPI_LONG_LONG, MPI_SUM, cfg->comm);
+    if (sn->init) {
+        total_cars_global = sn->cars0;
+    }
+    res->cars = total_cars_global;
+    res->secs = 0.0;
+    res->wait = 0.0;
+
+    if (total_cars_global == 0) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        arena_free(halo_buf);
+        return 0;
+    }
+
+    res->ff.every = cfg->ff;
+    ca_ff_init(&res->ff, N, total_cars_global);
+    if (snap_open(sn, rank, N, g0, local_N, total_cars_global)) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        arena_free(halo_buf);
+        return -1;
+    }
+
+    int left_neighbor  = (rank == 0) ? size - 1 : rank - 1;
+    int right_neighbor = (rank == size - 1) ? 0 : rank + 1;
+
+    // Movimientos acumulados localmente; una sola reducción al final
+    long long local_moves_total = (rank == 0) ? sn->moves0 : 0;
+    progress_t prog = { .every = cfg->progress, .iterations = iterations, .comm = cfg->comm };
+
+    double start_time = MPI_Wtime();
+
+    // Palabras [j_lo, j_hi) cuyos vecinos son todos celdas reales: se pueden
+    // actualizar sin esperar a los halos.
+    long long kN = k + (long long)local_N;
+    size_t j_lo = (size_t)((k + 1 + 63) / 64);
+    size_t j_hi = (kN - 65 >= 0) ? (size_t)((kN - 65) / 64 + 1) : 0;
+    if (j_hi < j_lo) j_hi = j_lo;
+
+    // Los buffers de halo son fijos: un solo juego de peticiones persistentes
+    MPI_Request reqs[4];
+    if (cfg->overlap) {
+        MPI_Send_init(send_l, (int)HW, MPI_UINT64_T, left_neighbor, 0, cfg->comm, &reqs[0]);
+        MPI_Recv_init(recv_r, (int)HW, MPI_UINT64_T, right_neighbor, 0, cfg->comm, &reqs[1]);
+        MPI_Send_init(send_r, (int)HW, MPI_UINT64_T, right_neighbor, 1, cfg->comm, &reqs[2]);
+        MPI_Recv_init(recv_l, (int)HW, MPI_UINT64_T, left_neighbor, 1, cfg->comm, &reqs[3]);
+    }
+
+    for (int iter = sn->start; iter < iterations; iter++) {
+        TRACE_BEGIN("step");
+        long long local_moves = 0;
+        int s = (iter - sn->start) % k;  // pasos desde el último intercambio
+
+        if (s == 0 && cfg->overlap) {
+            ca_bits_copy(send_l, 0, local_road, k, k);
+            ca_bits_copy(send_r, 0, local_road, local_N, k);
+            MPI_Startall(4, reqs);
+
+            local_moves = step(local_road, new_local_road, WE, tail, 0, 0, j_lo, j_hi);
+
+            double tw = MPI_Wtime();
+            TRACE_BEGIN("halo_wait");
+            MPI_Waitall(4, reqs, MPI_STATUSES_IGNORE);
+            TRACE_END("halo_wait");
+            res->wait += MPI_Wtime() - tw;
+
+            ca_bits_copy(local_road, 0, recv_l, 0, k);
+            ca_bits_copy(local_road, kN, recv_r, 0, k);
+
+            local_moves += step(local_road, new_local_road, WE, tail, 0, 0, 0, j_lo)
+                         + step(local_road, new_local_road, WE, tail, 0, 0, j_hi, WE);
+        } else {
+            if (s == 0) {
+                double tw = MPI_Wtime();
+                TRACE_BEGIN("halo");
+
+                // Halos de k bits: primeras k celdas reales al vecino izquierdo,
+                // últimas k al derecho
+                ca_bits_copy(send_l, 0, local_road, k, k);
+                ca_bits_copy(send_r, 0, local_road, local_N, k);
+
+                MPI_Sendrecv(send_l, (int)HW, MPI_UINT64_T, left_neighbor, 0,
+                             recv_r, (int)HW, MPI_UINT64_T, right_neighbor, 0,
+                             cfg->comm, MPI_STATUS_IGNORE);
+                MPI_Sendrecv(send_r, (int)HW, MPI_UINT64_T, right_neighbor, 1,
+                             recv_l, (int)HW, MPI_UINT64_T, left_neighbor, 1,
+                             cfg->comm, MPI_STATUS_IGNORE);
+
+                ca_bits_copy(local_road, 0, recv_l, 0, k);
+                ca_bits_copy(local_road, kN, recv_r, 0, k);
+
+                TRACE_END("halo");
+                res->wait += MPI_Wtime() - tw;
+            }
+            local_moves = step(local_road, new_local_road, WE, tail, 0, 0, 0, WE);
+        }
+
+        // Se descuentan los movimientos de las zonas fantasma
+        local_moves -= ca_bits_vacated_range(local_road, new_local_road, 0, k)
+                     + ca_bits_vacated_range(local_road, new_local_road, kN, E);
+
+        uint64_t *tmp = local_road;
+        local_road = new_local_road;
+        new_local_road = tmp;
+
+        TRACE_END("step");
+        local_moves_total += local_moves;
+        progress_step(&prog, rank, iter + 1, local_moves_total);
+
+        if (snap_due(sn, iter)) {
+            double t0 = MPI_Wtime();
+            ca_bits_copy(sn->seg, 0, local_road, k, local_N);
+            snap_write(sn, iter, local_moves_total, t0);
+        }
+
+        if (ca_ff_due(&res->ff, iter) &&
+            ff_step(&res->ff, cfg->comm, rank, iter, iterations, local_moves, &local_moves_total)) {
+            break;
+        }
+    }
+
+    progress_end(&prog, rank);
+    long long global_moves = 0;
+    TRACE_BEGIN("reduce");
+    MPI_Reduce(&local_moves_total, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, cfg->comm);
+    TRACE_END("reduce");
+
+    double end_time = MPI_Wtime();
+    res->secs = end_time - start_time;
+
+    if (cfg->overlap) {
+        for (int r = 0; r < 4; r++) {
+            MPI_Request_free(&reqs[r]);
+        }
+    }
+
+    arena_free(local_road);
+    arena_free(new_local_road);
+    arena_free(halo_buf);
+    return global_moves;
+}
+
+// Motor híbrido MPI+OpenMP: un byte por celda con el kernel sin ramas de
+// ca_u8.h. Mismo esquema de halo profundo y solapamiento que run_int; dentro
+// de cada rank los hilos OpenMP se reparten las celdas reales en tramos
+// contiguos (schedule static) y las zonas fantasma, de k celdas como mucho, las
+// calcula el hilo maestro. Todas las llamadas MPI salen del hilo maestro fuera
+// de las regiones paralelas (MPI_THREAD_FUNNELED).
+static long long run_u8(int rank, int size, long long N, long long g0, int local_N, int iterations,
+                        const ca_cfg_t *cfg, snap_t *sn, ca_result_t *res) {
+    int k = cfg->halo;
+    int E = local_N + 2 * k;
+    uint8_t *local_road = (uint8_t *)arena_alloc(E);
+    uint8_t *new_local_road = (uint8_t *)arena_alloc(E);
+
+    if (!local_road || !new_local_road) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return -1;
+    }
+
+    // Primer contacto con el mismo reparto static que el kernel
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < E; i++) {
+        local_road[i] = 0;
+        new_local_road[i] = 0;
+    }
+
+    if (sn->init) {
+        ca_snap_unpack_u8(&local_road[k], sn->init, local_N);
+    } else {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < local_N; i++) {
+            local_road[k + i] = (uint8_t)ca_init_at(&cfg->init, g0 + i);
+        }
+    }
+
+    long long total_cars_local = 0;
+    for (int i = k; i < k + local_N; i++) {
+        total_cars_local += local_road[i];
+    }
+
+    long long total_cars_global = 0;
+    MPI_Allreduce(&total_cars_local, &total_cars_global, 1, MPI_LONG_LONG, MPI_SUM, cfg->comm);
+    if (sn->init) {
+        total_cars_global = sn->cars0;
+    }
+    res->cars = total_cars_global;
+    res->secs = 0.0;
+    res->wait = 0.0;
+
+    if (total_cars_global == 0) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return 0;
+    }
+
+    res->ff.every = cfg->ff;
+    ca_ff_init(&res->ff, N, total_cars_global);
+    if (snap_open(sn, rank, N, g0, local_N, total_cars_global)) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return -1;
+    }
+
+    int left_neighbor  = (rank == 0) ? size - 1 : rank - 1;
+    int right_neighbor = (rank == size - 1) ? 0 : rank + 1;
+
+    long long local_moves_total = (rank == 0) ? sn->moves0 : 0;
+    progress_t prog = { .every = cfg->progress, .iterations = iterations, .comm = cfg->comm };
+
+    double start_time = MPI_Wtime();
+
+    uint8_t *bufs[2] = { local_road, new_local_road };
+    MPI_Request reqs[2][4];
+    if (cfg->overlap) {
+        for (int b = 0; b < 2; b++) {
+            MPI_Send_init(&bufs[b][k], k, MPI_UINT8_T, left_neighbor, 0, cfg->comm, &reqs[b][0]);
+            MPI_Recv_init(&bufs[b][k + local_N], k, MPI_UINT8_T, right_neighbor, 0, cfg->comm, &reqs[b][1]);
+            MPI_Send_init(&bufs[b][local_N], k, MPI_UINT8_T, right_neighbor, 1, cfg->comm, &reqs[b][2]);
+            MPI_Recv_init(&bufs[b][0], k, MPI_UINT8_T, left_neighbor, 1, cfg->comm, &reqs[b][3]);
+        }
+    }
+    int cur = 0;
+
+    for (int iter = sn->start; iter < iterations; iter++) {
+        TRACE_BEGIN("step");
+        int s = (iter - sn->start) % k;
+        long long local_moves;
+
+        if (s == 0 && cfg->overlap) {
+            MPI_Startall(4, reqs[cur]);
+            local_moves = ca_u8_rule_omp(local_road, new_local_road, k + 1, k + local_N - 1);
+
+            double tw = MPI_Wtime();
+            TRACE_BEGIN("halo_wait");
+            MPI_Waitall(4, reqs[cur], MPI_STATUSES_IGNORE);
+            TRACE_END("halo_wait");
+            res->wait += MPI_Wtime() - tw;
+
+            ca_u8_rule(local_road, new_local_road, 1, k);
+            local_moves += ca_u8_rule(local_road, new_local_road, k, k + 1);
+            if (local_N > 1) {
+                local_moves += ca_u8_rule(local_road, new_local_road, k + local_N - 1, k + local_N);
+            }
+            ca_u8_rule(local_road, new_local_road, k + local_N, E - 1);
+        } else {
+            if (s == 0) {
+                double tw = MPI_Wtime();
+                TRACE_BEGIN("halo");
+                MPI_Sendrecv(&local_road[k], k, MPI_UINT8_T, left_neighbor, 0,
+                             &local_road[k + local_N], k, MPI_UINT8_T, right_neighbor, 0,
+                             cfg->comm, MPI_STATUS_IGNORE);
+                MPI_Sendrecv(&local_road[local_N], k, MPI_UINT8_T, right_neighbor, 1,
+                             &local_road[0], k, MPI_UINT8_T, left_neighbor, 1,
+                             cfg->comm, MPI_STATUS_IGNORE);
+                TRACE_END("halo");
+                res->wait += MPI_Wtime() - tw;
+            }
+
+            // Los movimientos de las zonas fantasma no se cuentan
+            ca_u8_rule(local_road, new_local_road, s + 1, k);
+            local_moves = ca_u8_rule_omp(local_road, new_local_road, k, k + local_N);
+            ca_u8_rule(local_road, new_local_road, k + local_N, E - 1 - s);
+        }
+
+        uint8_t *tmp = local_road;
+        local_road = new_local_road;
+        new_local_road = tmp;
+        cur ^= 1;
+
+        TRACE_END("step");
+        local_moves_total += local_moves;
+        progress_step(&prog, rank, iter + 1, local_moves_total);
+
+        if (snap_due(sn, iter)) {
+            double t0 = MPI_Wtime();
+            ca_snap_pack_u8(sn->seg, &local_road[k], local_N);
+            snap_write(sn, iter, local_moves_total, t0);
+        }
+
+        if (ca_ff_due(&res->ff, iter) &&
+            ff_step(&res->ff, cfg->comm, rank, iter, iterations, local_moves, &local_moves_total)) {
+            break;
+        }
+    }
+
+    progress_end(&prog, rank);
+    long long global_moves = 0;
+    TRACE_BEGIN("reduce");
+    MPI_Reduce(&local_moves_total, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, cfg->comm);
+    TRACE_END("reduce");
+
+    double end_time = MPI_Wtime();
+    res->secs = end_time - start_time;
+
+    if (cfg->overlap) {
+        for (int b = 0; b < 2; b++) {
+            for (int r = 0; r < 4; r++) {
+                MPI_Request_free(&reqs[b][r]);
+            }
+        }
+    }
+
+    arena_free(local_road);
+    arena_free(new_local_road);
+    return global_moves;
+}
+
+// Motor disperso (ca_sparse.h): cada rank genera su tramo de celdas y guarda
+// solo los huecos entre sus partículas (coches, o huecos si la densidad pasa
+// de 1/2). El hueco de su última partícula llega hasta la primera del
+// siguiente rank con partículas: los ranks sin ninguna quedan fuera de un
+// comunicador propio, ordenado en el sentido del anillo (al revés si se
+// reflejó). La única dependencia por paso es si la primera partícula del
+// vecino derecho se mueve: un entero que viaja mientras se actualizan las
+// demás.
+// Con engine=auto, si conviene el motor denso se usa run_bits, que genera la
+// misma carretera.
+static long long run_sparse(int rank, int size, long long N, long long g0, int local_N, int iterations, int force,
+                            const ca_cfg_t *cfg, snap_t *sn, ca_result_t *res) {
+    uint64_t *seg = (uint64_t *)calloc(ca_bits_words(local_N), sizeof(uint64_t));
+    if (!seg) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        return -1;
+    }
+    long long local_cars = ca_init_bits(seg, g0, local_N, &cfg->init);
+    long long cars = 0;
+    MPI_Allreduce(&local_cars, &cars, 1, MPI_LONG_LONG, MPI_SUM, cfg->comm);
+
+    int invert = ca_sparse_invert(N, cars);
+    long long M = invert ? N - cars : cars;
+
+    if (!force && !ca_sparse_prefer(N, cars)) {
+        if (rank == 0) {
+            fprintf(stderr, "[auto] densidad=%.4f: motor bits\n", (double)cars / N);
+        }
+        free(seg);
+        return run_bits(rank, size, N, g0, local_N, iterations, cfg, sn, res);
+    }
+
+    res->cars = cars;
+    res->secs = 0.0;
+    res->wait = 0.0;
+
+    // Huecos entre las partículas locales, recorridas en el sentido del anillo
+    long long L = invert ? local_N - local_cars : local_cars;
+    int32_t *g = (int32_t *)malloc((L > 0 ? L : 1) * sizeof(int32_t));
+    if (!g) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    long long n = 0, first = -1, last = -1;
+    int too_wide = 0;
+    // Palabra a palabra, saltando de partícula en partícula (al revés si invert)
+    long long W = (long long)ca_bits_words(local_N);
+    for (long long u = 0; u < W; u++) {
+        long long j = invert ? W - 1 - u : u;
+        uint64_t x = invert ? ~seg[j] : seg[j];
+        if (j == W - 1 && local_N % 64) {
+            x &= (1ULL << (local_N % 64)) - 1;
+        }
+        while (x) {
+            int b = invert ? 63 - __builtin_clzll(x) : __builtin_ctzll(x);
+            x &= ~(1ULL << b);
+            long long i = j * 64 + b;
+            long long p = invert ? N - 1 - (g0 + i) : g0 + i;
+            if (n > 0) {
+                too_wide |= p - last - 1 > INT32_MAX;
+                g[n - 1] = (int32_t)(p - last - 1);
+            } else {
+                first = p;
+            }
+            last = p;
+            n++;
+        }
+    }
+    free(seg);
+
+    MPI_Comm ring = MPI_COMM_NULL;
+    MPI_Comm_split(cfg->comm, L > 0 ? 0 : MPI_UNDEFINED, invert ? size - 1 - rank : rank, &ring);
+
+    int left_neighbor = MPI_PROC_NULL, right_neighbor = MPI_PROC_NULL;
+    if (ring != MPI_COMM_NULL) {
+        int rr, rs;
+        MPI_Comm_rank(ring, &rr);
+        MPI_Comm_size(ring, &rs);
+        left_neighbor  = (rr == 0) ? rs - 1 : rr - 1;
+        right_neighbor = (rr == rs - 1) ? 0 : rr + 1;
+
+        // Último hueco: hasta la primera partícula del vecino derecho (con vuelta)
+        long long next_first = 0;
+        MPI_Sendrecv(&first, 1, MPI_LONG_LONG, left_neighbor, 0,
+                     &next_first, 1, MPI_LONG_LONG, right_neighbor, 0, ring, MPI_STATUS_IGNORE);
+        long long gap = ((next_first - last - 1) % N + N) % N;
+        too_wide |= gap > INT32_MAX;
+        g[L - 1] = (int32_t)gap;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &too_wide, 1, MPI_INT, MPI_LOR, cfg->comm);
+    if (too_wide) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: engine=sparse necesita huecos menores que 2^31 celdas.\n");
+        }
+        if (ring != MPI_COMM_NULL) MPI_Comm_free(&ring);
+        free(g);
+        return -1;
+    }
+
+    if (rank == 0) {
+        fprintf(stderr, "[sparse] particulas=%s M=%lld (%.4f de N)\n", invert ? "huecos" : "coches", M,
+                (double)M / N);
+    }
+    if (cars == 0) {
+        free(g);
+        return 0;
+    }
+
+    res->ff.every = cfg->ff;
+    ca_ff_init(&res->ff, N, cars);
+    long long local_moves_total = 0;
+    progress_t prog = { .every = cfg->progress, .iterations = iterations, .comm = cfg->comm };
+
+    double start_time = MPI_Wtime();
+
+    // Los ranks sin partículas siguen el bucle para las colectivas de ff y progreso
+    for (int iter = 0; iter < iterations && M > 0; iter++) {
+        TRACE_BEGIN("step");
+        long long local_moves = 0;
+
+        if (ring != MPI_COMM_NULL) {
+            // El movimiento de la primera partícula viaja al vecino izquierdo
+            // mientras se actualizan las L-1 primeras (la última necesita el del derecho)
+            int32_t m_first = g[0] > 0, m_right = 0;
+            MPI_Request reqs[2];
+            MPI_Irecv(&m_right, 1, MPI_INT32_T, right_neighbor, 0, ring, &reqs[0]);
+            MPI_Isend(&m_first, 1, MPI_INT32_T, left_neighbor, 0, ring, &reqs[1]);
+
+            local_moves = ca_sparse_step(g, L - 1, g[L - 1] > 0);
+
+            double tw = MPI_Wtime();
+            TRACE_BEGIN("halo_wait");
+            MPI_Waitall(2, reqs, MPI_STATUSES_IGNORE);
+            TRACE_END("halo_wait");
+            res->wait += MPI_Wtime() - tw;
+
+            local_moves += ca_sparse_step(g + L - 1, 1, m_right);
+        }
+
+        TRACE_END("step");
+        local_moves_total += local_moves;
+        progress_step(&prog, rank, iter + 1, local_moves_total);
+
+        if (ca_ff_due(&res->ff, iter) &&
+            ff_step(&res->ff, cfg->comm, rank, iter, iterations, local_moves, &local_moves_total)) {
+            break;
+        }
+    }
+
+    progress_end(&prog, rank);
+    long long global_moves = 0;
+    TRACE_BEGIN("reduce");
+    MPI_Reduce(&local_moves_total, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, cfg->comm);
+    TRACE_END("reduce");
+
+    double end_time = MPI_Wtime();
+    res->secs = end_time - start_time;
+
+    if (ring != MPI_COMM_NULL) {
+        MPI_Comm_free(&ring);
+    }
+    free(g);
+    return global_moves;
+}
+
+// Motor Nagel–Schreckenberg: un byte por celda con la velocidad del coche.
+// La información viaja hasta vmax celdas por paso, así que un halo de k
+// celdas (k >= vmax) permite k/vmax pasos entre intercambios: en el paso r
+// desde el último, solo [r*vmax, E - r*vmax) es válido. El frenado aleatorio
+// se indexa por celda global, de modo que las zonas fantasma se recalculan
+// igual que en el rank dueño.
+static long long run_nasch(int rank, int size, long long g0, int local_N, int iterations,
+                           const ca_cfg_t *cfg, ca_result_t *res) {
+    int k = cfg->halo;
+    int vmax = cfg->vmax;
+    int steps = k / vmax;  // pasos por intercambio
+    int E = local_N + 2 * k;
+    ca_nasch_step_fn step = ca_nasch_steps[vmax];
+    uint8_t *local_road = (uint8_t *)arena_alloc(E);
+    uint8_t *new_local_road = (uint8_t *)arena_alloc(E);
+
+    if (!local_road || !new_local_road) {
+        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return -1;
+    }
+
+    // Cada rank genera su tramo; los coches arrancan parados
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < local_N; i++) {
+        local_road[k + i] = ca_init_at(&cfg->init, g0 + i) ? 0 : CA_NASCH_EMPTY;
+    }
+
+    long long total_cars_local = 0;
+    for (int i = k; i < k + local_N; i++) {
+        total_cars_local += (local_road[i] != CA_NASCH_EMPTY);
+    }
+
+    long long total_cars_global = 0;
+    MPI_Allreduce(&total_cars_local, &total_cars_global, 1, MPI_LONG_LONG, MPI_SUM, cfg->comm);
+    res->cars = total_cars_global;
+    res->secs = 0.0;
+    res->wait = 0.0;
+
+    if (total_cars_global == 0) {
+        arena_free(local_road);
+        arena_free(new_local_road);
+        return 0;
+    }
+
+    int left_neighbor  = (rank == 0) ? size - 1 : rank - 1;
+    int right_neighbor = (rank == size - 1) ? 0 : rank + 1;
+
+    // Índice global de la celda 0 del arreglo extendido
+    long long x0 = g0 - k;
+
+    long long local_moves_total = 0;
+    progress_t prog = { .every = cfg->progress, .iterations = iterations, .comm = cfg->comm };
+
+    double start_time = MPI_Wtime();
+
+    for (int iter = 0; iter < iterations; iter++) {
+        TRACE_BEGIN("step");
+        int r = iter % steps;
+
+        if (r == 0) {
+            double tw = MPI_Wtime();
+            TRACE_BEGIN("halo");
+            MPI_Sendrecv(&local_road[k], k, MPI_UINT8_T, left_neighbor, 0,
+                         &local_road[k + local_N], k, MPI_UINT8_T, right_neighbor, 0,
+                         cfg->comm, MPI_STATUS_IGNORE);
+            MPI_Sendrecv(&local_road[local_N], k, MPI_UINT8_T, right_neighbor, 1,
+                         &local_road[0], k, MPI_UINT8_T, left_neighbor, 1,
+                         cfg->comm, MPI_STATUS_IGNORE);
+            TRACE_END("halo");
+            res->wait += MPI_Wtime() - tw;
+        }
+
+        // Coches en [r*vmax, E-(r+1)*vmax): todos leen celdas válidas
+        memset(new_local_road, CA_NASCH_EMPTY, E);
+        long long local_moves = step(&cfg->nasch, local_road, new_local_road,
+                                     (long long)r * vmax, E - (long long)(r + 1) * vmax,
+                                     x0, iter, k, k + local_N);
+
+        uint8_t *tmp = local_road;
+        local_road = new_local_road;
+        new_local_road = tmp;
+
+        TRACE_END("step");
+        local_moves_total += local_moves;
+        progress_step(&prog, rank, iter + 1, local_moves_total);
+    }
+
+    progress_end(&prog, rank);
+    long long global_moves = 0;
+    TRACE_BEGIN("reduce");
+    MPI_Reduce(&local_moves_total, &global_moves, 1, MPI_LONG_LONG, MPI_SUM, 0, cfg->comm);
+    TRACE_END("reduce");
+
+    double end_time = MPI_Wtime();
+    res->secs = end_time - start_time;
+
+    arena_free(local_road);
+    arena_free(new_local_road);
+    return global_moves;
+}
+
+// Reparte N celdas entre los procesos de cfg->comm (tramos de N/size, los
+// N % size primeros con una más) y ejecuta el motor elegido.
+static long long run_engine(const char *engine, long long N, int iterations, const ca_cfg_t *cfg, snap_t *sn,
+                            ca_result_t *res) {
+    int rank, size;
+    MPI_Comm_rank(cfg->comm, &rank);
+    MPI_Comm_size(cfg->comm, &size);
+    long long g0 = ca_seg_start(N, rank, size);
+    int local_N = (int)(ca_seg_start(N, rank + 1, size) - g0);
+
+    if (strcmp(engine, "bits") == 0) return run_bits(rank, size, N, g0, local_N, iterations, cfg, sn, res);
+    if (strcmp(engine, "u8") == 0) return run_u8(rank, size, N, g0, local_N, iterations, cfg, sn, res);
+    if (strcmp(engine, "nasch") == 0) return run_nasch(rank, size, g0, local_N, iterations, cfg, res);
+    if (strcmp(engine, "sparse") == 0 || strcmp(engine, "auto") == 0) {
+        return run_sparse(rank, size, N, g0, local_N, iterations, strcmp(engine, "sparse") == 0, cfg, sn, res);
+    }
+    return run_int(rank, size, N, g0, local_N, iterations, cfg, sn, res);
+}
+
+// Modo barrido (sweep <trabajos>): granja de tareas sobre subcomunicadores.
+// MPI_COMM_WORLD se parte una sola vez: grupos del mayor ancho de trabajo W
+// (ca_sweep.h) y, con los size % W procesos que sobran, grupos de potencias de
+// dos menores. Cada clase de ancho tiene un contador en rank 0 y el líder de
+// cada grupo toma de él el siguiente trabajo con MPI_Fetch_and_op. Un grupo
+// solo toma trabajos de su ancho o menores: al pasar a una clase más estrecha
+// se parte a su vez en subgrupos de ese ancho (colectiva solo dentro del
+// grupo), así que cada trabajo corre con su ancho exacto, los grupos que
+// acaban antes siguen sin esperar al resto y no hay un maestro dedicado. Cada
+// resultado se añade al CSV en cuanto termina, con el puntero compartido de
+// MPI-IO.
+static int run_sweep(const char *path, const char *out, long long cells, const char *engine, const ca_cfg_t *base) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // rank 0 lee el archivo y lo difunde
+    ca_sweep_job_t *jobs = NULL;
+    int n = 0;
+    if (rank == 0) {
+        n = ca_sweep_read(path, &jobs);
+        for (int j = 0; j < n; j++) {
+            // Cada trabajo corre con exactamente width procesos (run_sweep), así
+            // que el límite de celdas por proceso se comprueba con ese ancho
+            jobs[j].width = ca_sweep_width(jobs[j].N, size, cells, base->halo);
+            if (jobs[j].N < base->halo || jobs[j].N / jobs[j].width + 1 > INT_MAX) {
+                fprintf(stderr, "Error: trabajo %d: N (%lld) debe estar entre halo (%d) y %d por proceso.\n",
+                        j, jobs[j].N, base->halo, INT_MAX - 1);
+                n = -1;
+                break;
+            }
+        }
+    }
+    MPI_Bcast(&n, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (n < 0) {
+        free(jobs);
+        return 1;
+    }
+    if (rank != 0) {
+        jobs = (ca_sweep_job_t *)malloc((n > 0 ? n : 1) * sizeof(ca_sweep_job_t));
+        if (!jobs) {
+            fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Bcast(jobs, n * (int)sizeof(ca_sweep_job_t), MPI_BYTE, 0, MPI_COMM_WORLD);
+    qsort(jobs, n, sizeof(ca_sweep_job_t), ca_sweep_cmp);
+
+    MPI_File fh;
+    if (MPI_File_open(MPI_COMM_WORLD, out, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: no se puede abrir '%s'.\n", out);
+        }
+        free(jobs);
+        return 1;
+    }
+    MPI_File_set_size(fh, 0);
+    if (rank == 0) {
+        const char *header = "Trabajo, Tamaño, Densidad, Iteraciones, Semilla, Procesos, "
+                             "Movimientos totales, Tiempo total, Velocidad promedio\n";
+        MPI_File_write_shared(fh, header, (int)strlen(header), MPI_CHAR, MPI_STATUS_IGNORE);
+    }
+
+    // Un contador por clase de ancho, en la memoria de rank 0
+    enum { MAX_PHASES = 32 };
+    long long *next = NULL;
+    MPI_Win win;
+    MPI_Win_allocate(rank == 0 ? MAX_PHASES * sizeof(long long) : 0, sizeof(long long), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &next, &win);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, win);
+        memset(next, 0, MAX_PHASES * sizeof(long long));
+        MPI_Win_unlock(0, win);
+    }
+    MPI_Barrier(MPI_COMM_WORLD);  // cabecera escrita y contadores a cero
+
+    // Clases de ancho: [cls_lo[c], cls_lo[c + 1]) en jobs, anchos decrecientes
+    int cls_lo[MAX_PHASES + 1], phases = 0;
+    for (int j = 0; j < n; j++) {
+        if (j == 0 || jobs[j].width != jobs[j - 1].width) {
+            cls_lo[phases++] = j;
+        }
+    }
+    cls_lo[phases] = n;
+
+    // Grupos fijos: rank / W para los size / W grupos completos; los que sobran
+    // van a bloques de potencias de dos decrecientes (p. ej. 3 -> 2 + 1)
+    int W = n > 0 ? jobs[0].width : 1, full = size / W, color = rank / W;
+    if (color >= full) {
+        int q = rank - full * W, rest = size - full * W;
+        for (int b = W / 2; b > 0 && q >= 0; b /= 2) {
+            if (rest & b) {
+                q -= b;
+                color++;
+            }
+        }
+        color--;  // el bloque donde q se hizo negativo
+    }
+    MPI_Comm group;
+    MPI_Comm_split(MPI_COMM_WORLD, color, rank, &group);
+    int grank, gsize;
+    MPI_Comm_rank(group, &grank);
+    MPI_Comm_size(group, &gsize);
+
+    double t_start = MPI_Wtime(), busy = 0.0;
+    for (int c = 0; c < phases; c++) {
+        int lo = cls_lo[c], hi = cls_lo[c + 1], w = jobs[lo].width;
+        if (w > gsize) {
+            continue;  // más ancho que el grupo: lo corren los grupos completos
+        }
+        if (w < gsize) {
+            MPI_Comm sub;
+            MPI_Comm_split(group, grank / w, grank, &sub);
+            MPI_Comm_free(&group);
+            group = sub;
+            MPI_Comm_rank(group, &grank);
+            MPI_Comm_size(group, &gsize);
+        }
+
+        for (;;) {
+            long long idx = 0;
+            if (grank == 0) {
+                const long long one = 1;
+                MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, win);
+                MPI_Fetch_and_op(&one, &idx, MPI_LONG_LONG, 0, c, MPI_SUM, win);
+                MPI_Win_unlock(0, win);
+            }
+            MPI_Bcast(&idx, 1, MPI_LONG_LONG, 0, group);
+            if (lo + idx >= hi) {
+                break;
+            }
+            const ca_sweep_job_t *job = &jobs[lo + idx];
+
+            ca_cfg_t cfg = *base;
+            cfg.comm = group;
+            cfg.init = ca_init_make((uint64_t)job->seed, job->density);
+            cfg.nasch.seed = (uint64_t)job->seed;
+            cfg.nasch.N = job->N;
+            snap_t sn = { 0 };
+            ca_result_t res = { 0 };
+
+            double t0 = MPI_Wtime();
+            long long moves = run_engine(engine, job->N, job->iterations, &cfg, &sn, &res);
+            busy += MPI_Wtime() - t0;
+            if (moves < 0) {
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+
+            if (grank == 0) {
+                char line[256];
+                double velocity = res.cars > 0 ? (double)moves / ((double)job->iterations * res.cars) : 0.0;
+                int len = snprintf(line, sizeof line, "%d, %lld, %g, %d, %lld, %d, %lld, %f, %f\n", job->id,
+                                   job->N, job->density, job->iterations, job->seed, gsize, moves, res.secs,
+                                   velocity);
+                MPI_File_write_shared(fh, line, len, MPI_CHAR, MPI_STATUS_IGNORE);
+            }
+        }
+    }
+    MPI_Comm_free(&group);
+    double wall = MPI_Wtime() - t_start;
+
+    MPI_Win_free(&win);
+    MPI_File_close(&fh);
+    free(jobs);
+
+    // Ocupación: fracción del tiempo total que cada rank pasó dentro de un trabajo
+    double busy_min = 0.0, busy_sum = 0.0;
+    MPI_Reduce(&busy, &busy_min, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&busy, &busy_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        fprintf(stderr, "[sweep] trabajos=%d fases=%d archivo=%s tiempo=%.6f s ocupacion media=%.1f%% minima=%.1f%%\n",
+                n, phases, out, wall, wall > 0.0 ? 100.0 * busy_sum / size / wall : 0.0,
+                wall > 0.0 ? 100.0 * busy_min / wall : 0.0);
+    }
+    return 0;
+}
 
 int main(int argc, char **argv) {
-    MPI_Init(&argc, &argv);
+    // El motor u8 usa hilos OpenMP; solo el hilo maestro llama a MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
+    // Línea de tiempo por rank (TRACE_JSON, trace.h): pasos, halos y colectivas
+    trace_init("cellular_autom_mpi", rank);
+    trace_thread_name("main");
 
     if (argc < 3) {
         if (rank == 0) {
-            fprintf(stderr, "Uso: %s <number_of_cells> <iterations>\n", argv[0]);
+            fprintf(stderr, "Uso: %s <number_of_cells> <iterations> [engine=int|bits|u8|nasch|sparse|auto] [threads=T] [rule=R] [vmax=V] [p=P] [seed=S] [halo=k] [progress=P] [overlap=0|1] [waits=0|1] [snap=P] [snapfile=F] [restart=F] [ff=P] [density=D]\n", argv[0]);
+            fprintf(stderr, "     %s sweep <trabajos> [opciones] [cells=C] [out=F]   (líneas \"N densidad iteraciones semilla\")\n", argv[0]);
         }
         MPI_Finalize();
         return 1;
     }
 
-    int N = atoi(argv[1]);
-    int iterations = atoi(argv[2]);
+    // Barrido: N, densidad, iteraciones y semilla vienen de cada trabajo
+    int sweep = strcmp(argv[1], "sweep") == 0;
+    long long N = sweep ? 1 : atoll(argv[1]);
+    int iterations = sweep ? 1 : atoi(argv[2]);
 
     if (N <= 0 || iterations <= 0) {
         if (rank == 0) {
@@ -29,142 +1229,272 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    // Para simplificar asumimos N divisible por size
-    if (N % size != 0) {
+    if (ca_opts_check(argc, argv, 3, "engine threads rule vmax p seed halo progress overlap waits snap snapfile restart ff density cells out")) {
+        MPI_Finalize();
+        return 1;
+    }
+    const char *engine = ca_opt_str(argc, argv, 3, "engine", "int");
+    int use_bits = (strcmp(engine, "bits") == 0);
+    int use_u8 = (strcmp(engine, "u8") == 0);
+    int use_nasch = (strcmp(engine, "nasch") == 0);
+    int use_sparse = (strcmp(engine, "sparse") == 0 || strcmp(engine, "auto") == 0);
+    if (!use_bits && !use_u8 && !use_nasch && !use_sparse && strcmp(engine, "int") != 0) {
         if (rank == 0) {
-            fprintf(stderr, "Error: N (%d) debe ser divisible por el número de procesos (%d).\n", N, size);
+            fprintf(stderr, "Error: engine desconocido '%s' (int|bits|u8|nasch|sparse|auto).\n", engine);
         }
         MPI_Finalize();
         return 1;
     }
 
-    int local_N = N / size;
-
-    // Arrays locales con halos: 0 y local_N+1 son fantasma
-    int *local_road = (int *)malloc((local_N + 2) * sizeof(int));
-    int *new_local_road = (int *)malloc((local_N + 2) * sizeof(int));
+    // Regla elemental (engine=bits); int y u8 solo implementan la 184
+    int rule = (int)ca_opt_ll(argc, argv, 3, "rule", 184);
+    if (rule < 0 || rule > 255 || (rule != 184 && !use_bits)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: rule=%d no válida (0..255, distinta de 184 solo con engine=bits).\n", rule);
+        }
+        MPI_Finalize();
+        return 1;
+    }
 
-    if (!local_road || !new_local_road) {
-        fprintf(stderr, "Rank %d: error de memoria.\n", rank);
-        free(local_road);
-        free(new_local_road);
+    // Nagel–Schreckenberg: velocidad máxima, probabilidad de frenado y semilla
+    int vmax = (int)ca_opt_ll(argc, argv, 3, "vmax", 5);
+    if (vmax < 1 || vmax > CA_NASCH_VMAX) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: vmax (%d) debe estar entre 1 y %d.\n", vmax, CA_NASCH_VMAX);
+        }
         MPI_Finalize();
         return 1;
     }
 
-    int *global_road = NULL;
+    // Hilos OpenMP por rank del motor u8 (por defecto, OMP_NUM_THREADS)
+    int threads = (int)ca_opt_ll(argc, argv, 3, "threads", 0);
+#ifdef _OPENMP
+    if (threads > 0) {
+        omp_set_num_threads(threads);
+    }
+#else
+    (void)threads;
+#endif
+    if (use_u8 && provided < MPI_THREAD_FUNNELED && rank == 0) {
+        fprintf(stderr, "Aviso: la biblioteca MPI no garantiza MPI_THREAD_FUNNELED.\n");
+    }
 
-    if (rank == 0) {
-        // Carretera global sin halos, índices 0..N-1
-        global_road = (int *)malloc(N * sizeof(int));
-        if (!global_road) {
-            fprintf(stderr, "Rank 0: error de memoria para global_road.\n");
-            free(local_road);
-            free(new_local_road);
-            MPI_Finalize();
-            return 1;
+    // Tramos contiguos de N/size celdas; los N % size primeros ranks llevan una más
+    if (!sweep && (N < size || N / size + 1 > INT_MAX)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: N (%lld) debe estar entre el número de procesos (%d) y %d por proceso.\n",
+                    N, size, INT_MAX - 1);
         }
+        MPI_Finalize();
+        return 1;
+    }
 
-        srand((unsigned int)time(NULL));
-        for (int i = 0; i < N; i++) {
-            global_road[i] = rand() % 2;
+    // Ancho de halo: k celdas por lado, intercambiadas cada k pasos
+    // (en nasch, al menos vmax: un paso por cada vmax celdas de halo)
+    int halo_min = use_nasch ? vmax : 1;
+    int halo = (int)ca_opt_ll(argc, argv, 3, "halo", halo_min);
+    if (halo < halo_min || (!sweep && halo > N / size)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: halo (%d) debe estar entre %d y N/procesos (%lld).\n", halo, halo_min, N / size);
         }
+        MPI_Finalize();
+        return 1;
     }
 
-    // Distribuir el tramo de carretera a cada proceso (parte "real": 1..local_N)
-    MPI_Scatter(global_road, local_N, MPI_INT,
-                &local_road[1], local_N, MPI_INT,
-                0, MPI_COMM_WORLD);
-
-    if (rank == 0) {
-        free(global_road);
+    // Carretera inicial: celda g ocupada según un hash de (seed, g), igual para
+    // cualquier número de procesos
+    uint64_t seed = (uint64_t)ca_opt_ll(argc, argv, 3, "seed", 1);
+    double density = ca_opt_dbl(argc, argv, 3, "density", 0.5);
+    if (density < 0.0 || density > 1.0) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: density (%g) debe estar entre 0 y 1.\n", density);
+        }
+        MPI_Finalize();
+        return 1;
     }
 
-    // Contar coches locales y reducir a total global
-    int total_cars_local = 0;
-    for (int i = 1; i <= local_N; i++) {
-        total_cars_local += local_road[i];
+    ca_cfg_t cfg = {
+        .comm = MPI_COMM_WORLD,
+        .halo = halo,
+        // Informe de progreso no bloqueante cada P iteraciones (0 = desactivado)
+        .progress = (int)ca_opt_ll(argc, argv, 3, "progress", 0),
+        // Halos con peticiones persistentes solapados con el cómputo interior
+        .overlap = (int)ca_opt_ll(argc, argv, 3, "overlap", 0) != 0,
+        .rule = rule,
+        .vmax = vmax,
+        // Avance rápido al régimen estacionario de la regla 184 (0 = desactivado)
+        .ff = (int)ca_opt_ll(argc, argv, 3, "ff", 0),
+        .init = ca_init_make(seed, density),
+        .nasch = {
+            .seed = seed,
+            .pthr = ca_nasch_pthr(ca_opt_dbl(argc, argv, 3, "p", 0.0)),
+            .N = N,
+        },
+    };
+    if (use_nasch && cfg.overlap) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: engine=nasch no admite overlap=1.\n");
+        }
+        MPI_Finalize();
+        return 1;
     }
-
-    int total_cars_global = 0;
-    MPI_Allreduce(&total_cars_local, &total_cars_global, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
-
-    if (total_cars_global == 0) {
+    if (cfg.ff > 0 && (rule != 184 || use_nasch)) {
         if (rank == 0) {
-            printf("0, 0.0, 0.0\n");
+            fprintf(stderr, "Error: ff solo aplica a la regla 184 (no a otras reglas ni a engine=nasch).\n");
         }
-        free(local_road);
-        free(new_local_road);
         MPI_Finalize();
-        return 0;
+        return 1;
     }
+    int waits = (int)ca_opt_ll(argc, argv, 3, "waits", 0) != 0;
 
-    int left_neighbor  = (rank == 0) ? size - 1 : rank - 1;
-    int right_neighbor = (rank == size - 1) ? 0 : rank + 1;
-
-    long long global_moves = 0;
-
-    double start_time = MPI_Wtime();
-
-    for (int iter = 0; iter < iterations; iter++) {
-        int local_moves = 0;
-
-        // Intercambio de halos:
-        // - El primer elemento real (1) se envía al vecino izquierdo
-        //   y recibimos en local_road[local_N+1] el primero del vecino derecho
-        MPI_Sendrecv(&local_road[1], 1, MPI_INT, left_neighbor, 0,
-                     &local_road[local_N + 1], 1, MPI_INT, right_neighbor, 0,
-                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        // - El último elemento real (local_N) se envía al vecino derecho
-        //   y recibimos en local_road[0] el último del vecino izquierdo
-        MPI_Sendrecv(&local_road[local_N], 1, MPI_INT, right_neighbor, 1,
-                     &local_road[0], 1, MPI_INT, left_neighbor, 1,
-                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-        // Aplicamos la misma regla que en la versión serial (Rule-184-like)
-        for (int i = 1; i <= local_N; i++) {
-            int L = local_road[i - 1];
-            int C = local_road[i];
-            int R = local_road[i + 1];
-
-            // C' = 1 si (L=1,C=0) o (C=1,R=1), si no 0
-            if ((L == 1 && C == 0) || (C == 1 && R == 1)) {
-                new_local_road[i] = 1;
-            } else {
-                new_local_road[i] = 0;
+    snap_t sn = {
+        .every = ca_opt_ll(argc, argv, 3, "snap", 0),
+        .path = ca_opt_str(argc, argv, 3, "snapfile", "road.snap"),
+        .restart = ca_opt(argc, argv, 3, "restart"),
+        .rule = rule,
+    };
+    if ((sn.every > 0 || sn.restart) && (use_nasch || use_sparse)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: los snapshots solo se admiten con engine=int|bits|u8.\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    if (sweep) {
+        if (sn.every > 0 || sn.restart || waits) {
+            if (rank == 0) {
+                fprintf(stderr, "Error: el barrido no admite snap, restart ni waits.\n");
             }
+            MPI_Finalize();
+            return 1;
+        }
+        // Celdas mínimas por proceso antes de dar más procesos a un trabajo
+        long long cells = ca_opt_ll(argc, argv, 3, "cells", 100000);
+        if (cells < 1) {
+            if (rank == 0) {
+                fprintf(stderr, "Error: cells (%lld) debe ser positivo.\n", cells);
+            }
+            MPI_Finalize();
+            return 1;
+        }
+        int rc = run_sweep(argv[2], ca_opt_str(argc, argv, 3, "out", "sweep.csv"), cells, engine, &cfg);
+        MPI_Finalize();
+        return rc;
+    }
 
-            // Conteo de coches que se mueven (C=1, R=0)
-            if (C == 1 && R == 0) {
-                local_moves++;
+    if (sn.restart) {
+        ca_snap_header_t h;
+        ca_snap_frame_t fr;
+        long long g0 = ca_seg_start(N, rank, size);
+        int local_N = (int)(ca_seg_start(N, rank + 1, size) - g0);
+        sn.init = (uint64_t *)calloc(ca_bits_words(local_N) + 1, sizeof(uint64_t));
+        if (!sn.init) {
+            fprintf(stderr, "Rank %d: error de memoria.\n", rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        if (ca_snap_mpi_read_last(MPI_COMM_WORLD, sn.restart, (uint64_t)N, (uint32_t)rule,
+                                  g0, g0 + local_N, &h, &fr, sn.init)) {
+            free(sn.init);
+            MPI_Finalize();
+            return 1;
+        }
+        if (fr.step > (uint64_t)iterations) {
+            if (rank == 0) {
+                fprintf(stderr, "Error: el snapshot está en el paso %llu, más allá de iterations.\n",
+                        (unsigned long long)fr.step);
             }
+            free(sn.init);
+            MPI_Finalize();
+            return 1;
         }
+        sn.start = (int)fr.step;
+        sn.moves0 = (long long)fr.moves;
+        sn.cars0 = (long long)h.cars;
+    }
 
-        // Intercambio de buffers
-        int *tmp = local_road;
-        local_road = new_local_road;
-        new_local_road = tmp;
+    // Repeticiones medidas (BENCH_WARMUP/BENCH_REPS, bench.h): cada una
+    // regenera la carretera y la muestra es el tiempo del bucle del rank más lento
+    bench_t bench;
+    bench_init(&bench, "cellular_autom_mpi", "N=%lld;iterations=%d;engine=%s;ranks=%d;density=%g;seed=%llu;isa=%s",
+               N, iterations, engine, size, density, (unsigned long long)seed, cpu_isa_name());
+    MPI_Bcast(&bench.warmup, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&bench.reps, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (bench.warmup + bench.reps > 1 && (sn.every > 0 || sn.restart)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: snap y restart requieren BENCH_WARMUP=0 y BENCH_REPS=1.\n");
+        }
+        free(sn.init);
+        MPI_Finalize();
+        return 1;
+    }
 
-        // Reducimos el número de movimientos de esta iteración
-        int moves_this_iter = 0;
-        MPI_Allreduce(&local_moves, &moves_this_iter, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+    ca_result_t res = { 0 };
+    long long global_moves = 0;
+    while (bench_next(&bench)) {
+        res = (ca_result_t){ 0 };
+        global_moves = run_engine(engine, N, iterations, &cfg, &sn, &res);
+        if (global_moves < 0) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        // La muestra es el bucle del rank más lento
+        double slowest = res.secs;
+        MPI_Reduce(&res.secs, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            bench_add(&bench, slowest);
+        }
+    }
+    long long total_cars_global = res.cars;
+    double elapsed_time = (rank == 0) ? bench_median(&bench) : res.secs;
+    snap_close(&sn);
 
+    // Coste de los snapshots: el máximo entre ranks (stderr)
+    if (sn.frames > 0) {
+        double io_max = 0.0;
+        MPI_Reduce(&sn.io, &io_max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
         if (rank == 0) {
-            global_moves += moves_this_iter;
+            fprintf(stderr, "[snap] marcos=%d archivo=%s io=%.6f s (%.2f%% del bucle)\n", sn.frames, sn.path,
+                    io_max, elapsed_time > 0.0 ? 100.0 * io_max / elapsed_time : 0.0);
         }
     }
 
-    double end_time = MPI_Wtime();
-    double elapsed_time = end_time - start_time;
+    if (rank == 0 && res.ff.step > 0) {
+        fprintf(stderr, "[ff] estacionario tras el paso %d: flujo=%lld por paso, %lld pasos extrapolados\n",
+                res.ff.step, res.ff.flux, res.ff.skipped);
+    }
 
-    if (rank == 0) {
-        double average_velocity = (double)global_moves / (iterations * total_cars_global);
-        printf("%lld, %f, %f\n", global_moves, elapsed_time, average_velocity);
+    // Tiempo de espera de halos por rank (stderr, para no romper el CSV)
+    if (waits) {
+        double *all_waits = (rank == 0) ? (double *)malloc(size * sizeof(double)) : NULL;
+        MPI_Gather(&res.wait, 1, MPI_DOUBLE, all_waits, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            for (int r = 0; r < size; r++) {
+                fprintf(stderr, "[waits] rank=%d overlap=%d wait=%.6f s (%.1f%% del bucle)\n",
+                        r, cfg.overlap, all_waits[r],
+                        elapsed_time > 0.0 ? 100.0 * all_waits[r] / elapsed_time : 0.0);
+            }
+            free(all_waits);
+        }
     }
 
-    free(local_road);
-    free(new_local_road);
+    if (rank == 0) {
+        if (total_cars_global == 0) {
+            printf("0, 0.0, 0.0\n");
+        } else {
+            double average_velocity = (double)global_moves / ((double)iterations * total_cars_global);
+            printf("%lld, %f, %f\n", global_moves, elapsed_time, average_velocity);
+        }
+        bench_report(&bench, (double)N * iterations, "cell_updates");
+        // Solo los pasos calculados (sin los reanudados ni los extrapolados por ff)
+        double ops, bytes, steps = (double)(iterations - sn.start) - (double)res.ff.skipped;
+        if (ca_roofline_cell(engine, &ops, &bytes)) {
+            bench_roofline(&bench, "intop", ops * N * steps, bytes * N * steps);
+        }
+    }
+    bench_free(&bench);
+    // Los segmentos de las repeticiones reutilizan los mismos bloques (arena.h)
+    if (rank == 0) arena_report("cellular_autom_mpi");
+    arena_release();
+    trace_dump_mpi(MPI_COMM_WORLD);
 
     MPI_Finalize();
     return 0;
@@ -1,9 +1,28 @@
 #!/bin/bash
 
 # Compilar el programa MPI con optimización
-mpicc -O3 -Wall -o cellular_autom_mpi_exe cellular_autom_mpi.c
+COMMON=${COMMON:-../../../../common}
+mpicc -O3 -Wall -fopenmp -I"$COMMON" -o cellular_autom_mpi_exe cellular_autom_mpi.c "$COMMON/bench.c" "$COMMON/arena.c" "$COMMON/trace.c" -lm
 echo "Compilación del programa MPI completada."
 
+# Tiempos del bucle con mediana, mínimo, desviación e IC95 (bench.h); con
+# BENCH_REPS>1 o BENCH_WARMUP>0 no se admiten snapshots
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV=${BENCH_CSV:-results_mpi_bench.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+# Páginas de las carreteras (arena.h): huge | thp | 4k
+export ARENA_PAGES=${ARENA_PAGES:-huge}
+# TRACE_JSON=trace.json deja la línea de tiempo por rank de la última
+# ejecución (pasos, halos, colectivas; trace.h) para chrome://tracing o Perfetto
+# Coordenadas roofline de los motores int/u8/bits (ca_roofline.h)
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV=${ROOFLINE_CSV:-results_mpi_roofline.csv}
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
+
 # Archivo para guardar resultados
 echo "Tipo, Tamaño, Repeticion, Movimientos totales, Tiempo total, Velocidad promedio" > results_mpi.csv
 
@@ -11,21 +30,58 @@ echo "Tipo, Tamaño, Repeticion, Movimientos totales, Tiempo total, Velocidad pr
 sizes=(100000 200000 300000 400000 500000)
 iterations=1000
 num_procs=4
+# Motor: int (un int por celda), bits (64 celdas por palabra), u8 (byte por celda, OpenMP)
+# nasch (Nagel–Schreckenberg), sparse (solo los huecos entre coches) o auto (sparse o bits según la densidad)
+engine=${ENGINE:-int}
+# Hilos OpenMP del motor u8 (por rank en MPI)
+threads=${THREADS:-1}
+# Regla elemental del motor bits y parámetros del motor nasch
+rule=${RULE:-184}
+vmax=${VMAX:-5}
+p=${P_SLOW:-0.0}
+# Snapshot binario cada SNAP pasos (0 = sin snapshots), uno por tamaño
+snap=${SNAP:-0}
+# Avance rápido al régimen estacionario, comprobado cada FF pasos (0 = simular todo)
+ff=${FF:-0}
+# Densidad inicial de coches; la repetición i genera la carretera con seed=i
+density=${DENSITY:-0.5}
+# Ancho de halo: k celdas intercambiadas cada k pasos (1 = esquema clásico);
+# en nasch, k/vmax pasos por intercambio (mínimo vmax)
+if [ "$engine" = "nasch" ]; then
+    halo=${HALO:-$vmax}
+else
+    halo=${HALO:-1}
+fi
 
 # Ejecutar simulaciones MPI
+# Con SWEEP=1, tamaños x densidades x repeticiones se lanzan una sola vez como
+# trabajos de una granja de tareas (modo sweep); resultados en sweep_mpi.csv
+densities=(${DENSITIES:-0.1 0.2 0.3 0.4 0.5 0.6 0.7 0.8 0.9})
 if command -v mpirun >/dev/null 2>&1; then
-    for i in {1..10}; do
-        echo "Iniciando repetición $i de 10..."
-        for N in "${sizes[@]}"; do
-            mpi_output=$(mpirun -np "$num_procs" ./cellular_autom_mpi_exe "$N" "$iterations")
-            if [ $? -eq 0 ]; then
-                echo "MPI, $N, $i, $mpi_output" >> results_mpi.csv
-            else
-                echo "Fallo en la ejecución MPI para N = $N"
-            fi
+    if [ "${SWEEP:-0}" = "1" ]; then
+        : > sweep_jobs.txt
+        for i in {1..10}; do
+            for N in "${sizes[@]}"; do
+                for d in "${densities[@]}"; do
+                    echo "$N $d $iterations $i" >> sweep_jobs.txt
+                done
+            done
+        done
+        mpirun -np "$num_procs" ./cellular_autom_mpi_exe sweep sweep_jobs.txt engine="$engine" threads="$threads" rule="$rule" vmax="$vmax" p="$p" ff="$ff" halo="$halo" out=sweep_mpi.csv || echo "Fallo en el barrido MPI"
+    else
+        for i in {1..10}; do
+            echo "Iniciando repetición $i de 10..."
+            for N in "${sizes[@]}"; do
+                mpi_output=$(mpirun -np "$num_procs" ./cellular_autom_mpi_exe "$N" "$iterations" engine="$engine" threads="$threads" rule="$rule" vmax="$vmax" p="$p" snap="$snap" snapfile="road_${N}.snap" ff="$ff" density="$density" seed="$i" halo="$halo")
+                if [ $? -eq 0 ]; then
+                    echo "MPI, $N, $i, $mpi_output" >> results_mpi.csv
+                else
+                    echo "Fallo en la ejecución MPI para N = $N"
+                fi
+            done
+            echo "" >> results_mpi.csv
         done
-        echo "" >> results_mpi.csv
-    done
+    fi
     echo "Todas las simulaciones MPI han finalizado con éxito."
 else
     echo "MPI no está disponible, omitiendo la ejecución MPI."
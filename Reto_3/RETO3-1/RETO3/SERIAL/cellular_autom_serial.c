@@ -1,47 +1,107 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include "../common/ca_opts.h"
+#include "../common/ca_bits.h"
+#include "../common/ca_ens.h"
+#include "../common/ca_ff.h"
+#include "../common/ca_init.h"
+#include "../common/ca_roofline.h"
+#include "../common/ca_rules.h"
+#include "../common/ca_nasch.h"
+#include "../common/ca_snap.h"
+#include "../common/ca_sparse.h"
+#include "../common/ca_u8.h"
+#include "bench.h"
+#include "arena.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
-int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        fprintf(stderr, "Uso: %s <number_of_cells> <iterations>\n", argv[0]);
-        return 1;
-    }
+static inline double wall_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
 
-    int N = atoi(argv[1]);
-    int iterations = atoi(argv[2]);
+// Snapshots (snap=P, snapfile=F) y reanudación (restart=F). Con restart los
+// motores parten de la carretera del último marco, en su paso y con sus
+// movimientos acumulados, así que la salida final es la de una corrida
+// ininterrumpida.
+typedef struct {
+    long long every;        // un marco cada P pasos (0 = sin snapshots)
+    const char *path;
+    const char *restart;
+    int rule;
+    uint64_t *init;         // carretera restaurada (NULL = aleatoria)
+    int start;              // primer paso a simular
+    long long moves0;       // movimientos acumulados hasta start
+    long long cars0;        // coches del encabezado
+    ca_snap_file_t f;
+    int frames;
+    double io;              // segundos escribiendo marcos
+} snap_t;
 
-    if (N <= 0 || iterations <= 0) {
-        fprintf(stderr, "Error: N e iterations deben ser positivos.\n");
-        return 1;
+static int snap_open(snap_t *sn, long long N, int iterations, long long cars) {
+    if (sn->every <= 0) {
+        return 0;
     }
+    uint64_t max_frames = (uint64_t)(iterations / sn->every - sn->start / sn->every);
+    int append = sn->restart && strcmp(sn->restart, sn->path) == 0;
+    return ca_snap_create(&sn->f, sn->path, (uint64_t)N, (uint32_t)sn->rule, (uint64_t)cars, max_frames, append);
+}
+
+static inline int snap_due(const snap_t *sn, int iter) {
+    return sn->every > 0 && (iter + 1) % sn->every == 0;
+}
+
+// Marco del paso iter+1: devuelve dónde empaquetar la carretera.
+static inline uint64_t *snap_begin(snap_t *sn, int iter, long long moves) {
+    return ca_snap_frame_begin(&sn->f, (uint64_t)iter + 1, (uint64_t)moves);
+}
 
-    int total_cars = 0;
+static inline void snap_end(snap_t *sn, double t0) {
+    ca_snap_frame_end(&sn->f);
+    sn->frames++;
+    sn->io += wall_sec() - t0;
+}
+
+// Motor original: un int por celda
+static int run_int(long long N, int iterations, const ca_init_t *init, snap_t *sn, ca_ff_t *ff, long long *moves_out, long long *cars_out, double *secs_out) {
+    long long total_cars = 0;
 
     // Usamos celdas fantasma: índices reales 1..N, 0 y N+1 como halos
-    int *road = (int *)malloc((N + 2) * sizeof(int));
-    int *new_road = (int *)malloc((N + 2) * sizeof(int));
+    int *road = (int *)arena_alloc((N + 2) * sizeof(int));
+    int *new_road = (int *)arena_alloc((N + 2) * sizeof(int));
 
     if (!road || !new_road) {
         fprintf(stderr, "Error de memoria.\n");
-        free(road);
-        free(new_road);
+        arena_free(road);
+        arena_free(new_road);
         return 1;
     }
 
-    srand((unsigned int)time(NULL));
-
-    // Inicializar carretera
-    for (int i = 1; i <= N; i++) {
-        road[i] = rand() % 2;
-        total_cars += road[i];
+    if (sn->init) {
+        ca_snap_unpack_int(&road[1], sn->init, N);
+        total_cars = sn->cars0;
+    } else {
+        // Inicializar carretera (misma celda global, mismo valor en todos los motores)
+        for (long long i = 1; i <= N; i++) {
+            road[i] = ca_init_at(init, i - 1);
+            total_cars += road[i];
+        }
     }
 
+    *cars_out = total_cars;
+    *moves_out = 0;
+    *secs_out = 0.0;
+
     // Si no hay coches, evitar división por cero después
     if (total_cars == 0) {
-        printf("0, 0.0, 0.0\n");
-        free(road);
-        free(new_road);
+        arena_free(road);
+        arena_free(new_road);
         return 0;
     }
 
@@ -49,19 +109,26 @@ int main(int argc, char *argv[]) {
     road[0] = road[N];
     road[N + 1] = road[1];
 
-    long long global_moves = 0;
+    ca_ff_init(ff, N, total_cars);
+    if (snap_open(sn, N, iterations, total_cars)) {
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    long long global_moves = sn->moves0;
     clock_t start_time = clock();
 
     // Bucle de simulación
-    for (int iter = 0; iter < iterations; iter++) {
-        int local_moves = 0;
+    for (int iter = sn->start; iter < iterations; iter++) {
+        long long local_moves = 0;
 
         // Actualizar halos para este paso
         road[0] = road[N];
         road[N + 1] = road[1];
 
         // Aplicar la regla local (tipo Rule-184)
-        for (int i = 1; i <= N; i++) {
+        for (long long i = 1; i <= N; i++) {
             int L = road[i - 1];
             int C = road[i];
             int R = road[i + 1];
@@ -86,15 +153,619 @@ int main(int argc, char *argv[]) {
         int *tmp = road;
         road = new_road;
         new_road = tmp;
+
+        if (snap_due(sn, iter)) {
+            double t0 = wall_sec();
+            ca_snap_pack_int(snap_begin(sn, iter, global_moves), &road[1], N);
+            snap_end(sn, t0);
+        }
+
+        if (ca_ff_due(ff, iter) && ca_ff_check(ff, iter, iterations, local_moves)) {
+            global_moves += ca_ff_moves(ff);
+            break;
+        }
+    }
+
+    clock_t end_time = clock();
+    *secs_out = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    *moves_out = global_moves;
+
+    arena_free(road);
+    arena_free(new_road);
+    return 0;
+}
+
+// Motor empaquetado: 64 celdas por palabra, paso con desplazamientos y popcount.
+// Acepta cualquier regla elemental (rule=0..255, kernel especializado por regla).
+static int run_bits(long long N, int iterations, int rule, const ca_init_t *init, snap_t *sn, ca_ff_t *ff, long long *moves_out, long long *cars_out, double *secs_out) {
+    ca_eca_step_fn step = ca_eca_steps[cpu_isa_level][rule];
+    size_t W = ca_bits_words(N);
+    unsigned tail = ca_bits_tail(N);
+
+    uint64_t *road = (uint64_t *)arena_calloc(W, sizeof(uint64_t));
+    uint64_t *new_road = (uint64_t *)arena_calloc(W, sizeof(uint64_t));
+
+    if (!road || !new_road) {
+        fprintf(stderr, "Error de memoria.\n");
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    long long total_cars;
+    if (sn->init) {
+        memcpy(road, sn->init, W * sizeof(uint64_t));
+        total_cars = sn->cars0;
+    } else {
+        // Misma carretera que el motor int, generada palabra a palabra
+        total_cars = ca_init_bits(road, 0, N, init);
+    }
+
+    *cars_out = total_cars;
+    *moves_out = 0;
+    *secs_out = 0.0;
+
+    if (total_cars == 0) {
+        arena_free(road);
+        arena_free(new_road);
+        return 0;
+    }
+
+    ca_ff_init(ff, N, total_cars);
+    if (snap_open(sn, N, iterations, total_cars)) {
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    long long global_moves = sn->moves0;
+    clock_t start_time = clock();
+
+    for (int iter = sn->start; iter < iterations; iter++) {
+        // Condiciones periódicas: izquierda de la celda 0 es N-1, derecha de N-1 es 0
+        uint64_t lbit = (uint64_t)ca_bits_get(road, N - 1);
+        uint64_t rbit = (uint64_t)ca_bits_get(road, 0);
+        long long local_moves = step(road, new_road, W, tail, lbit, rbit, 0, W);
+        global_moves += local_moves;
+
+        uint64_t *tmp = road;
+        road = new_road;
+        new_road = tmp;
+
+        // Mismo formato que en memoria: el marco es una copia directa
+        if (snap_due(sn, iter)) {
+            double t0 = wall_sec();
+            memcpy(snap_begin(sn, iter, global_moves), road, W * sizeof(uint64_t));
+            snap_end(sn, t0);
+        }
+
+        if (ca_ff_due(ff, iter) && ca_ff_check(ff, iter, iterations, local_moves)) {
+            global_moves += ca_ff_moves(ff);
+            break;
+        }
+    }
+
+    clock_t end_time = clock();
+    *secs_out = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    *moves_out = global_moves;
+
+    arena_free(road);
+    arena_free(new_road);
+    return 0;
+}
+
+// Motor OpenMP: un byte por celda, kernel sin ramas y vectorizado.
+// Una sola región paralela para todas las iteraciones; cada hilo es dueño de
+// un tramo contiguo, acumula sus movimientos localmente y sincroniza con una
+// barrera por paso. El tiempo es de pared (con varios hilos clock() sumaría
+// el tiempo de CPU de todos).
+static int run_u8(long long N, int iterations, int threads, const ca_init_t *init, snap_t *sn, ca_ff_t *ff, long long *moves_out, long long *cars_out, double *secs_out) {
+#ifndef _OPENMP
+    (void)threads;
+#endif
+    uint8_t *road = (uint8_t *)arena_alloc(N);
+    uint8_t *new_road = (uint8_t *)arena_alloc(N);
+
+    if (!road || !new_road) {
+        fprintf(stderr, "Error de memoria.\n");
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    // Primer contacto en paralelo con el mismo reparto que el bucle: cada
+    // tramo queda en el nodo NUMA del hilo que lo procesa
+    #pragma omp parallel num_threads(threads)
+    {
+        int T = 1, t = 0;
+#ifdef _OPENMP
+        T = omp_get_num_threads();
+        t = omp_get_thread_num();
+#endif
+        long long a = N * t / T, b = N * (t + 1) / T;
+        memset(road + a, 0, b - a);
+        memset(new_road + a, 0, b - a);
+    }
+
+    long long total_cars = 0;
+    if (sn->init) {
+        ca_snap_unpack_u8(road, sn->init, N);
+        total_cars = sn->cars0;
+    } else {
+        // Misma carretera que el motor int, con el reparto del primer contacto
+        #pragma omp parallel for num_threads(threads) schedule(static) reduction(+:total_cars)
+        for (long long i = 0; i < N; i++) {
+            road[i] = (uint8_t)ca_init_at(init, i);
+            total_cars += road[i];
+        }
+    }
+
+    *cars_out = total_cars;
+    *moves_out = 0;
+    *secs_out = 0.0;
+
+    if (total_cars == 0) {
+        arena_free(road);
+        arena_free(new_road);
+        return 0;
+    }
+
+    ca_ff_init(ff, N, total_cars);
+    if (snap_open(sn, N, iterations, total_cars)) {
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    // Movimientos por hilo, una línea de caché cada uno; se suman al final o
+    // cuando un snapshot necesita el total. Las casillas 1 y 2 guardan los
+    // movimientos del último paso para el avance rápido, alternando por
+    // comprobación para que un hilo adelantado no pise la anterior mientras
+    // otro todavía la lee.
+    long long *thread_moves = (long long *)calloc((size_t)threads * 8, sizeof(long long));
+    if (!thread_moves) {
+        fprintf(stderr, "Error de memoria.\n");
+        ca_snap_close(&sn->f);
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+    double start_time = wall_sec();
+
+    #pragma omp parallel num_threads(threads)
+    {
+        int T = 1, t = 0;
+#ifdef _OPENMP
+        T = omp_get_num_threads();
+        t = omp_get_thread_num();
+#endif
+        long long a = N * t / T, b = N * (t + 1) / T;
+        uint8_t *cur = road, *nxt = new_road;
+        long long my_moves = 0;
+
+        for (int iter = sn->start; iter < iterations; iter++) {
+            long long step_moves = ca_u8_ring_segment(cur, nxt, N, a, b);
+            my_moves += step_moves;
+            int ff_due = ca_ff_due(ff, iter);
+            int slot = ff_due ? 1 + (int)((iter / ff->every) & 1) : 0;
+            if (ff_due) {
+                thread_moves[t * 8 + slot] = step_moves;
+            }
+
+            uint8_t *tmp = cur;
+            cur = nxt;
+            nxt = tmp;
+
+            // El paso siguiente lee los bordes de los tramos vecinos
+            #pragma omp barrier
+
+            if (snap_due(sn, iter)) {
+                thread_moves[t * 8] = my_moves;
+                #pragma omp barrier
+                #pragma omp single
+                {
+                    double t0 = wall_sec();
+                    long long moves = sn->moves0;
+                    for (int u = 0; u < T; u++) moves += thread_moves[u * 8];
+                    ca_snap_pack_u8(snap_begin(sn, iter, moves), cur, N);
+                    snap_end(sn, t0);
+                }
+            }
+
+            // Todos los hilos suman lo mismo y salen juntos del bucle
+            if (ff_due) {
+                long long moves = 0;
+                for (int u = 0; u < T; u++) moves += thread_moves[u * 8 + slot];
+                if (moves == ff->flux) {
+                    if (t == 0) ca_ff_check(ff, iter, iterations, moves);
+                    break;
+                }
+            }
+        }
+        thread_moves[t * 8] = my_moves;
+    }
+
+    *secs_out = wall_sec() - start_time;
+    long long global_moves = sn->moves0;
+    for (int u = 0; u < threads; u++) global_moves += thread_moves[u * 8];
+    *moves_out = global_moves + ca_ff_moves(ff);
+
+    free(thread_moves);
+    arena_free(road);
+    arena_free(new_road);
+    return 0;
+}
+
+// Motor Nagel–Schreckenberg: un byte por celda con la velocidad del coche.
+// Arreglo extendido con vmax celdas fantasma por lado, copiadas del anillo
+// antes de cada paso; los coches que avanzan más allá de la última celda real
+// caen en el fantasma derecho y se pliegan al principio.
+static int run_nasch(long long N, int iterations, int vmax, const ca_init_t *init, const ca_nasch_t *model,
+                     long long *moves_out, long long *cars_out, double *secs_out) {
+    long long E = N + 2LL * vmax;
+    uint8_t *road = (uint8_t *)arena_alloc(E);
+    uint8_t *new_road = (uint8_t *)arena_alloc(E);
+
+    if (!road || !new_road) {
+        fprintf(stderr, "Error de memoria.\n");
+        arena_free(road);
+        arena_free(new_road);
+        return 1;
+    }
+
+    // Misma carretera que el motor int; los coches arrancan parados
+    long long total_cars = 0;
+    for (long long i = 0; i < N; i++) {
+        int car = ca_init_at(init, i);
+        road[vmax + i] = car ? 0 : CA_NASCH_EMPTY;
+        total_cars += car;
+    }
+
+    *cars_out = total_cars;
+    *moves_out = 0;
+    *secs_out = 0.0;
+
+    if (total_cars == 0) {
+        arena_free(road);
+        arena_free(new_road);
+        return 0;
+    }
+
+    ca_nasch_step_fn step = ca_nasch_steps[vmax];
+    long long global_moves = 0;
+    clock_t start_time = clock();
+
+    for (int iter = 0; iter < iterations; iter++) {
+        // Condiciones periódicas: fantasmas = extremos opuestos del anillo
+        memcpy(road, road + N, vmax);
+        memcpy(road + vmax + N, road + vmax, vmax);
+        memset(new_road, CA_NASCH_EMPTY, E);
+
+        global_moves += step(model, road, new_road, vmax, vmax + N, -vmax, iter, vmax, vmax + N);
+
+        for (long long j = vmax + N; j < E; j++) {
+            if (new_road[j] != CA_NASCH_EMPTY) {
+                new_road[j - N] = new_road[j];
+            }
+        }
+
+        uint8_t *tmp = road;
+        road = new_road;
+        new_road = tmp;
     }
 
     clock_t end_time = clock();
-    double elapsed_time = (double)(end_time - start_time) / CLOCKS_PER_SEC;
-    double average_velocity = (double)global_moves / (iterations * total_cars);
+    *secs_out = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    *moves_out = global_moves;
 
-    printf("%lld, %f, %f\n", global_moves, elapsed_time, average_velocity);
+    arena_free(road);
+    arena_free(new_road);
+    return 0;
+}
+
+// Motor de conjunto: 64 réplicas en bit-slicing (ca_ens.h), una palabra por
+// celda. Cada réplica tiene su propia carretera aleatoria y densidad; los
+// movimientos y coches se devuelven por réplica.
+static int run_ens(long long N, int iterations, int rule, uint64_t seed, const double *density,
+                   long long *moves_out, long long *cars_out, double *secs_out) {
+    uint64_t *road = (uint64_t *)malloc((N + 2) * sizeof(uint64_t));
+    uint64_t *new_road = (uint64_t *)malloc((N + 2) * sizeof(uint64_t));
+    ca_ens_counter_t *ctr = (ca_ens_counter_t *)calloc(1, sizeof(ca_ens_counter_t));
+
+    if (!road || !new_road || !ctr) {
+        fprintf(stderr, "Error de memoria.\n");
+        free(road);
+        free(new_road);
+        free(ctr);
+        return 1;
+    }
+
+    ca_ens_init(&road[1], N, seed, density, cars_out);
+    ca_ens_step_fn step = ca_ens_steps[rule];
+    clock_t start_time = clock();
+
+    for (int iter = 0; iter < iterations; iter++) {
+        road[0] = road[N];
+        road[N + 1] = road[1];
+        step(road, new_road, N, ctr);
+
+        uint64_t *tmp = road;
+        road = new_road;
+        new_road = tmp;
+    }
+    ca_ens_flush(ctr);
+
+    clock_t end_time = clock();
+    *secs_out = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    memcpy(moves_out, ctr->total, sizeof(ctr->total));
 
     free(road);
     free(new_road);
+    free(ctr);
+    return 0;
+}
+
+// Carretera empaquetada igual que en los demás motores, para
+// engine=sparse|auto, que eligen la representación según su densidad.
+static uint64_t *gen_road_bits(long long N, const ca_init_t *init, long long *cars) {
+    uint64_t *road = (uint64_t *)calloc(ca_bits_words(N), sizeof(uint64_t));
+    if (!road) {
+        fprintf(stderr, "Error de memoria.\n");
+        return NULL;
+    }
+    *cars = ca_init_bits(road, 0, N, init);
+    return road;
+}
+
+// Motor disperso (ca_sparse.h): solo los huecos entre coches, o entre huecos si
+// la densidad pasa de 1/2; O(partículas) por paso en vez de O(N).
+static int run_sparse(long long N, int iterations, const uint64_t *init, long long cars, ca_ff_t *ff,
+                      long long *moves_out, double *secs_out) {
+    int invert = ca_sparse_invert(N, cars);
+    long long M = invert ? N - cars : cars;
+    int32_t *g = (int32_t *)malloc((M > 0 ? M : 1) * sizeof(int32_t));
+
+    if (!g) {
+        fprintf(stderr, "Error de memoria.\n");
+        return 1;
+    }
+    ca_sparse_gaps(init, N, invert, g);
+    ca_ff_init(ff, N, cars);
+
+    long long global_moves = 0;
+    clock_t start_time = clock();
+
+    for (int iter = 0; iter < iterations && M > 0; iter++) {
+        long long local_moves = ca_sparse_step(g, M, g[0] > 0);
+        global_moves += local_moves;
+
+        if (ca_ff_due(ff, iter) && ca_ff_check(ff, iter, iterations, local_moves)) {
+            global_moves += ca_ff_moves(ff);
+            break;
+        }
+    }
+
+    clock_t end_time = clock();
+    *secs_out = (double)(end_time - start_time) / CLOCKS_PER_SEC;
+    *moves_out = global_moves;
+
+    fprintf(stderr, "[sparse] particulas=%s M=%lld (%.4f de N)\n", invert ? "huecos" : "coches", M,
+            (double)M / (double)N);
+    free(g);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Uso: %s <number_of_cells> <iterations> [engine=int|bits|u8|nasch|ens|sparse|auto] [threads=T] [rule=R] [vmax=V] [p=P] [seed=S] [snap=P] [snapfile=F] [restart=F] [ff=P] [density=D|A:B]\n", argv[0]);
+        return 1;
+    }
+
+    long long N = atoll(argv[1]);
+    int iterations = atoi(argv[2]);
+
+    if (N <= 0 || iterations <= 0) {
+        fprintf(stderr, "Error: N e iterations deben ser positivos.\n");
+        return 1;
+    }
+
+    if (ca_opts_check(argc, argv, 3, "engine threads rule vmax p seed snap snapfile restart ff density")) {
+        return 1;
+    }
+    const char *engine = ca_opt_str(argc, argv, 3, "engine", "int");
+
+    int use_ens = (strcmp(engine, "ens") == 0);
+    int use_sparse = (strcmp(engine, "sparse") == 0 || strcmp(engine, "auto") == 0);
+
+    // Regla elemental (engine=bits|ens); int y u8 solo implementan la 184
+    int rule = (int)ca_opt_ll(argc, argv, 3, "rule", 184);
+    if (rule < 0 || rule > 255 || (rule != 184 && strcmp(engine, "bits") != 0 && !use_ens)) {
+        fprintf(stderr, "Error: rule=%d no válida (0..255, distinta de 184 solo con engine=bits|ens).\n", rule);
+        return 1;
+    }
+
+    // Nagel–Schreckenberg: velocidad máxima, probabilidad de frenado y semilla
+    int vmax = (int)ca_opt_ll(argc, argv, 3, "vmax", 5);
+    uint64_t seed = (uint64_t)ca_opt_ll(argc, argv, 3, "seed", 1);
+    ca_nasch_t model = {
+        .seed = seed,
+        .pthr = ca_nasch_pthr(ca_opt_dbl(argc, argv, 3, "p", 0.0)),
+        .N = N,
+    };
+    if (vmax < 1 || vmax > CA_NASCH_VMAX || (vmax > N && strcmp(engine, "nasch") == 0)) {
+        fprintf(stderr, "Error: vmax (%d) debe estar entre 1 y %d (y no superar N).\n", vmax, CA_NASCH_VMAX);
+        return 1;
+    }
+    // Hilos OpenMP del motor u8 (por defecto, los de OMP_NUM_THREADS)
+    int threads = (int)ca_opt_ll(argc, argv, 3, "threads", 0);
+#ifdef _OPENMP
+    if (threads <= 0) threads = omp_get_max_threads();
+#else
+    threads = 1;
+#endif
+
+    snap_t sn = {
+        .every = ca_opt_ll(argc, argv, 3, "snap", 0),
+        .path = ca_opt_str(argc, argv, 3, "snapfile", "road.snap"),
+        .restart = ca_opt(argc, argv, 3, "restart"),
+        .rule = rule,
+    };
+    if ((sn.every > 0 || sn.restart) && (strcmp(engine, "nasch") == 0 || use_ens || use_sparse)) {
+        fprintf(stderr, "Error: los snapshots solo se admiten con engine=int|bits|u8.\n");
+        return 1;
+    }
+    if (sn.restart) {
+        ca_snap_header_t h;
+        ca_snap_frame_t fr;
+        sn.init = (uint64_t *)malloc(ca_snap_payload_bytes((uint64_t)N));
+        if (!sn.init || ca_snap_read_last(sn.restart, (uint64_t)N, (uint32_t)rule, &h, &fr, sn.init)) {
+            free(sn.init);
+            return 1;
+        }
+        if (fr.step > (uint64_t)iterations) {
+            fprintf(stderr, "Error: el snapshot está en el paso %llu, más allá de iterations.\n",
+                    (unsigned long long)fr.step);
+            free(sn.init);
+            return 1;
+        }
+        sn.start = (int)fr.step;
+        sn.moves0 = (long long)fr.moves;
+        sn.cars0 = (long long)h.cars;
+    }
+
+    // Avance rápido: cada P pasos se comprueba si la regla 184 ya es una
+    // traslación pura y, si lo es, se extrapolan los pasos restantes
+    ca_ff_t ff = { .every = ca_opt_ll(argc, argv, 3, "ff", 0) };
+    if (ff.every > 0 && (rule != 184 || strcmp(engine, "nasch") == 0 || use_ens)) {
+        fprintf(stderr, "Error: ff solo aplica a la regla 184 (no a otras reglas ni a engine=nasch|ens).\n");
+        free(sn.init);
+        return 1;
+    }
+
+    // Densidad inicial de coches (density=D). En el conjunto puede ser un
+    // barrido lineal de A a B entre la réplica 0 y la 63 (density=A:B)
+    double density[CA_ENS_REPLICAS];
+    {
+        const char *d = ca_opt_str(argc, argv, 3, "density", "0.5");
+        const char *colon = strchr(d, ':');
+        double a = atof(d), b = colon ? atof(colon + 1) : a;
+        if ((colon && !use_ens) || a < 0.0 || a > 1.0 || b < 0.0 || b > 1.0) {
+            fprintf(stderr, "Error: density=%s no válida (0..1; A:B solo con engine=ens).\n", d);
+            free(sn.init);
+            return 1;
+        }
+        for (int r = 0; r < CA_ENS_REPLICAS; r++) {
+            density[r] = a + (b - a) * r / (CA_ENS_REPLICAS - 1);
+        }
+    }
+    if (use_sparse && N > INT32_MAX) {
+        fprintf(stderr, "Error: engine=%s requiere N < 2^31 (huecos de 32 bits).\n", engine);
+        return 1;
+    }
+    // Carretera inicial: celda i ocupada según un hash de (seed, i), la misma
+    // que genera el programa MPI con cualquier número de procesos
+    ca_init_t init = ca_init_make(seed, density[0]);
+    long long ens_moves[CA_ENS_REPLICAS], ens_cars[CA_ENS_REPLICAS];
+
+    long long global_moves = 0, total_cars = 0;
+    double elapsed_time = 0.0;
+    int rc = 0;
+
+    // Repeticiones medidas (BENCH_WARMUP/BENCH_REPS, bench.h): cada una
+    // regenera la carretera; la muestra es el tiempo del bucle del motor
+    bench_t bench;
+    bench_init(&bench, "cellular_autom_serial", "N=%lld;iterations=%d;engine=%s;threads=%d;density=%g;seed=%llu;isa=%s",
+               N, iterations, engine, threads, density[0], (unsigned long long)seed, cpu_isa_name());
+    if (bench.warmup + bench.reps > 1 && (sn.every > 0 || sn.restart)) {
+        fprintf(stderr, "Error: snap y restart requieren BENCH_WARMUP=0 y BENCH_REPS=1.\n");
+        free(sn.init);
+        return 1;
+    }
+    while (rc == 0 && bench_next(&bench)) {
+        global_moves = total_cars = 0;
+        ff = (ca_ff_t){ .every = ff.every };
+
+        if (strcmp(engine, "int") == 0) {
+            rc = run_int(N, iterations, &init, &sn, &ff, &global_moves, &total_cars, &elapsed_time);
+        } else if (strcmp(engine, "bits") == 0) {
+            rc = run_bits(N, iterations, rule, &init, &sn, &ff, &global_moves, &total_cars, &elapsed_time);
+        } else if (strcmp(engine, "u8") == 0) {
+            rc = run_u8(N, iterations, threads, &init, &sn, &ff, &global_moves, &total_cars, &elapsed_time);
+        } else if (strcmp(engine, "nasch") == 0) {
+            rc = run_nasch(N, iterations, vmax, &init, &model, &global_moves, &total_cars, &elapsed_time);
+        } else if (use_sparse) {
+            // auto: disperso si la especie minoritaria es escasa, si no el motor
+            // empaquetado partiendo de la misma carretera
+            uint64_t *road = gen_road_bits(N, &init, &total_cars);
+            if (!road) {
+                return 1;
+            }
+            if (strcmp(engine, "sparse") == 0 || ca_sparse_prefer(N, total_cars)) {
+                rc = (total_cars == 0) ? 0 : run_sparse(N, iterations, road, total_cars, &ff, &global_moves, &elapsed_time);
+            } else {
+                fprintf(stderr, "[auto] densidad=%.4f: motor bits\n", (double)total_cars / (double)N);
+                sn.init = road;
+                sn.cars0 = total_cars;
+                road = NULL;
+                rc = run_bits(N, iterations, rule, &init, &sn, &ff, &global_moves, &total_cars, &elapsed_time);
+                free(sn.init);
+                sn.init = NULL;
+            }
+            free(road);
+        } else if (use_ens) {
+            rc = run_ens(N, iterations, rule, seed, density,
+                         ens_moves, ens_cars, &elapsed_time);
+        } else {
+            fprintf(stderr, "Error: engine desconocido '%s' (int|bits|u8|nasch|ens|sparse|auto).\n", engine);
+            return 1;
+        }
+        bench_add(&bench, elapsed_time);
+    }
+    ca_snap_close(&sn.f);
+    free(sn.init);
+    if (rc != 0) {
+        return rc;
+    }
+    elapsed_time = bench_median(&bench);
+
+    if (use_ens) {
+        // Una línea por réplica en stderr; stdout lleva el agregado
+        for (int r = 0; r < CA_ENS_REPLICAS; r++) {
+            global_moves += ens_moves[r];
+            total_cars += ens_cars[r];
+            fprintf(stderr, "[ens] replica=%d densidad=%.4f coches=%lld moves=%lld velocidad=%f\n", r,
+                    (double)ens_cars[r] / N, ens_cars[r], ens_moves[r],
+                    ens_cars[r] > 0 ? (double)ens_moves[r] / ((double)iterations * ens_cars[r]) : 0.0);
+        }
+    }
+
+    // Coste de los snapshots (stderr, para no romper el CSV)
+    if (sn.frames > 0) {
+        fprintf(stderr, "[snap] marcos=%d archivo=%s io=%.6f s (%.2f%% del bucle)\n", sn.frames, sn.path,
+                sn.io, elapsed_time > 0.0 ? 100.0 * sn.io / elapsed_time : 0.0);
+    }
+
+    if (ff.step > 0) {
+        fprintf(stderr, "[ff] estacionario tras el paso %d: flujo=%lld por paso, %lld pasos extrapolados\n",
+                ff.step, ff.flux, ff.skipped);
+    }
+
+    // Si no hay coches, evitar división por cero
+    if (total_cars == 0) {
+        printf("0, 0.0, 0.0\n");
+    } else {
+        double average_velocity = (double)global_moves / ((double)iterations * total_cars);
+        printf("%lld, %f, %f\n", global_moves, elapsed_time, average_velocity);
+    }
+    bench_report(&bench, (double)N * iterations * (use_ens ? CA_ENS_REPLICAS : 1), "cell_updates");
+    // Solo los pasos calculados (sin los reanudados ni los extrapolados por ff)
+    double ops, bytes, steps = (double)(iterations - sn.start) - (double)ff.skipped;
+    if (ca_roofline_cell(engine, &ops, &bytes)) {
+        bench_roofline(&bench, "intop", ops * N * steps, bytes * N * steps);
+    }
+    bench_free(&bench);
+    // Las carreteras de las repeticiones reutilizan los mismos bloques (arena.h)
+    arena_report("cellular_autom_serial");
+    arena_release();
     return 0;
 }
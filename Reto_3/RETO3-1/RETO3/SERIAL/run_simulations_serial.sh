@@ -1,21 +1,53 @@
 #!/bin/bash
 
 # Compilar el programa serial con optimización
-gcc -O3 -Wall -o cellular_autom_serial_exe cellular_autom_serial.c
+COMMON=${COMMON:-../../../../common}
+gcc -O3 -Wall -fopenmp -I"$COMMON" -o cellular_autom_serial_exe cellular_autom_serial.c "$COMMON/bench.c" "$COMMON/arena.c" -lm
 echo "Compilación del programa serial completada."
 
+# Tiempos del bucle con mediana, mínimo, desviación e IC95 (bench.h); con
+# BENCH_REPS>1 o BENCH_WARMUP>0 no se admiten snapshots
+[ -n "${BENCH_CSV:-}" ] || fresh_bench=1
+export BENCH_CSV=${BENCH_CSV:-results_serial_bench.csv}
+export BENCH_WARMUP=${BENCH_WARMUP:-0}
+export BENCH_REPS=${BENCH_REPS:-1}
+# Páginas de las carreteras (arena.h): huge | thp | 4k
+export ARENA_PAGES=${ARENA_PAGES:-huge}
+# Coordenadas roofline de los motores int/u8/bits (ca_roofline.h)
+[ -n "${ROOFLINE_CSV:-}" ] || fresh_roofline=1
+export ROOFLINE_CSV=${ROOFLINE_CSV:-results_serial_roofline.csv}
+# Solo se vacían los CSV por defecto del script: a uno exportado por el
+# usuario se le añaden filas
+if [ -n "${fresh_bench:-}" ]; then rm -f "$BENCH_CSV"; fi
+if [ -n "${fresh_roofline:-}" ]; then rm -f "$ROOFLINE_CSV"; fi
+
 # Archivo para guardar resultados
 echo "Tipo, Tamaño, Repeticion, Movimientos totales, Tiempo total, Velocidad promedio" > results_serial.csv
 
 # Parámetros de simulación
 sizes=(100000 200000 300000 400000 500000)
 iterations=1000
+# Motor: int (un int por celda), bits (64 celdas por palabra), u8 (byte por celda, OpenMP)
+# nasch (Nagel–Schreckenberg), ens (64 réplicas), sparse (solo los huecos entre coches) o auto (sparse o bits según la densidad)
+engine=${ENGINE:-int}
+# Hilos OpenMP del motor u8 (por rank en MPI)
+threads=${THREADS:-1}
+# Regla elemental del motor bits y parámetros del motor nasch
+rule=${RULE:-184}
+vmax=${VMAX:-5}
+p=${P_SLOW:-0.0}
+# Snapshot binario cada SNAP pasos (0 = sin snapshots), uno por tamaño
+snap=${SNAP:-0}
+# Avance rápido al régimen estacionario, comprobado cada FF pasos (0 = simular todo)
+ff=${FF:-0}
+# Densidad inicial de coches (en engine=ens, D o barrido A:B entre las 64 réplicas)
+density=${DENSITY:-0.5}
 
 # Ejecutar simulaciones
 for i in {1..10}; do
     echo "Iniciando repetición $i de 10..."
     for N in "${sizes[@]}"; do
-        serial_output=$(./cellular_autom_serial_exe "$N" "$iterations")
+        serial_output=$(./cellular_autom_serial_exe "$N" "$iterations" engine="$engine" threads="$threads" rule="$rule" vmax="$vmax" p="$p" snap="$snap" snapfile="road_${N}.snap" ff="$ff" density="$density" seed="$i")
         echo "Serial, $N, $i, $serial_output" >> results_serial.csv
     done
     echo "" >> results_serial.csv
@@ -0,0 +1,77 @@
+#ifndef CA_BITS_H
+#define CA_BITS_H
+// Carretera empaquetada: 64 celdas por uint64_t.
+// Celda i -> palabra i/64, bit i%64 (bit 0 = celda de más a la izquierda),
+// así "vecino izquierdo" es un desplazamiento a la izquierda de la palabra.
+#include <stdint.h>
+#include <stddef.h>
+
+static inline size_t ca_bits_words(long long n) {
+    return (size_t)((n + 63) / 64);
+}
+
+// Número de celdas válidas en la última palabra (1..64).
+static inline unsigned ca_bits_tail(long long n) {
+    return (unsigned)(n - (long long)(ca_bits_words(n) - 1) * 64);
+}
+
+static inline uint64_t ca_bits_tailmask(unsigned tail) {
+    return (tail == 64) ? ~0ULL : ((1ULL << tail) - 1);
+}
+
+static inline int ca_bits_get(const uint64_t *w, long long i) {
+    return (int)((w[i >> 6] >> (i & 63)) & 1ULL);
+}
+
+static inline void ca_bits_set(uint64_t *w, long long i, int v) {
+    uint64_t m = 1ULL << (i & 63);
+    w[i >> 6] = v ? (w[i >> 6] | m) : (w[i >> 6] & ~m);
+}
+
+static inline long long ca_bits_count(const uint64_t *w, size_t nw) {
+    long long c = 0;
+    for (size_t j = 0; j < nw; j++) c += __builtin_popcountll(w[j]);
+    return c;
+}
+
+// m <= 64 celdas a partir de la celda i, en los bits bajos. Solo lee las
+// palabras que contienen esas celdas.
+static inline uint64_t ca_bits_get_n(const uint64_t *w, long long i, unsigned m) {
+    unsigned sh = (unsigned)(i & 63);
+    uint64_t v = w[i >> 6] >> sh;
+    if (sh != 0 && sh + m > 64) v |= w[(i >> 6) + 1] << (64 - sh);
+    return (m == 64) ? v : (v & ((1ULL << m) - 1));
+}
+
+// Copia n celdas src[soff..] -> dst[doff..] en trozos de hasta 64 celdas
+// alineados a las palabras de dst (halos, snapshots e inicialización).
+static inline void ca_bits_copy(uint64_t *dst, long long doff, const uint64_t *src, long long soff, long long n) {
+    while (n > 0) {
+        unsigned sh = (unsigned)(doff & 63);
+        unsigned m = 64 - sh;
+        if ((long long)m > n) m = (unsigned)n;
+        uint64_t mask = ((m == 64) ? ~0ULL : ((1ULL << m) - 1)) << sh;
+        uint64_t *d = &dst[doff >> 6];
+        *d = (*d & ~mask) | ((ca_bits_get_n(src, soff, m) << sh) & mask);
+        doff += m;
+        soff += m;
+        n -= m;
+    }
+}
+
+// Coches que dejan su celda, popcount(C & ~C'), en las celdas [lo, hi) de
+// un paso c -> n. Pensada para rangos cortos (zonas fantasma de los halos
+// profundos); las celdas fuera de la última palabra valen 0 en ambos.
+static inline long long ca_bits_vacated_range(const uint64_t *c, const uint64_t *n, long long lo, long long hi) {
+    long long moves = 0;
+    if (lo >= hi) return 0;
+    for (size_t j = (size_t)(lo >> 6); j <= (size_t)((hi - 1) >> 6); j++) {
+        long long b0 = (long long)j * 64;
+        uint64_t m = ~0ULL;
+        if (lo > b0) m &= ~0ULL << (lo - b0);
+        if (hi < b0 + 64) m &= (1ULL << (hi - b0)) - 1;
+        moves += __builtin_popcountll(c[j] & ~n[j] & m);
+    }
+    return moves;
+}
+#endif
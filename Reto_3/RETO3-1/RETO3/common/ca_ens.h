@@ -0,0 +1,166 @@
+#ifndef CA_ENS_H
+#define CA_ENS_H
+// Conjunto (ensemble) de 64 réplicas independientes en "bit-slicing": una
+// palabra de 64 bits por posición de celda, con el bit r igual a la celda de la
+// réplica r. La regla elemental de ca_rules.h ya opera bit a bit, así que una
+// sola evaluación de ca_eca() avanza las 64 carreteras a la vez.
+//
+// Los movimientos por réplica se acumulan en contadores también en
+// bit-slicing. Un sumador carry-save (Harley–Seal) reduce cada grupo de 16
+// máscaras de movimiento a unos/doses/cuatros/ochos/dieciseises, y los
+// dieciseises se suman con acarreo en CA_ENS_PLANES planos. Hay dos juegos de
+// carry-save que procesan grupos alternos: son cadenas de dependencias
+// independientes que el procesador solapa. Antes de que los planos desborden
+// (cada grupo de 32 máscaras suma como mucho 2 dieciseises) se vuelcan a los
+// totales enteros de cada réplica.
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "ca_rules.h"
+#include "ca_nasch.h"
+
+#define CA_ENS_REPLICAS 64
+#define CA_ENS_PLANES 8
+#define CA_ENS_GROUP 32                                 // máscaras por llamada a ca_ens_add
+#define CA_ENS_FLUSH (((1 << CA_ENS_PLANES) - 1) / 2)   // llamadas entre volcados
+
+typedef struct {
+    uint64_t csa[2][4];                 // pesos 1, 2, 4 y 8 de cada juego
+    uint64_t plane[CA_ENS_PLANES];      // peso 16 << k
+    int pending;                        // llamadas a ca_ens_add desde el último volcado
+    long long total[CA_ENS_REPLICAS];
+} ca_ens_counter_t;
+
+static inline void ca_ens_csa(uint64_t *h, uint64_t *l, uint64_t a, uint64_t b, uint64_t c) {
+    uint64_t u = a ^ b;
+    *h = (a & b) | (u & c);
+    *l = u ^ c;
+}
+
+static inline void ca_ens_flush_word(long long *total, uint64_t b, long long weight) {
+    for (; b; b &= b - 1) {
+        total[__builtin_ctzll(b)] += weight;
+    }
+}
+
+// Pasa los contadores en bit-slicing a los totales enteros de cada réplica.
+static inline void ca_ens_flush(ca_ens_counter_t *k) {
+    for (int h = 0; h < 2; h++) {
+        for (int j = 0; j < 4; j++) {
+            ca_ens_flush_word(k->total, k->csa[h][j], 1LL << j);
+        }
+    }
+    for (int j = 0; j < CA_ENS_PLANES; j++) {
+        ca_ens_flush_word(k->total, k->plane[j], 16LL << j);
+    }
+    memset(k->csa, 0, sizeof(k->csa));
+    memset(k->plane, 0, sizeof(k->plane));
+    k->pending = 0;
+}
+
+// 16 máscaras en un juego de carry-save: quince CSA, devuelve los dieciseises.
+static inline uint64_t ca_ens_csa16(uint64_t s[4], const uint64_t m[16]) {
+    uint64_t twos_a, twos_b, fours_a, fours_b, eights_a, eights_b, sixteens;
+    ca_ens_csa(&twos_a, &s[0], s[0], m[0], m[1]);
+    ca_ens_csa(&twos_b, &s[0], s[0], m[2], m[3]);
+    ca_ens_csa(&fours_a, &s[1], s[1], twos_a, twos_b);
+    ca_ens_csa(&twos_a, &s[0], s[0], m[4], m[5]);
+    ca_ens_csa(&twos_b, &s[0], s[0], m[6], m[7]);
+    ca_ens_csa(&fours_b, &s[1], s[1], twos_a, twos_b);
+    ca_ens_csa(&eights_a, &s[2], s[2], fours_a, fours_b);
+    ca_ens_csa(&twos_a, &s[0], s[0], m[8], m[9]);
+    ca_ens_csa(&twos_b, &s[0], s[0], m[10], m[11]);
+    ca_ens_csa(&fours_a, &s[1], s[1], twos_a, twos_b);
+    ca_ens_csa(&twos_a, &s[0], s[0], m[12], m[13]);
+    ca_ens_csa(&twos_b, &s[0], s[0], m[14], m[15]);
+    ca_ens_csa(&fours_b, &s[1], s[1], twos_a, twos_b);
+    ca_ens_csa(&eights_b, &s[2], s[2], fours_a, fours_b);
+    ca_ens_csa(&sixteens, &s[3], s[3], eights_a, eights_b);
+    return sixteens;
+}
+
+static inline void ca_ens_ripple(ca_ens_counter_t *k, uint64_t x) {
+    for (int j = 0; j < CA_ENS_PLANES && x; j++) {
+        uint64_t c = k->plane[j] & x;
+        k->plane[j] ^= x;
+        x = c;
+    }
+}
+
+// Suma CA_ENS_GROUP máscaras de movimiento (16 en cada juego de carry-save).
+static inline void ca_ens_add(ca_ens_counter_t *k, const uint64_t m[CA_ENS_GROUP]) {
+    uint64_t x0 = ca_ens_csa16(k->csa[0], m);
+    uint64_t x1 = ca_ens_csa16(k->csa[1], m + 16);
+    ca_ens_ripple(k, x0);
+    ca_ens_ripple(k, x1);
+    if (++k->pending == CA_ENS_FLUSH) {
+        ca_ens_flush(k);
+    }
+}
+
+// Un paso de las 64 réplicas sobre las celdas 1..N de c (c[0] y c[N+1] son
+// los halos periódicos, ya cargados). Movimientos = coches que dejan su
+// celda, C & ~C', como en el motor bits.
+static inline __attribute__((always_inline)) void
+ca_ens_step_cells(const int rule, const uint64_t *c, uint64_t *n, long long N, ca_ens_counter_t *k) {
+    uint64_t m[CA_ENS_GROUP];
+    long long i = 1;
+    for (; i + CA_ENS_GROUP - 1 <= N; i += CA_ENS_GROUP) {
+        for (int u = 0; u < CA_ENS_GROUP; u++) {
+            uint64_t C = c[i + u];
+            uint64_t nw = ca_eca(rule, c[i + u - 1], C, c[i + u + 1]);
+            n[i + u] = nw;
+            m[u] = C & ~nw;
+        }
+        ca_ens_add(k, m);
+    }
+    if (i <= N) {
+        for (int u = 0; u < CA_ENS_GROUP; u++, i++) {
+            if (i <= N) {
+                uint64_t C = c[i];
+                uint64_t nw = ca_eca(rule, c[i - 1], C, c[i + 1]);
+                n[i] = nw;
+                m[u] = C & ~nw;
+            } else {
+                m[u] = 0;
+            }
+        }
+        ca_ens_add(k, m);
+    }
+}
+
+typedef void (*ca_ens_step_fn)(const uint64_t *c, uint64_t *n, long long N, ca_ens_counter_t *k);
+
+#define CA_ENS_DEFINE(R) \
+    static void ca_ens_step_##R(const uint64_t *c, uint64_t *n, long long N, ca_ens_counter_t *k) { \
+        ca_ens_step_cells(R, c, n, N, k); \
+    }
+CA_ECA_LIST(CA_ENS_DEFINE)
+#undef CA_ENS_DEFINE
+
+#define CA_ENS_ENTRY(R) ca_ens_step_##R,
+static const ca_ens_step_fn ca_ens_steps[256] = { CA_ECA_LIST(CA_ENS_ENTRY) };
+#undef CA_ENS_ENTRY
+
+// Carretera inicial: la celda i de la réplica r está ocupada con probabilidad
+// density[r], con un hash contador (semilla, celda, réplica) en vez de rand():
+// cada réplica es independiente y el resultado no depende del orden.
+static inline void ca_ens_init(uint64_t *c, long long N, uint64_t seed, const double *density,
+                               long long cars[CA_ENS_REPLICAS]) {
+    uint64_t thr[CA_ENS_REPLICAS];
+    for (int r = 0; r < CA_ENS_REPLICAS; r++) {
+        double d = density[r] < 0.0 ? 0.0 : density[r] > 1.0 ? 1.0 : density[r];
+        thr[r] = (uint64_t)(d * 9007199254740992.0);  // d * 2^53
+        cars[r] = 0;
+    }
+    for (long long i = 0; i < N; i++) {
+        uint64_t w = 0;
+        for (int r = 0; r < CA_ENS_REPLICAS; r++) {
+            uint64_t bit = (ca_nasch_hash(seed, (uint64_t)i, (uint64_t)r) >> 11) < thr[r];
+            w |= bit << r;
+            cars[r] += (long long)bit;
+        }
+        c[i] = w;
+    }
+}
+#endif
@@ -0,0 +1,52 @@
+#ifndef CA_FF_H
+#define CA_FF_H
+// Avance rápido (ff=P) al régimen estacionario de la regla 184 en un anillo.
+//
+// Un paso mueve como mucho min(coches, huecos) coches. Si en un paso se
+// mueven todos los coches, cada uno tenía un hueco delante y la carretera
+// siguiente es la actual desplazada una celda a la derecha: vuelven a tener
+// un hueco delante y se mueven todos en todos los pasos siguientes. Si se
+// mueven tantos como huecos hay, cada hueco tenía un coche detrás y el patrón
+// de huecos se desplaza una celda a la izquierda, también para siempre. En
+// ambos casos el estado es una traslación pura y los pasos restantes aportan
+// exactamente min(coches, huecos) movimientos cada uno, así que al detectarlo
+// se suma ese término y se deja de simular.
+//
+// Cada P pasos se compara el número de movimientos del último paso con el
+// flujo máximo; con varios hilos o procesos eso cuesta una reducción, de ahí
+// que no se haga en todos los pasos. El régimen se detecta como mucho P pasos
+// después de alcanzarlo.
+
+typedef struct {
+    long long every;    // comprobar cada P pasos (0 = desactivado)
+    long long flux;     // min(coches, huecos): movimientos por paso en régimen
+    int step;           // paso tras el cual se extrapola (0 = no se alcanzó)
+    long long skipped;  // pasos no simulados
+} ca_ff_t;
+
+static inline void ca_ff_init(ca_ff_t *ff, long long N, long long cars) {
+    ff->flux = cars < N - cars ? cars : N - cars;
+    ff->step = 0;
+    ff->skipped = 0;
+}
+
+static inline int ca_ff_due(const ca_ff_t *ff, int iter) {
+    return ff->every > 0 && (iter + 1) % ff->every == 0;
+}
+
+// step_moves: movimientos globales del paso iter. Devuelve 1 si el estado
+// tras ese paso ya es estacionario (y deja anotados el paso y los saltados).
+static inline int ca_ff_check(ca_ff_t *ff, int iter, int iterations, long long step_moves) {
+    if (step_moves != ff->flux) {
+        return 0;
+    }
+    ff->step = iter + 1;
+    ff->skipped = (long long)iterations - (iter + 1);
+    return 1;
+}
+
+// Movimientos de los pasos no simulados
+static inline long long ca_ff_moves(const ca_ff_t *ff) {
+    return ff->skipped * ff->flux;
+}
+#endif
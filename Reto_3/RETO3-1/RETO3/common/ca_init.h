@@ -0,0 +1,59 @@
+#ifndef CA_INIT_H
+#define CA_INIT_H
+// Carretera inicial con un generador contador: la celda global i está ocupada
+// si hash(semilla, i) < densidad. No hay estado secuencial (rand()), así que
+// cada rank genera su propio tramo en paralelo, sin que rank 0 cree y reparta
+// la carretera entera, y el resultado es el mismo bit a bit con cualquier
+// número de procesos o hilos. La semilla (seed=S) hace la corrida
+// reproducible.
+#include <stdint.h>
+
+typedef struct {
+    uint64_t seed;
+    uint64_t thr;       // densidad * 2^53
+} ca_init_t;
+
+static inline ca_init_t ca_init_make(uint64_t seed, double density) {
+    double d = density < 0.0 ? 0.0 : density > 1.0 ? 1.0 : density;
+    ca_init_t in = { seed, (uint64_t)(d * 9007199254740992.0) };
+    return in;
+}
+
+// splitmix64 de (semilla, celda); constantes distintas de las del frenado de
+// ca_nasch.h para que ambos flujos no se correlacionen.
+static inline uint64_t ca_init_hash(uint64_t seed, uint64_t i) {
+    uint64_t z = seed * 0xD6E8FEB86659FD93ULL + i * 0x9E3779B97F4A7C15ULL + 0xA0761D6478BD642FULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline int ca_init_at(const ca_init_t *in, long long i) {
+    return (ca_init_hash(in->seed, (uint64_t)i) >> 11) < in->thr;
+}
+
+// Celdas globales [g0, g0+n) empaquetadas en w (formato ca_bits.h), palabra a
+// palabra para poder repartirlas entre hilos. Devuelve los coches.
+static inline long long ca_init_bits(uint64_t *w, long long g0, long long n, const ca_init_t *in) {
+    long long W = (n + 63) / 64, cars = 0;
+    #pragma omp parallel for schedule(static) reduction(+:cars)
+    for (long long j = 0; j < W; j++) {
+        long long hi = (j + 1) * 64 < n ? (j + 1) * 64 : n;
+        uint64_t x = 0;
+        for (long long i = j * 64; i < hi; i++) {
+            x |= (uint64_t)ca_init_at(in, g0 + i) << (i - j * 64);
+        }
+        w[j] = x;
+        cars += __builtin_popcountll(x);
+    }
+    return cars;
+}
+
+// Primera celda del rank r al repartir N celdas entre size procesos: bloques
+// de N/size y los N % size primeros con una celda más (N no tiene que ser
+// divisible por el número de procesos).
+static inline long long ca_seg_start(long long N, int r, int size) {
+    long long q = N / size, rem = N % size;
+    return q * r + (r < rem ? r : rem);
+}
+#endif
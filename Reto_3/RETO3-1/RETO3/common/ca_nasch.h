@@ -0,0 +1,91 @@
+#ifndef CA_NASCH_H
+#define CA_NASCH_H
+// Modelo de Nagel–Schreckenberg (varias velocidades, frenado aleatorio).
+// Un byte por celda: CA_NASCH_EMPTY si está vacía, si no la velocidad 0..vmax.
+// Cada paso, para cada coche: v = min(v+1, vmax), v = min(v, hueco delante),
+// con probabilidad p v = v-1 (si v > 0), y avanza v celdas.
+//
+// El frenado aleatorio usa un hash contador (semilla, celda global, paso): no
+// depende de la descomposición, así que serial y MPI dan el mismo resultado y
+// las zonas fantasma se recalculan de forma idéntica a las del vecino.
+//
+// vmax es constante de compilación: ca_nasch_step_cells se instancia para
+// vmax = 1..CA_NASCH_VMAX y ca_nasch_steps[] se indexa una vez al arrancar.
+// Con vmax = 1 y p = 0 es exactamente la regla 184.
+//
+// Movimientos = suma de las velocidades (celdas recorridas), de modo que
+// moves / (iteraciones * coches) es la velocidad media.
+#include <stdint.h>
+#include <stddef.h>
+
+#define CA_NASCH_EMPTY 0xFF
+#define CA_NASCH_VMAX 8
+
+typedef struct {
+    uint64_t seed;
+    uint32_t pthr;      // frenado si hash32 < pthr (p * 2^32)
+    long long N;        // celdas globales, para el índice periódico
+} ca_nasch_t;
+
+static inline uint64_t ca_nasch_hash(uint64_t seed, uint64_t cell, uint64_t t) {
+    uint64_t z = seed + cell * 0x9E3779B97F4A7C15ULL + t * 0xD1B54A32D192ED03ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint32_t ca_nasch_pthr(double p) {
+    if (p <= 0.0) return 0;
+    if (p >= 1.0) return UINT32_MAX;
+    return (uint32_t)(p * 4294967296.0);
+}
+
+// Paso sobre los coches en [lo, hi) de c, escribiendo en n (que debe llegar
+// lleno de CA_NASCH_EMPTY). Lee c[lo .. hi+vmax) y escribe n[lo .. hi+vmax).
+// g0 es el índice global (sin reducir módulo N) de la celda 0 del arreglo;
+// solo los coches en [mlo, mhi) suman a los movimientos.
+static inline __attribute__((always_inline)) long long
+ca_nasch_step_cells(const int vmax, const ca_nasch_t *m, const uint8_t *c, uint8_t *n,
+                    long long lo, long long hi, long long g0, long long t, long long mlo, long long mhi) {
+    long long moves = 0;
+    for (long long i = lo; i < hi; i++) {
+        int v = c[i];
+        if (v == CA_NASCH_EMPTY) continue;
+        v = (v < vmax) ? v + 1 : vmax;
+        for (int d = 1; d <= vmax; d++) {
+            if (d <= v && c[i + d] != CA_NASCH_EMPTY) {
+                v = d - 1;
+                break;
+            }
+        }
+        if (v > 0 && m->pthr) {
+            long long g = (g0 + i) % m->N;
+            if (g < 0) g += m->N;
+            v -= (uint32_t)(ca_nasch_hash(m->seed, (uint64_t)g, (uint64_t)t) >> 32) < m->pthr;
+        }
+        n[i + v] = (uint8_t)v;
+        moves += (i >= mlo && i < mhi) ? v : 0;
+    }
+    return moves;
+}
+
+typedef long long (*ca_nasch_step_fn)(const ca_nasch_t *m, const uint8_t *c, uint8_t *n,
+                                      long long lo, long long hi, long long g0, long long t,
+                                      long long mlo, long long mhi);
+
+#define CA_NASCH_LIST(X) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8)
+
+#define CA_NASCH_DEFINE(V)                                                                     \
+    static long long ca_nasch_step_##V(const ca_nasch_t *m, const uint8_t *c, uint8_t *n,        \
+                                       long long lo, long long hi, long long g0, long long t,     \
+                                       long long mlo, long long mhi) {                          \
+        return ca_nasch_step_cells(V, m, c, n, lo, hi, g0, t, mlo, mhi);                       \
+    }
+CA_NASCH_LIST(CA_NASCH_DEFINE)
+#undef CA_NASCH_DEFINE
+
+// Índice = vmax (la entrada 0 no se usa)
+#define CA_NASCH_ENTRY(V) ca_nasch_step_##V,
+static const ca_nasch_step_fn ca_nasch_steps[CA_NASCH_VMAX + 1] = { NULL, CA_NASCH_LIST(CA_NASCH_ENTRY) };
+#undef CA_NASCH_ENTRY
+#endif
@@ -0,0 +1,56 @@
+#ifndef CA_OPTS_H
+#define CA_OPTS_H
+// Opciones "clave=valor" después de los argumentos posicionales, p. ej.:
+//   ./cellular_autom_serial 100000 1000 engine=bits
+// Los programas declaran la lista de claves válidas y ca_opts_check
+// rechaza cualquier otra (evita errores de tipeo silenciosos).
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Devuelve el valor de "key=" o NULL si no está.
+static inline const char *ca_opt(int argc, char **argv, int first, const char *key) {
+    size_t k = strlen(key);
+    for (int i = first; i < argc; i++) {
+        if (strncmp(argv[i], key, k) == 0 && argv[i][k] == '=') {
+            return argv[i] + k + 1;
+        }
+    }
+    return NULL;
+}
+
+static inline const char *ca_opt_str(int argc, char **argv, int first, const char *key, const char *dflt) {
+    const char *v = ca_opt(argc, argv, first, key);
+    return v ? v : dflt;
+}
+
+static inline long long ca_opt_ll(int argc, char **argv, int first, const char *key, long long dflt) {
+    const char *v = ca_opt(argc, argv, first, key);
+    return v ? atoll(v) : dflt;
+}
+
+static inline double ca_opt_dbl(int argc, char **argv, int first, const char *key, double dflt) {
+    const char *v = ca_opt(argc, argv, first, key);
+    return v ? atof(v) : dflt;
+}
+
+// known: lista de claves separadas por espacios. Devuelve 0 si todo es válido.
+static inline int ca_opts_check(int argc, char **argv, int first, const char *known) {
+    for (int i = first; i < argc; i++) {
+        const char *eq = strchr(argv[i], '=');
+        size_t k = eq ? (size_t)(eq - argv[i]) : 0;
+        int ok = 0;
+        for (const char *p = known; k > 0 && *p; ) {
+            size_t n = strcspn(p, " ");
+            if (n == k && strncmp(p, argv[i], k) == 0) { ok = 1; break; }
+            p += n;
+            while (*p == ' ') p++;
+        }
+        if (!ok) {
+            fprintf(stderr, "Opción desconocida: %s (válidas: %s)\n", argv[i], known);
+            return 1;
+        }
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,32 @@
+#ifndef CA_ROOFLINE_H
+#define CA_ROOFLINE_H
+// Trabajo y tráfico por celda y paso de los motores densos de la regla 184,
+// para situarlos en el modelo roofline (bench_roofline, ROOFLINE_CSV). Son
+// operaciones enteras: se comparan con el techo de ancho de banda, no con el
+// pico de FMA.
+//   int:  C ? R : L, C & ~R y la suma de movimientos (4 op); lee y escribe un
+//         int por celda (8 bytes)
+//   u8:   las mismas 4 op sobre bytes (2 bytes)
+//   bits: por palabra de 64 celdas, vecinos L y R con desplazamientos y el
+//         acarreo de la palabra vecina (4 op), la regla (3 op), movimientos
+//         con and-not, popcount y suma (3 op); lee y escribe 8 bytes
+// Los motores dispersos, nasch y el conjunto no tienen un coste fijo por
+// celda: devuelve 0 y no se informan.
+#include <string.h>
+
+static inline int ca_roofline_cell(const char *engine, double *ops, double *bytes) {
+    if (strcmp(engine, "int") == 0) {
+        *ops = 4.0;
+        *bytes = 8.0;
+    } else if (strcmp(engine, "u8") == 0) {
+        *ops = 4.0;
+        *bytes = 2.0;
+    } else if (strcmp(engine, "bits") == 0) {
+        *ops = 10.0 / 64.0;
+        *bytes = 16.0 / 64.0;
+    } else {
+        return 0;
+    }
+    return 1;
+}
+#endif
@@ -0,0 +1,116 @@
+#ifndef CA_RULES_H
+#define CA_RULES_H
+// Autómatas elementales (las 256 reglas de Wolfram) sobre la carretera
+// empaquetada de ca_bits.h, especializados en compilación.
+//
+// La regla es una constante de compilación: ca_eca() la expande como un
+// multiplexor de tres niveles (L, C, R) cuyas hojas son las constantes 0 o ~0
+// de la tabla de la regla, y el compilador pliega cada rama a unas pocas
+// operaciones lógicas. CA_ECA_LIST genera una función de paso por regla y
+// ca_eca_steps[] las indexa: la regla se elige una vez al arrancar, nunca por
+// celda ni por palabra. La tabla tiene además una fila por nivel de ISA y
+// ca_eca_steps[cpu_isa_level][rule] elige la versión del procesador
+// (cpu_isa.h).
+//
+// Movimientos = coches que dejan su celda, popcount(C & ~C'). Para la regla
+// 184 coincide con C & ~R (coche con hueco delante).
+#include <stdint.h>
+#include <stddef.h>
+#include "ca_bits.h"
+#include "cpu_isa.h"
+
+// Hoja del multiplexor: bit b de la tabla de la regla, replicado a 64 bits.
+#define CA_ECA_BIT(rule, b) ((((rule) >> (b)) & 1) ? ~0ULL : 0ULL)
+
+static inline uint64_t ca_mux(uint64_t s, uint64_t a, uint64_t b) {
+    return (s & a) | (~s & b);  // s ? a : b, bit a bit
+}
+
+// Salida de la regla para 64 vecindarios: el bit (L<<2 | C<<1 | R) de rule.
+static inline __attribute__((always_inline)) uint64_t ca_eca(const int rule, uint64_t l, uint64_t c, uint64_t r) {
+    return ca_mux(l, ca_mux(c, ca_mux(r, CA_ECA_BIT(rule, 7), CA_ECA_BIT(rule, 6)),
+                               ca_mux(r, CA_ECA_BIT(rule, 5), CA_ECA_BIT(rule, 4))),
+                     ca_mux(c, ca_mux(r, CA_ECA_BIT(rule, 3), CA_ECA_BIT(rule, 2)),
+                               ca_mux(r, CA_ECA_BIT(rule, 1), CA_ECA_BIT(rule, 0))));
+}
+
+// Un paso sobre las palabras [j0, j1) de un arreglo de W (tail celdas válidas
+// en la última). Los vecinos fuera del rango se leen del arreglo; lbit es la
+// celda a la izquierda de la celda 0 y rbit la de la derecha de la última.
+static inline __attribute__((always_inline)) long long
+ca_eca_step_words(const int rule, const uint64_t *c, uint64_t *n, size_t W, unsigned tail,
+                  uint64_t lbit, uint64_t rbit, size_t j0, size_t j1) {
+    long long moves = 0;
+    if (j0 >= j1) return 0;
+    uint64_t carry = (j0 == 0) ? (lbit & 1ULL) : (c[j0 - 1] >> 63);
+    size_t jend = (j1 == W) ? W - 1 : j1;
+    for (size_t j = j0; j < jend; j++) {
+        uint64_t w = c[j];
+        uint64_t L = (w << 1) | carry;
+        uint64_t R = (w >> 1) | (c[j + 1] << 63);
+        uint64_t nw = ca_eca(rule, L, w, R);
+        n[j] = nw;
+        moves += __builtin_popcountll(w & ~nw);
+        carry = w >> 63;
+    }
+    if (j1 == W) {
+        // Última palabra, posiblemente parcial: R de la última celda viene de rbit
+        uint64_t mask = ca_bits_tailmask(tail);
+        uint64_t w = c[W - 1];
+        uint64_t L = (w << 1) | carry;
+        uint64_t R = (w >> 1) | ((rbit & 1ULL) << (tail - 1));
+        uint64_t nw = ca_eca(rule, L, w, R) & mask;
+        n[W - 1] = nw;
+        moves += __builtin_popcountll(w & ~nw);
+    }
+    return moves;
+}
+
+typedef long long (*ca_eca_step_fn)(const uint64_t *c, uint64_t *n, size_t W, unsigned tail,
+                                    uint64_t lbit, uint64_t rbit, size_t j0, size_t j1);
+
+#define CA_ECA_LIST(X) \
+    X(0)   X(1)   X(2)   X(3)   X(4)   X(5)   X(6)   X(7)   X(8)   X(9)   X(10)  X(11)  X(12)  X(13)  X(14)  X(15)  \
+    X(16)  X(17)  X(18)  X(19)  X(20)  X(21)  X(22)  X(23)  X(24)  X(25)  X(26)  X(27)  X(28)  X(29)  X(30)  X(31)  \
+    X(32)  X(33)  X(34)  X(35)  X(36)  X(37)  X(38)  X(39)  X(40)  X(41)  X(42)  X(43)  X(44)  X(45)  X(46)  X(47)  \
+    X(48)  X(49)  X(50)  X(51)  X(52)  X(53)  X(54)  X(55)  X(56)  X(57)  X(58)  X(59)  X(60)  X(61)  X(62)  X(63)  \
+    X(64)  X(65)  X(66)  X(67)  X(68)  X(69)  X(70)  X(71)  X(72)  X(73)  X(74)  X(75)  X(76)  X(77)  X(78)  X(79)  \
+    X(80)  X(81)  X(82)  X(83)  X(84)  X(85)  X(86)  X(87)  X(88)  X(89)  X(90)  X(91)  X(92)  X(93)  X(94)  X(95)  \
+    X(96)  X(97)  X(98)  X(99)  X(100) X(101) X(102) X(103) X(104) X(105) X(106) X(107) X(108) X(109) X(110) X(111) \
+    X(112) X(113) X(114) X(115) X(116) X(117) X(118) X(119) X(120) X(121) X(122) X(123) X(124) X(125) X(126) X(127) \
+    X(128) X(129) X(130) X(131) X(132) X(133) X(134) X(135) X(136) X(137) X(138) X(139) X(140) X(141) X(142) X(143) \
+    X(144) X(145) X(146) X(147) X(148) X(149) X(150) X(151) X(152) X(153) X(154) X(155) X(156) X(157) X(158) X(159) \
+    X(160) X(161) X(162) X(163) X(164) X(165) X(166) X(167) X(168) X(169) X(170) X(171) X(172) X(173) X(174) X(175) \
+    X(176) X(177) X(178) X(179) X(180) X(181) X(182) X(183) X(184) X(185) X(186) X(187) X(188) X(189) X(190) X(191) \
+    X(192) X(193) X(194) X(195) X(196) X(197) X(198) X(199) X(200) X(201) X(202) X(203) X(204) X(205) X(206) X(207) \
+    X(208) X(209) X(210) X(211) X(212) X(213) X(214) X(215) X(216) X(217) X(218) X(219) X(220) X(221) X(222) X(223) \
+    X(224) X(225) X(226) X(227) X(228) X(229) X(230) X(231) X(232) X(233) X(234) X(235) X(236) X(237) X(238) X(239) \
+    X(240) X(241) X(242) X(243) X(244) X(245) X(246) X(247) X(248) X(249) X(250) X(251) X(252) X(253) X(254) X(255)
+
+// Dos versiones por regla: la base y una con POPCNT (SSE4.2 en adelante). El
+// acarreo entre palabras impide vectorizar el paso, así que AVX2 y AVX-512 no
+// aportan nada aquí y usan la de POPCNT (y la compilación no se cuadruplica).
+#define CA_ECA_DEFINE(R)                                                                        \
+    static long long ca_eca_step_##R(const uint64_t *c, uint64_t *n, size_t W, unsigned tail,    \
+                                     uint64_t lbit, uint64_t rbit, size_t j0, size_t j1) {      \
+        return ca_eca_step_words(R, c, n, W, tail, lbit, rbit, j0, j1);                         \
+    }                                                                                           \
+    CPU_ISA_TARGET_SSE42 static long long                                                       \
+    ca_eca_step_##R##_popcnt(const uint64_t *c, uint64_t *n, size_t W, unsigned tail,           \
+                             uint64_t lbit, uint64_t rbit, size_t j0, size_t j1) {              \
+        return ca_eca_step_words(R, c, n, W, tail, lbit, rbit, j0, j1);                         \
+    }
+CA_ECA_LIST(CA_ECA_DEFINE)
+#undef CA_ECA_DEFINE
+
+#define CA_ECA_ENTRY(R) ca_eca_step_##R,
+#define CA_ECA_ENTRY_POPCNT(R) ca_eca_step_##R##_popcnt,
+static const ca_eca_step_fn ca_eca_steps[CPU_ISA_COUNT][256] = {
+    { CA_ECA_LIST(CA_ECA_ENTRY) },          // generic
+    { CA_ECA_LIST(CA_ECA_ENTRY_POPCNT) },   // sse4.2
+    { CA_ECA_LIST(CA_ECA_ENTRY_POPCNT) },   // avx2
+    { CA_ECA_LIST(CA_ECA_ENTRY_POPCNT) },   // avx512
+};
+#undef CA_ECA_ENTRY
+#undef CA_ECA_ENTRY_POPCNT
+#endif
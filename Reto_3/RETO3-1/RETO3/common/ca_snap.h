@@ -0,0 +1,226 @@
+#ifndef CA_SNAP_H
+#define CA_SNAP_H
+// Snapshots binarios de la carretera (estados 0/1).
+//
+// Formato (enteros little-endian):
+//   encabezado de 64 bytes (ca_snap_header_t)
+//   marcos consecutivos de ca_snap_frame_bytes(N) bytes:
+//     uint64 paso, uint64 movimientos acumulados hasta ese paso,
+//     carretera empaquetada: ca_bits_words(N) palabras de 64 bits con el
+//     mismo convenio que ca_bits.h (celda i -> bit i%64 de la palabra i/64,
+//     es decir, bit i%8 del byte i/8), relleno a cero.
+// Un archivo guarda una trayectoria; para reanudar se usa el último marco.
+//
+// La versión serial escribe y lee con mmap: el marco se empaqueta directamente
+// en la página del archivo y el kernel lo vuelca en segundo plano. La versión
+// MPI (ca_snap_mpi.h) usa MPI-IO colectivo sobre el mismo formato.
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ca_bits.h"
+
+#define CA_SNAP_MAGIC "CASNAP1"
+
+#ifdef MAP_POPULATE
+#define CA_SNAP_POPULATE MAP_POPULATE
+#else
+#define CA_SNAP_POPULATE 0
+#endif
+
+typedef struct {
+    char magic[8];
+    uint64_t N;         // celdas
+    uint64_t frames;    // marcos completos
+    uint64_t cars;      // coches iniciales (denominador de la velocidad)
+    uint32_t rule;      // regla elemental de la trayectoria
+    uint32_t reserved0;
+    uint64_t reserved[3];
+} ca_snap_header_t;
+
+typedef struct {
+    uint64_t step;
+    uint64_t moves;
+} ca_snap_frame_t;
+
+static inline size_t ca_snap_payload_bytes(uint64_t N) {
+    return ca_bits_words((long long)N) * sizeof(uint64_t);
+}
+
+static inline size_t ca_snap_frame_bytes(uint64_t N) {
+    return sizeof(ca_snap_frame_t) + ca_snap_payload_bytes(N);
+}
+
+static inline void ca_snap_header_init(ca_snap_header_t *h, uint64_t N, uint32_t rule, uint64_t cars) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, CA_SNAP_MAGIC, sizeof(CA_SNAP_MAGIC));
+    h->N = N;
+    h->rule = rule;
+    h->cars = cars;
+}
+
+// 0 si el encabezado es válido y compatible con (N, rule).
+static inline int ca_snap_header_check(const ca_snap_header_t *h, uint64_t N, uint32_t rule, const char *path) {
+    if (memcmp(h->magic, CA_SNAP_MAGIC, sizeof(CA_SNAP_MAGIC)) != 0) {
+        fprintf(stderr, "Error: %s no es un snapshot válido.\n", path);
+        return 1;
+    }
+    if (h->N != N || h->rule != rule) {
+        fprintf(stderr, "Error: %s es de N=%llu rule=%u (pedido N=%llu rule=%u).\n", path,
+                (unsigned long long)h->N, h->rule, (unsigned long long)N, rule);
+        return 1;
+    }
+    if (h->frames == 0) {
+        fprintf(stderr, "Error: %s no contiene marcos.\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+// Empaquetado/desempaquetado desde los motores de un int o un byte por celda.
+static inline void ca_snap_pack_int(uint64_t *dst, const int *src, long long n) {
+    for (long long j = 0; j * 64 < n; j++) {
+        uint64_t w = 0;
+        long long m = (n - j * 64 < 64) ? n - j * 64 : 64;
+        for (long long b = 0; b < m; b++) w |= (uint64_t)(src[j * 64 + b] & 1) << b;
+        dst[j] = w;
+    }
+}
+
+// 8 celdas 0/1 por multiplicación: el byte j de x acaba en el bit 56+j.
+// Escribe bytes sueltos, válido porque el formato es little-endian como x86.
+static inline void ca_snap_pack_u8(uint64_t *dst, const uint8_t *src, long long n) {
+    uint8_t *out = (uint8_t *)dst;
+    long long nb = n / 8;
+    for (long long b = 0; b < nb; b++) {
+        uint64_t x;
+        memcpy(&x, src + 8 * b, 8);
+        out[b] = (uint8_t)(((x & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56);
+    }
+    size_t used = (size_t)nb;
+    if (n % 8) {
+        uint8_t v = 0;
+        for (long long i = nb * 8; i < n; i++) v |= (uint8_t)((src[i] & 1) << (i - nb * 8));
+        out[used++] = v;
+    }
+    memset(out + used, 0, ca_bits_words(n) * sizeof(uint64_t) - used);
+}
+
+static inline void ca_snap_unpack_int(int *dst, const uint64_t *src, long long n) {
+    for (long long i = 0; i < n; i++) dst[i] = ca_bits_get(src, i);
+}
+
+static inline void ca_snap_unpack_u8(uint8_t *dst, const uint64_t *src, long long n) {
+    for (long long i = 0; i < n; i++) dst[i] = (uint8_t)ca_bits_get(src, i);
+}
+
+// Escritor serial con mmap. El archivo se dimensiona de una vez para
+// max_frames marcos nuevos y al cerrar se recorta a los marcos escritos.
+typedef struct {
+    int fd;
+    uint8_t *map;
+    size_t len;
+    size_t frame;
+    ca_snap_header_t *hdr;
+} ca_snap_file_t;
+
+// append: conserva los marcos de un archivo existente compatible.
+static inline int ca_snap_create(ca_snap_file_t *f, const char *path, uint64_t N, uint32_t rule,
+                                 uint64_t cars, uint64_t max_frames, int append) {
+    memset(f, 0, sizeof(*f));
+    f->fd = open(path, O_RDWR | O_CREAT | (append ? 0 : O_TRUNC), 0644);
+    if (f->fd < 0) {
+        perror(path);
+        return 1;
+    }
+    f->frame = ca_snap_frame_bytes(N);
+
+    ca_snap_header_t h;
+    ca_snap_header_init(&h, N, rule, cars);
+    if (append) {
+        if (pread(f->fd, &h, sizeof(h), 0) != (ssize_t)sizeof(h) || ca_snap_header_check(&h, N, rule, path)) {
+            close(f->fd);
+            return 1;
+        }
+    }
+
+    f->len = sizeof(h) + (size_t)(h.frames + max_frames) * f->frame;
+    if (ftruncate(f->fd, (off_t)f->len) != 0) {
+        perror(path);
+        close(f->fd);
+        return 1;
+    }
+    // MAP_POPULATE reserva las páginas al abrir, fuera del bucle de simulación
+    f->map = (uint8_t *)mmap(NULL, f->len, PROT_READ | PROT_WRITE, MAP_SHARED | CA_SNAP_POPULATE, f->fd, 0);
+    if (f->map == MAP_FAILED) {
+        perror(path);
+        close(f->fd);
+        return 1;
+    }
+    f->hdr = (ca_snap_header_t *)f->map;
+    *f->hdr = h;
+    return 0;
+}
+
+// Devuelve la carretera del marco siguiente para que el motor la rellene;
+// ca_snap_frame_end lo da por completo.
+static inline uint64_t *ca_snap_frame_begin(ca_snap_file_t *f, uint64_t step, uint64_t moves) {
+    uint8_t *p = f->map + sizeof(ca_snap_header_t) + f->hdr->frames * f->frame;
+    if (p + f->frame > f->map + f->len) return NULL;
+    ca_snap_frame_t fr = { step, moves };
+    memcpy(p, &fr, sizeof(fr));
+    return (uint64_t *)(p + sizeof(fr));
+}
+
+static inline void ca_snap_frame_end(ca_snap_file_t *f) {
+    f->hdr->frames++;
+}
+
+static inline void ca_snap_close(ca_snap_file_t *f) {
+    if (!f->map) return;
+    size_t used = sizeof(ca_snap_header_t) + f->hdr->frames * f->frame;
+    munmap(f->map, f->len);
+    if (ftruncate(f->fd, (off_t)used) != 0) perror("ftruncate");
+    close(f->fd);
+    f->map = NULL;
+}
+
+// Lee el último marco: copia la carretera (W palabras) en road.
+static inline int ca_snap_read_last(const char *path, uint64_t N, uint32_t rule, ca_snap_header_t *h,
+                                    ca_snap_frame_t *fr, uint64_t *road) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(*h)) {
+        fprintf(stderr, "Error: %s no es un snapshot válido.\n", path);
+        close(fd);
+        return 1;
+    }
+    uint8_t *map = (uint8_t *)mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return 1;
+    }
+    memcpy(h, map, sizeof(*h));
+    size_t frame = ca_snap_frame_bytes(N);
+    int rc = ca_snap_header_check(h, N, rule, path);
+    if (rc == 0 && sizeof(*h) + h->frames * frame > (size_t)st.st_size) {
+        fprintf(stderr, "Error: %s está truncado.\n", path);
+        rc = 1;
+    }
+    if (rc == 0) {
+        const uint8_t *p = map + sizeof(*h) + (h->frames - 1) * frame;
+        memcpy(fr, p, sizeof(*fr));
+        memcpy(road, p + sizeof(*fr), ca_snap_payload_bytes(N));
+    }
+    munmap(map, (size_t)st.st_size);
+    return rc;
+}
+#endif
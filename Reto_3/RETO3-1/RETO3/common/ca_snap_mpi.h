@@ -0,0 +1,216 @@
+#ifndef CA_SNAP_MPI_H
+#define CA_SNAP_MPI_H
+// Snapshots con MPI-IO colectivo, mismo formato que ca_snap.h (el archivo no
+// depende del número de procesos: se puede reanudar con otro).
+//
+// Cada rank tiene las celdas globales [s, e) y escribe los bytes del marco
+// cuyo primer bit es suyo, [ceil(s/8), ceil(e/8)); el último llega hasta el
+// final del marco (relleno incluido). El último byte se completa con hasta 7
+// celdas del vecino derecho, que llegan con un MPI_Sendrecv de una palabra.
+//
+// La escritura es no bloqueante (MPI_File_iwrite_at_all): el marco k viaja
+// mientras se simulan los pasos hasta el marco k+1, que es cuando se espera.
+// Rank 0 escribe además el prefijo (paso, movimientos) y actualiza el número
+// de marcos del encabezado cada vez que uno se completa.
+#include <stdlib.h>
+#include <mpi.h>
+#include "ca_snap.h"
+
+typedef struct {
+    MPI_File fh;
+    MPI_Comm comm;
+    int rank, size, left, right;
+    uint64_t N;
+    long long s, e;             // celdas globales del rank
+    long long b_lo, b_hi;       // bytes del marco que escribe este rank
+    size_t frame;
+    ca_snap_header_t hdr;       // válido en rank 0
+    uint64_t frames;            // marcos emitidos (incluido el que está en vuelo)
+    uint64_t *buf;              // bytes [b_lo, b_hi) del marco, en palabras
+    ca_snap_frame_t pre;
+    MPI_Request req[2];         // datos y prefijo del marco en vuelo
+    int active;
+} ca_snap_mpi_t;
+
+static inline MPI_Offset ca_snap_mpi_frame_off(const ca_snap_mpi_t *t, uint64_t k) {
+    return (MPI_Offset)sizeof(ca_snap_header_t) + (MPI_Offset)(k * t->frame);
+}
+
+// Colectiva. append: continúa un archivo existente compatible.
+static inline int ca_snap_mpi_open(ca_snap_mpi_t *t, MPI_Comm comm, const char *path, uint64_t N, uint32_t rule,
+                                   uint64_t cars, long long s, long long e, int append) {
+    memset(t, 0, sizeof(*t));
+    t->comm = comm;
+    MPI_Comm_rank(comm, &t->rank);
+    MPI_Comm_size(comm, &t->size);
+    t->left = (t->rank + t->size - 1) % t->size;
+    t->right = (t->rank + 1) % t->size;
+    t->N = N;
+    t->s = s;
+    t->e = e;
+    t->frame = ca_snap_frame_bytes(N);
+    t->b_lo = (s + 7) / 8;
+    t->b_hi = (t->rank == t->size - 1) ? (long long)ca_snap_payload_bytes(N) : (e + 7) / 8;
+
+    if (e - s < 8 && t->size > 1) {
+        if (t->rank == 0) {
+            fprintf(stderr, "Error: los snapshots MPI requieren al menos 8 celdas por proceso.\n");
+        }
+        return 1;
+    }
+    t->buf = (uint64_t *)calloc((size_t)((t->b_hi - t->b_lo) / 8 + 2), sizeof(uint64_t));
+    int rc = (t->buf == NULL);
+    MPI_Allreduce(MPI_IN_PLACE, &rc, 1, MPI_INT, MPI_MAX, comm);
+    if (rc) {
+        free(t->buf);
+        t->buf = NULL;
+        return 1;
+    }
+
+    if (MPI_File_open(comm, path, MPI_MODE_CREATE | MPI_MODE_RDWR, MPI_INFO_NULL, &t->fh) != MPI_SUCCESS) {
+        if (t->rank == 0) {
+            fprintf(stderr, "Error: no se pudo abrir %s.\n", path);
+        }
+        free(t->buf);
+        t->buf = NULL;
+        return 1;
+    }
+    if (!append) {
+        MPI_File_set_size(t->fh, 0);
+    }
+    if (t->rank == 0) {
+        ca_snap_header_init(&t->hdr, N, rule, cars);
+        if (append) {
+            MPI_File_read_at(t->fh, 0, &t->hdr, (int)sizeof(t->hdr), MPI_BYTE, MPI_STATUS_IGNORE);
+            rc = ca_snap_header_check(&t->hdr, N, rule, path);
+        } else {
+            MPI_File_write_at(t->fh, 0, &t->hdr, (int)sizeof(t->hdr), MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+        t->frames = t->hdr.frames;
+    }
+    MPI_Bcast(&rc, 1, MPI_INT, 0, comm);
+    MPI_Bcast(&t->frames, 1, MPI_UINT64_T, 0, comm);
+    if (rc) {
+        MPI_File_close(&t->fh);
+        free(t->buf);
+        t->buf = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+static inline void ca_snap_mpi_wait(ca_snap_mpi_t *t) {
+    if (!t->active) {
+        return;
+    }
+    MPI_Waitall(t->rank == 0 ? 2 : 1, t->req, MPI_STATUSES_IGNORE);
+    t->active = 0;
+    if (t->rank == 0) {
+        t->hdr.frames = t->frames;
+        MPI_File_write_at(t->fh, 0, &t->hdr, (int)sizeof(t->hdr), MPI_BYTE, MPI_STATUS_IGNORE);
+    }
+}
+
+// Colectiva. seg: las e-s celdas del rank empaquetadas desde el bit 0;
+// moves: movimientos globales hasta step (solo se usa en rank 0).
+static inline void ca_snap_mpi_write(ca_snap_mpi_t *t, uint64_t step, uint64_t moves, const uint64_t *seg) {
+    long long n = t->e - t->s;
+
+    // Primeras 7 celdas del vecino derecho para completar el último byte
+    uint64_t mine = ca_bits_get_n(seg, 0, n < 7 ? (unsigned)n : 7), next = 0;
+    MPI_Sendrecv(&mine, 1, MPI_UINT64_T, t->left, 7, &next, 1, MPI_UINT64_T, t->right, 7,
+                 t->comm, MPI_STATUS_IGNORE);
+
+    ca_snap_mpi_wait(t);
+
+    long long nbytes = t->b_hi - t->b_lo;
+    memset(t->buf, 0, (size_t)(nbytes / 8 + 2) * sizeof(uint64_t));
+    long long d0 = t->b_lo * 8 - t->s;     // 0..7
+    if (d0 < n) {
+        ca_bits_copy(t->buf, 0, seg, d0, n - d0);
+        long long extra = t->b_hi * 8 - t->e;
+        if (t->e + extra > (long long)t->N) extra = (long long)t->N - t->e;
+        if (extra > 7) extra = 7;
+        if (extra > 0) {
+            // buf viene a cero: basta con un OR en una o dos palabras
+            long long p = n - d0;
+            uint64_t v = next & ((1ULL << extra) - 1);
+            unsigned sh = (unsigned)(p & 63);
+            t->buf[p >> 6] |= v << sh;
+            if (sh + extra > 64) t->buf[(p >> 6) + 1] |= v >> (64 - sh);
+        }
+    }
+
+    MPI_Offset off = ca_snap_mpi_frame_off(t, t->frames);
+    MPI_File_iwrite_at_all(t->fh, off + (MPI_Offset)sizeof(ca_snap_frame_t) + t->b_lo,
+                           t->buf, (int)nbytes, MPI_BYTE, &t->req[0]);
+    if (t->rank == 0) {
+        t->pre = (ca_snap_frame_t){ step, moves };
+        MPI_File_iwrite_at(t->fh, off, &t->pre, (int)sizeof(t->pre), MPI_BYTE, &t->req[1]);
+    }
+    t->active = 1;
+    t->frames++;
+}
+
+static inline void ca_snap_mpi_close(ca_snap_mpi_t *t) {
+    if (!t->buf) {
+        return;
+    }
+    ca_snap_mpi_wait(t);
+    MPI_File_close(&t->fh);
+    free(t->buf);
+    t->buf = NULL;
+}
+
+// Colectiva: lee del último marco las celdas [s, e) en seg (desde el bit 0).
+static inline int ca_snap_mpi_read_last(MPI_Comm comm, const char *path, uint64_t N, uint32_t rule,
+                                        long long s, long long e, ca_snap_header_t *h,
+                                        ca_snap_frame_t *fr, uint64_t *seg) {
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    MPI_File fh;
+    int rc = 0;
+    if (MPI_File_open(comm, path, MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) != MPI_SUCCESS) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: no se pudo abrir %s.\n", path);
+        }
+        return 1;
+    }
+    size_t frame = ca_snap_frame_bytes(N);
+    if (rank == 0) {
+        MPI_Offset size = 0;
+        memset(h, 0, sizeof(*h));
+        MPI_File_get_size(fh, &size);
+        MPI_File_read_at(fh, 0, h, (int)sizeof(*h), MPI_BYTE, MPI_STATUS_IGNORE);
+        rc = ca_snap_header_check(h, N, rule, path);
+        if (rc == 0 && (MPI_Offset)(sizeof(*h) + h->frames * frame) > size) {
+            fprintf(stderr, "Error: %s está truncado.\n", path);
+            rc = 1;
+        }
+        if (rc == 0) {
+            MPI_File_read_at(fh, (MPI_Offset)(sizeof(*h) + (h->frames - 1) * frame), fr, (int)sizeof(*fr),
+                             MPI_BYTE, MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Bcast(&rc, 1, MPI_INT, 0, comm);
+    if (rc) {
+        MPI_File_close(&fh);
+        return 1;
+    }
+    MPI_Bcast(h, (int)sizeof(*h), MPI_BYTE, 0, comm);
+    MPI_Bcast(fr, (int)sizeof(*fr), MPI_BYTE, 0, comm);
+
+    long long b_lo = s / 8, b_hi = (e + 7) / 8;
+    uint64_t *buf = (uint64_t *)calloc((size_t)((b_hi - b_lo) / 8 + 2), sizeof(uint64_t));
+    rc = (buf == NULL);
+    MPI_Allreduce(MPI_IN_PLACE, &rc, 1, MPI_INT, MPI_MAX, comm);
+    if (rc == 0) {
+        MPI_Offset off = (MPI_Offset)(sizeof(*h) + (h->frames - 1) * frame + sizeof(*fr));
+        MPI_File_read_at_all(fh, off + b_lo, buf, (int)(b_hi - b_lo), MPI_BYTE, MPI_STATUS_IGNORE);
+        ca_bits_copy(seg, 0, buf, s - b_lo * 8, e - s);
+    }
+    free(buf);
+    MPI_File_close(&fh);
+    return rc;
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef CA_SWEEP_H
+#define CA_SWEEP_H
+// Barrido de parámetros (modo sweep del programa MPI): un archivo de trabajos
+// con "N densidad iteraciones semilla" por línea ('#' inicia un comentario).
+// Cada trabajo recibe un ancho: la mayor potencia de dos de procesos (hasta
+// size) que deja a cada uno al menos `cells` celdas y un halo completo. Los
+// trabajos se ordenan por ancho y, dentro de cada ancho, de más a menos
+// trabajo (N * iteraciones), para que los largos no queden para el final.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    long long N;
+    double density;
+    int iterations;
+    long long seed;
+    int id;         // orden en el archivo (columna Trabajo del CSV)
+    int width;      // procesos asignados
+} ca_sweep_job_t;
+
+// Lee los trabajos en *jobs (malloc). Devuelve cuántos hay, o -1 con el error
+// en stderr.
+static inline int ca_sweep_read(const char *path, ca_sweep_job_t **jobs) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Error: no se puede abrir el archivo de trabajos '%s'.\n", path);
+        return -1;
+    }
+    int n = 0, cap = 0, lineno = 0;
+    ca_sweep_job_t *v = NULL;
+    char line[512];
+    while (fgets(line, sizeof line, f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        ca_sweep_job_t j = { 0 };
+        char extra;
+        int got = sscanf(line, "%lld %lf %d %lld %c", &j.N, &j.density, &j.iterations, &j.seed, &extra);
+        if (got <= 0) {
+            continue;  // línea vacía o solo comentario
+        }
+        if (got != 4 || j.N <= 0 || j.iterations <= 0 || j.density < 0.0 || j.density > 1.0) {
+            fprintf(stderr, "Error: %s:%d: se esperaba 'N densidad iteraciones semilla' "
+                    "(N, iteraciones > 0; densidad entre 0 y 1).\n", path, lineno);
+            free(v);
+            fclose(f);
+            return -1;
+        }
+        if (n == cap) {
+            cap = cap ? 2 * cap : 64;
+            ca_sweep_job_t *nv = (ca_sweep_job_t *)realloc(v, cap * sizeof(ca_sweep_job_t));
+            if (!nv) {
+                fprintf(stderr, "Error de memoria.\n");
+                free(v);
+                fclose(f);
+                return -1;
+            }
+            v = nv;
+        }
+        j.id = n;
+        v[n++] = j;
+    }
+    fclose(f);
+    *jobs = v;
+    return n;
+}
+
+static inline int ca_sweep_width(long long N, int size, long long cells, int halo) {
+    int w = 1;
+    while (2LL * w <= size && N / (2 * w) >= cells && N / (2 * w) >= halo) {
+        w *= 2;
+    }
+    return w;
+}
+
+// Ancho descendente y, a igual ancho, trabajo descendente
+static inline int ca_sweep_cmp(const void *pa, const void *pb) {
+    const ca_sweep_job_t *a = (const ca_sweep_job_t *)pa, *b = (const ca_sweep_job_t *)pb;
+    if (a->width != b->width) {
+        return b->width - a->width;
+    }
+    double wa = (double)a->N * a->iterations, wb = (double)b->N * b->iterations;
+    return (wa < wb) - (wa > wb);
+}
+#endif
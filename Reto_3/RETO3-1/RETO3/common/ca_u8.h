@@ -0,0 +1,80 @@
+#ifndef CA_U8_H
+#define CA_U8_H
+// Kernel de un byte por celda (uint8_t con valores 0/1), sin ramas.
+// La regla 184 es una mezcla (blend): C' = C ? R : L, y un coche se mueve
+// si C & ~R. Con datos de 8 bits el compilador la traduce a comparaciones y
+// blends SIMD de 16/32/64 celdas por instrucción (la versión de cada nivel
+// de ISA se elige al arrancar, cpu_isa.h).
+#include <stdint.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "cpu_isa.h"
+
+// Los movimientos se cuentan en bloques de CA_U8_BLOCK celdas con un contador
+// de 16 bits: ensanchar cada byte a 64 bits costaría más que la propia regla.
+#define CA_U8_BLOCK 4096
+
+static inline CPU_ISA_INLINE long long ca_u8_rule_body(const uint8_t *restrict c, uint8_t *restrict n,
+                                                       long long lo, long long hi) {
+    long long moves = 0;
+    for (long long b = lo; b < hi; b += CA_U8_BLOCK) {
+        long long e = (hi - b < CA_U8_BLOCK) ? hi : b + CA_U8_BLOCK;
+        uint16_t m = 0;
+        #pragma omp simd reduction(+:m)
+        for (long long i = b; i < e; i++) {
+            uint8_t L = c[i - 1], C = c[i], R = c[i + 1];
+            n[i] = C ? R : L;
+            m += C & (uint8_t)(R ^ 1);
+        }
+        moves += m;
+    }
+    return moves;
+}
+// Una versión por nivel de ISA: 16 (SSE), 32 (AVX2) o 64 (AVX-512) celdas por instrucción
+CPU_ISA_CLONES(ca_u8_rule, long long, (const uint8_t *restrict c, uint8_t *restrict n, long long lo, long long hi),
+               (c, n, lo, hi))
+
+// Celdas [lo, hi) con vecinos leídos del propio arreglo (halos ya cargados).
+static inline long long ca_u8_rule(const uint8_t *restrict c, uint8_t *restrict n, long long lo, long long hi) {
+    return ca_u8_rule_isa[cpu_isa_level](c, n, lo, hi);
+}
+
+// Igual que ca_u8_rule pero repartiendo [lo, hi) en tramos contiguos entre
+// los hilos OpenMP (como schedule static), con reducción local de movimientos.
+static inline long long ca_u8_rule_omp(const uint8_t *restrict c, uint8_t *restrict n, long long lo, long long hi) {
+    long long moves = 0;
+    #pragma omp parallel reduction(+:moves)
+    {
+#ifdef _OPENMP
+        int t = omp_get_thread_num(), nt = omp_get_num_threads();
+#else
+        int t = 0, nt = 1;
+#endif
+        moves += ca_u8_rule(c, n, lo + (hi - lo) * t / nt, lo + (hi - lo) * (t + 1) / nt);
+    }
+    return moves;
+}
+
+// Tramo [a, b) de un anillo de N celdas sin celdas fantasma: el hilo dueño
+// de la celda 0 o de la N-1 resuelve el vecino periódico, así no hace falta
+// una pasada serial para actualizar halos.
+static inline long long ca_u8_ring_segment(const uint8_t *restrict c, uint8_t *restrict n,
+                                           long long N, long long a, long long b) {
+    long long moves = 0;
+    if (a >= b) return 0;
+    if (a == 0) {
+        uint8_t L = c[N - 1], C = c[0], R = c[1 % N];
+        n[0] = C ? R : L;
+        moves += C & (uint8_t)(R ^ 1);
+        a = 1;
+    }
+    if (b == N && N - 1 >= a) {
+        uint8_t L = c[N - 2], C = c[N - 1], R = c[0];
+        n[N - 1] = C ? R : L;
+        moves += C & (uint8_t)(R ^ 1);
+        b = N - 1;
+    }
+    return moves + ca_u8_rule(c, n, a, b);
+}
+#endif
@@ -25,6 +25,7 @@ set -e
 ROOT_DIR=$(pwd)
 SERIAL_DIR="${ROOT_DIR}/SERIAL"
 MPI_DIR="${ROOT_DIR}/MPI"
+COMMON="${COMMON:-${ROOT_DIR}/../../../common}"
 RESULTS_DIR="${ROOT_DIR}/profiling_results"
 
 mkdir -p "$RESULTS_DIR"
@@ -43,15 +44,15 @@ MPI_PROCS=4
 # ===============================================================
 
 echo "[*] Compilando versión SERIAL con -pg..."
-gcc -pg -O2 -Wall \
+gcc -pg -O2 -Wall -fopenmp -I"${COMMON}" \
     -o "${SERIAL_DIR}/cellular_autom_serial_prof" \
-    "${SERIAL_DIR}/cellular_autom_serial.c"
+    "${SERIAL_DIR}/cellular_autom_serial.c" "${COMMON}/bench.c" "${COMMON}/arena.c" -lm
 
 echo "[*] Compilando versión MPI con -pg..."
 if command -v mpicc >/dev/null 2>&1; then
-    mpicc -pg -O2 -Wall \
+    mpicc -pg -O2 -Wall -fopenmp -I"${COMMON}" \
         -o "${MPI_DIR}/cellular_autom_mpi_prof" \
-        "${MPI_DIR}/cellular_autom_mpi.c"
+        "${MPI_DIR}/cellular_autom_mpi.c" "${COMMON}/bench.c" "${COMMON}/arena.c" "${COMMON}/trace.c" -lm
 else
     echo "[ADVERTENCIA] MPI no disponible: no se compila la versión MPI"
 fi
@@ -0,0 +1,221 @@
+// arena.c — reservas en páginas de 2 MB reutilizables (ver arena.h).
+#define _GNU_SOURCE
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define HUGE_BYTES ((size_t)2 << 20)
+// Desplazamiento del bloque i dentro de su mapeo: (i % 16) * (4 KB + 64 B)
+#define COLOR_BYTES ((size_t)4096 + 64)
+#define COLORS 16
+
+enum { MODE_HUGE, MODE_THP, MODE_4K };
+enum { KIND_HEAP, KIND_HUGETLB, KIND_THP, KIND_4K };
+
+typedef struct {
+    void *p;            // base + color
+    void *base;         // inicio del mapeo (o de posix_memalign)
+    size_t cap;         // bytes utilizables desde p
+    size_t len;         // bytes mapeados desde base
+    int kind;
+    int used;
+} arena_block_t;
+
+static arena_block_t *blocks;
+static int nblocks, cap_blocks;
+static long reuses;
+static int mode = -1;
+
+static const char *const mode_names[] = { "huge", "thp", "4k" };
+
+static int arena_mode(void) {
+    if (mode >= 0) return mode;
+    const char *s = getenv("ARENA_PAGES");
+    mode = MODE_HUGE;
+    if (s && *s) {
+        if (strcmp(s, "thp") == 0) {
+            mode = MODE_THP;
+        } else if (strcmp(s, "4k") == 0) {
+            mode = MODE_4K;
+        } else if (strcmp(s, "huge") != 0) {
+            fprintf(stderr, "arena: ARENA_PAGES=%s desconocido (huge|thp|4k); se usa huge.\n", s);
+        }
+    }
+    return mode;
+}
+
+// Mapeo de len bytes (múltiplo de 2 MB) según el modo; NULL si falla.
+static void *map_block(size_t len, int *kind) {
+#ifdef MAP_HUGETLB
+    if (arena_mode() == MODE_HUGE) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+        flags |= MAP_HUGE_2MB;
+#endif
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED) {
+            *kind = KIND_HUGETLB;
+            return p;
+        }
+    }
+#endif
+    // Alineado a 2 MB para que THP pueda cubrirlo entero: se mapea de más y
+    // se recortan los extremos
+    size_t over = len + HUGE_BYTES;
+    char *raw = (char *)mmap(NULL, over, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return NULL;
+    char *p = (char *)(((uintptr_t)raw + HUGE_BYTES - 1) & ~(uintptr_t)(HUGE_BYTES - 1));
+    if (p > raw) munmap(raw, (size_t)(p - raw));
+    if (raw + over > p + len) munmap(p + len, (size_t)(raw + over - (p + len)));
+#ifdef MADV_HUGEPAGE
+    madvise(p, len, arena_mode() == MODE_4K ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+#endif
+    *kind = (arena_mode() == MODE_4K) ? KIND_4K : KIND_THP;
+    return p;
+}
+
+// Bloque nuevo; fresh = 1 si la memoria viene del kernel (ya en cero).
+static void *new_block(size_t bytes, int *fresh) {
+    if (nblocks == cap_blocks) {
+        int ncap = cap_blocks ? 2 * cap_blocks : 16;
+        arena_block_t *nb = (arena_block_t *)realloc(blocks, (size_t)ncap * sizeof *nb);
+        if (!nb) return NULL;
+        blocks = nb;
+        cap_blocks = ncap;
+    }
+    arena_block_t *b = &blocks[nblocks];
+    if (bytes < ARENA_MIN_BYTES) {
+        b->cap = b->len = (bytes + 63) & ~(size_t)63;
+        if (posix_memalign(&b->base, 64, b->cap)) return NULL;
+        b->p = b->base;
+        b->kind = KIND_HEAP;
+        *fresh = 0;
+    } else {
+        // Con páginas de 2 MB los bloques empiezan en la misma posición física
+        // módulo 2 MB y A[i], B[i] caerían en el mismo conjunto de L1/L2 (y en
+        // el mismo desplazamiento de 4 KB); cada bloque se desplaza distinto
+        size_t color = (size_t)(nblocks % COLORS) * COLOR_BYTES;
+        b->len = (bytes + color + HUGE_BYTES - 1) & ~(HUGE_BYTES - 1);
+        b->base = map_block(b->len, &b->kind);
+        if (!b->base) return NULL;
+        b->p = (char *)b->base + color;
+        b->cap = b->len - color;
+        *fresh = 1;
+    }
+    b->used = 1;
+    nblocks++;
+    return b->p;
+}
+
+static void *arena_get(size_t bytes, int *fresh) {
+    if (bytes == 0) bytes = 1;
+    // El bloque libre más chico donde quepa, sin desperdiciar más de la mitad
+    int best = -1;
+    for (int i = 0; i < nblocks; i++) {
+        arena_block_t *b = &blocks[i];
+        if (b->used || b->cap < bytes || b->cap - bytes > b->cap / 2) continue;
+        if (best < 0 || b->cap < blocks[best].cap) best = i;
+    }
+    if (best >= 0) {
+        blocks[best].used = 1;
+        reuses++;
+        *fresh = 0;
+        return blocks[best].p;
+    }
+    return new_block(bytes, fresh);
+}
+
+void *arena_alloc(size_t bytes) {
+    int fresh;
+    return arena_get(bytes, &fresh);
+}
+
+void *arena_calloc(size_t n, size_t size) {
+    if (size != 0 && n > SIZE_MAX / size) return NULL;
+    int fresh;
+    void *p = arena_get(n * size, &fresh);
+    if (p && !fresh) memset(p, 0, n * size);
+    return p;
+}
+
+void arena_free(void *p) {
+    if (!p) return;
+    for (int i = 0; i < nblocks; i++) {
+        if (blocks[i].p == p) {
+            blocks[i].used = 0;
+            return;
+        }
+    }
+    fprintf(stderr, "arena: arena_free de un puntero que no es del arena (%p).\n", p);
+}
+
+// Bytes respaldados por THP en los mapeos que tocan algún bloque THP.
+static size_t thp_bytes(void) {
+    FILE *f = fopen("/proc/self/smaps", "r");
+    if (!f) return 0;
+    char line[512];
+    size_t total = 0;
+    int inside = 0;
+    while (fgets(line, sizeof line, f)) {
+        unsigned long lo, hi;
+        size_t kb;
+        if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2 && strchr(line, '-') < strchr(line, ' ')) {
+            inside = 0;
+            for (int i = 0; i < nblocks; i++) {
+                uintptr_t p = (uintptr_t)blocks[i].base;
+                if (blocks[i].kind == KIND_THP && p < hi && p + blocks[i].len > lo) {
+                    inside = 1;
+                    break;
+                }
+            }
+        } else if (inside && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            total += kb << 10;
+        }
+    }
+    fclose(f);
+    return total;
+}
+
+void arena_report(const char *who) {
+    // Solo los bloques grandes (mapeos propios) tienen tipo de página
+    size_t mapped = 0, hugetlb = 0;
+    int large = 0;
+    for (int i = 0; i < nblocks; i++) {
+        if (blocks[i].kind == KIND_HEAP) continue;
+        large++;
+        mapped += blocks[i].len;
+        if (blocks[i].kind == KIND_HUGETLB) hugetlb += blocks[i].len;
+    }
+    if (mapped == 0) return;
+    size_t thp = thp_bytes();
+    if (thp > mapped - hugetlb) thp = mapped - hugetlb;
+    size_t small = mapped - hugetlb - thp;
+    // Página obtenida: la que respalda la mayor parte de lo mapeado
+    const char *got = "4k";
+    if (hugetlb >= thp && hugetlb >= small) {
+        got = "hugetlb";
+    } else if (thp >= small) {
+        got = "thp";
+    }
+    const double mb = 1.0 / (1 << 20);
+    fprintf(stderr, "arena[%s]: pages=%s asked=%s blocks=%d mapped_mb=%.1f hugetlb_mb=%.1f thp_mb=%.1f small_mb=%.1f reuses=%ld\n",
+            who, got, mode_names[arena_mode()], large, mapped * mb, hugetlb * mb, thp * mb, small * mb, reuses);
+}
+
+void arena_release(void) {
+    for (int i = 0; i < nblocks; i++) {
+        if (blocks[i].kind == KIND_HEAP) {
+            free(blocks[i].base);
+        } else {
+            munmap(blocks[i].base, blocks[i].len);
+        }
+    }
+    free(blocks);
+    blocks = NULL;
+    nblocks = cap_blocks = 0;
+    reuses = 0;
+}
@@ -0,0 +1,57 @@
+#ifndef ARENA_H
+#define ARENA_H
+// Reservas grandes en páginas de 2 MB, alineadas a 64 B y reutilizables.
+//
+// Con páginas de 4 KB una matriz de 4096^2 doubles ocupa 32768 páginas y el
+// producto se pasa buena parte del tiempo en fallos de dTLB; con páginas de
+// 2 MB son 64. Cada bloque de al menos ARENA_MIN_BYTES se mapea aparte:
+//   1. mmap(MAP_HUGETLB | MAP_HUGE_2MB) si el sistema tiene páginas reservadas
+//      (vm.nr_hugepages);
+//   2. si no, un mapeo anónimo alineado a 2 MB con madvise(MADV_HUGEPAGE)
+//      para que el kernel use páginas grandes transparentes (THP);
+// los bloques más pequeños salen de posix_memalign. Cada bloque grande empieza
+// desplazado (i % 16) * (4 KB + 64 B) dentro de su mapeo: si no, dos matrices
+// alineadas a 2 MB comparten conjuntos de caché elemento a elemento y el
+// producto o el paso del autómata pierden más de lo que ganan en TLB.
+//
+//   double *A = arena_alloc(n * n * sizeof(double));
+//   ...
+//   arena_free(A);       // vuelve al arena, no al sistema
+//   arena_report("mm");  // arena[mm]: pages=thp asked=huge ... (stderr)
+//   arena_release();     // devuelve todo al sistema
+//
+// arena_free no desmapea: la siguiente arena_alloc de un tamaño que quepa
+// reutiliza el bloque (ya con las páginas tocadas y en la TLB), así que las
+// repeticiones de bench.h o las corridas de un barrido no vuelven a pagar el
+// mmap ni los fallos de página. No es seguro entre hilos: reservar y liberar
+// fuera de las regiones paralelas.
+//
+// Variables de entorno:
+//   ARENA_PAGES  huge (por defecto: hugetlb y si no THP) | thp | 4k (mapeos
+//                con MADV_NOHUGEPAGE: la línea base para comparar fallos de
+//                dTLB con PERF_CSV, perf_region.h)
+// Compilar con -I<raíz>/common <raíz>/common/arena.c.
+
+#include <stddef.h>
+
+#define ARENA_MIN_BYTES ((size_t)1 << 20)
+
+// NULL si no hay memoria. Alineado a 64 B.
+void *arena_alloc(size_t bytes);
+
+// arena_alloc con el bloque en cero.
+void *arena_calloc(size_t n, size_t size);
+
+// Devuelve el bloque al arena para reutilizarlo (p = NULL no hace nada).
+void arena_free(void *p);
+
+// Resumen por stderr de los bloques grandes: página obtenida (hugetlb, thp o
+// 4k: la que respalda la mayor parte; asked = la pedida en ARENA_PAGES),
+// bytes mapeados, bytes que el kernel respalda con páginas de 2 MB
+// (AnonHugePages de /proc/self/smaps) y reservas servidas reutilizando un
+// bloque. Sin bloques grandes no imprime nada.
+void arena_report(const char *who);
+
+// Desmapea todos los bloques (los punteros dejan de ser válidos).
+void arena_release(void);
+#endif
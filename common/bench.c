@@ -0,0 +1,162 @@
+// bench.c — implementación del arnés de medición (ver bench.h).
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static int env_int(const char *name, int def, int min) {
+    const char *v = getenv(name);
+    if (!v || !*v) return def;
+    int x = atoi(v);
+    return x < min ? min : x;
+}
+
+void bench_init(bench_t *b, const char *prog, const char *params_fmt, ...) {
+    memset(b, 0, sizeof *b);
+    snprintf(b->prog, sizeof b->prog, "%s", prog);
+    va_list ap;
+    va_start(ap, params_fmt);
+    vsnprintf(b->params, sizeof b->params, params_fmt, ap);
+    va_end(ap);
+    for (char *c = b->params; *c; c++) {
+        if (*c == ',') *c = ';';
+    }
+    b->warmup = env_int("BENCH_WARMUP", 0, 0);
+    b->reps = env_int("BENCH_REPS", 1, 1);
+    b->iter = -1;
+}
+
+int bench_next(bench_t *b) {
+    if (!b->samples) {
+        b->samples = (double *)malloc((size_t)b->reps * sizeof(double));
+        if (!b->samples) {
+            fprintf(stderr, "bench: error de memoria.\n");
+            return 0;
+        }
+    }
+    return ++b->iter < b->warmup + b->reps;
+}
+
+int bench_warming(const bench_t *b) {
+    return b->iter < b->warmup;
+}
+
+void bench_add(bench_t *b, double secs) {
+    if (bench_warming(b) || b->n >= b->reps) return;
+    b->samples[b->n++] = secs;
+}
+
+static int cmp_double(const void *pa, const void *pb) {
+    double a = *(const double *)pa, c = *(const double *)pb;
+    return (a > c) - (a < c);
+}
+
+// t de Student bilateral al 95% para gl = 1..30; con más, la normal.
+static double t95(int df) {
+    static const double t[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+    };
+    return df <= 0 ? 0.0 : df <= 30 ? t[df - 1] : 1.960;
+}
+
+void bench_stats(const bench_t *b, bench_stats_t *s) {
+    memset(s, 0, sizeof *s);
+    s->n = b->n;
+    if (b->n == 0) return;
+
+    double *v = (double *)malloc((size_t)b->n * sizeof(double));
+    if (!v) return;
+    memcpy(v, b->samples, (size_t)b->n * sizeof(double));
+    qsort(v, b->n, sizeof(double), cmp_double);
+    s->min = v[0];
+    s->max = v[b->n - 1];
+    s->median = (b->n % 2) ? v[b->n / 2] : 0.5 * (v[b->n / 2 - 1] + v[b->n / 2]);
+    free(v);
+
+    double sum = 0.0;
+    for (int i = 0; i < b->n; i++) sum += b->samples[i];
+    s->mean = sum / b->n;
+    double ss = 0.0;
+    for (int i = 0; i < b->n; i++) ss += (b->samples[i] - s->mean) * (b->samples[i] - s->mean);
+    s->stddev = b->n > 1 ? sqrt(ss / (b->n - 1)) : 0.0;
+    double half = t95(b->n - 1) * s->stddev / sqrt((double)b->n);
+    s->ci95_lo = s->mean - half;
+    s->ci95_hi = s->mean + half;
+}
+
+double bench_median(const bench_t *b) {
+    bench_stats_t s;
+    bench_stats(b, &s);
+    return s.median;
+}
+
+void bench_report(const bench_t *b, double work, const char *unit) {
+    bench_stats_t s;
+    bench_stats(b, &s);
+    double rate = s.median > 0.0 ? work / s.median : 0.0;
+
+    const char *path = getenv("BENCH_CSV");
+    if (path && *path) {
+        FILE *f = fopen(path, "a");
+        if (!f) {
+            fprintf(stderr, "bench: no se puede abrir BENCH_CSV='%s'.\n", path);
+        } else {
+            if (ftell(f) == 0) {
+                fprintf(f, "prog,host,params,warmup,reps,median_s,min_s,max_s,mean_s,stddev_s,"
+                           "ci95_lo_s,ci95_hi_s,work,unit,rate\n");
+            }
+            char host[64] = "desconocido";
+            gethostname(host, sizeof host);
+            host[sizeof host - 1] = '\0';
+            fprintf(f, "%s,%s,%s,%d,%d,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.9f,%.6g,%s,%.6g\n", b->prog, host,
+                    b->params, b->warmup, s.n, s.median, s.min, s.max, s.mean, s.stddev, s.ci95_lo, s.ci95_hi,
+                    work, unit, rate);
+            fclose(f);
+        }
+    }
+
+    if (b->warmup > 0 || b->reps > 1) {
+        fprintf(stderr, "[bench] %s %s: mediana=%.6f s min=%.6f s desv=%.6f s IC95=[%.6f, %.6f] s (%d+%d rep)\n",
+                b->prog, b->params, s.median, s.min, s.stddev, s.ci95_lo, s.ci95_hi, b->warmup, s.n);
+    }
+}
+
+void bench_roofline(const bench_t *b, const char *op, double ops, double bytes) {
+    const char *path = getenv("ROOFLINE_CSV");
+    if (!path || !*path) return;
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        fprintf(stderr, "bench: no se puede abrir ROOFLINE_CSV='%s'.\n", path);
+        return;
+    }
+    if (ftell(f) == 0) {
+        fprintf(f, "prog,host,params,op,ops,bytes,ai,median_s,gops_s,gb_s\n");
+    }
+    char host[64] = "desconocido";
+    gethostname(host, sizeof host);
+    host[sizeof host - 1] = '\0';
+    double secs = bench_median(b);
+    fprintf(f, "%s,%s,%s,%s,%.6g,%.6g,", b->prog, host, b->params, op, ops, bytes);
+    if (bytes > 0.0) fprintf(f, "%.6g", ops / bytes);
+    fprintf(f, ",%.9f,%.6g,%.6g\n", secs, secs > 0.0 ? ops / secs / 1e9 : 0.0, secs > 0.0 ? bytes / secs / 1e9 : 0.0);
+    fclose(f);
+}
+
+void bench_free(bench_t *b) {
+    free(b->samples);
+    b->samples = NULL;
+}
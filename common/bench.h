@@ -0,0 +1,84 @@
+#ifndef BENCH_H
+#define BENCH_H
+// Arnés de medición común a los programas del repositorio (CE2, CU3, Reto_1,
+// Reto_2 y Reto_3). Mide solo el núcleo, dentro del proceso: el arranque, el
+// llenado aleatorio o la transpuesta quedan fuera de las muestras.
+//
+//   bench_t b;
+//   bench_init(&b, "mm_openmp_bt", "n=%zu;threads=%d", n, threads);
+//   while (bench_next(&b)) {
+//       double t0 = bench_now();
+//       nucleo();
+//       bench_add(&b, bench_now() - t0);
+//   }
+//   bench_report(&b, 2.0 * n * n * n, "flop");
+//   bench_free(&b);
+//
+// Variables de entorno:
+//   BENCH_WARMUP  repeticiones de calentamiento, sin medir (0 por defecto)
+//   BENCH_REPS    repeticiones medidas (1 por defecto: el comportamiento de siempre)
+//   BENCH_CSV     archivo al que bench_report añade una fila (con encabezado si
+//                 es nuevo). Esquema único para todos los programas:
+//                 prog,host,params,warmup,reps,median_s,min_s,max_s,mean_s,
+//                 stddev_s,ci95_lo_s,ci95_hi_s,work,unit,rate
+//                 donde rate = work / median_s (unidades de trabajo por segundo).
+//
+//   ROOFLINE_CSV  archivo al que bench_roofline añade las coordenadas de la
+//                 corrida en el modelo roofline (ver roofline.c):
+//                 prog,host,params,op,ops,bytes,ai,median_s,gops_s,gb_s
+//                 ai = ops / bytes (vacío si el núcleo no toca memoria).
+//
+// Con MPI cada rank llama a bench_next (rank 0 difunde warmup y reps) y solo
+// rank 0 agrega la muestra y llama a bench_report. La muestra es el tiempo del
+// rank más lento: los programas reducen su tiempo con MPI_MAX antes de
+// bench_add, o cierran la repetición con una barrera (mm_mpi.c, sp_mpi.c).
+// Compilar con -I<raíz>/common <raíz>/common/bench.c -lm.
+
+typedef struct {
+    char prog[64];
+    char params[256];   // "clave=valor;clave=valor" (sin comas, por el CSV)
+    int warmup;
+    int reps;
+    int iter;           // repetición en curso (0 .. warmup + reps - 1)
+    int n;              // muestras registradas
+    double *samples;    // segundos
+} bench_t;
+
+typedef struct {
+    int n;
+    double median, min, max, mean, stddev;
+    double ci95_lo, ci95_hi;    // intervalo de confianza del 95% de la media (t de Student)
+} bench_stats_t;
+
+double bench_now(void);
+
+// Lee BENCH_WARMUP y BENCH_REPS; params con formato printf.
+void bench_init(bench_t *b, const char *prog, const char *params_fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+// Avanza a la siguiente repetición; 0 cuando ya no quedan.
+int bench_next(bench_t *b);
+
+// 1 si la repetición en curso es de calentamiento (bench_add la descarta).
+int bench_warming(const bench_t *b);
+
+// Registra la duración de la repetición en curso.
+void bench_add(bench_t *b, double secs);
+
+void bench_stats(const bench_t *b, bench_stats_t *s);
+
+// Mediana de las muestras (0 si no hay): el tiempo que imprime cada programa.
+double bench_median(const bench_t *b);
+
+// Fila CSV en BENCH_CSV y, si hubo más de una repetición o calentamiento, un
+// resumen por stderr. work: trabajo de una repetición en la unidad unit
+// ("flop", "samples", "cell_updates", ...).
+void bench_report(const bench_t *b, double work, const char *unit);
+
+// Fila en ROOFLINE_CSV con el trabajo y el tráfico de una repetición según
+// el modelo de cada núcleo: ops operaciones del tipo op ("flop" o "intop",
+// las operaciones enteras de los autómatas) y bytes entre memoria y núcleo.
+void bench_roofline(const bench_t *b, const char *op, double ops, double bytes);
+
+void bench_free(bench_t *b);
+#endif
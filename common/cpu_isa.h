@@ -0,0 +1,111 @@
+#ifndef CPU_ISA_H
+#define CPU_ISA_H
+// Despacho de núcleos según el conjunto de instrucciones de la CPU en tiempo
+// de ejecución. Un solo binario, compilado sin -march=native, lleva una
+// versión de cada núcleo por nivel (x86-64 base, SSE4.2, AVX2 y AVX-512) y
+// elige al arrancar la mayor que la CPU soporte (CPUID). Así el mismo
+// ejecutable corre en todos los nodos, cada uno a su velocidad nativa.
+//
+//   // Cuerpo del núcleo: sin atributos, siempre en línea
+//   static inline CPU_ISA_INLINE void fila_body(const double *a, double *c, size_t n) { ... }
+//   CPU_ISA_CLONES(fila, void, (const double *a, double *c, size_t n), (a, c, n))
+//   ...
+//   fila_isa[cpu_isa_level](a, c, n);
+//
+// CPU_ISA_CLONES genera fila_generic, fila_sse42, fila_avx2 y fila_avx512:
+// cada una compila el mismo cuerpo con sus extensiones habilitadas (target),
+// y la tabla fila_isa[] las indexa por nivel. Como la tabla de reglas de
+// ca_rules.h, el nivel se resuelve una vez (antes de main) y nunca por celda.
+//
+// Variables de entorno:
+//   CPU_ISA  fuerza un nivel: generic | sse4.2 | avx2 | avx512 | native (por
+//            defecto). Un nivel que la CPU no tenga se rebaja al detectado con
+//            un aviso por stderr.
+// Fuera de x86-64 (o sin GCC/Clang) todas las versiones son la genérica.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+    CPU_ISA_GENERIC,    // x86-64 base (SSE2)
+    CPU_ISA_SSE42,      // + SSE4.2 y POPCNT
+    CPU_ISA_AVX2,       // + AVX2, FMA, BMI2 (x86-64-v3)
+    CPU_ISA_AVX512,     // + AVX-512 F/BW/DQ/VL (x86-64-v4)
+    CPU_ISA_COUNT
+} cpu_isa_t;
+
+static const char *const cpu_isa_names[CPU_ISA_COUNT] = { "generic", "sse4.2", "avx2", "avx512" };
+
+#define CPU_ISA_INLINE __attribute__((always_inline))
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CPU_ISA_TARGET_SSE42  __attribute__((target("sse4.2,popcnt")))
+#define CPU_ISA_TARGET_AVX2   __attribute__((target("avx2,fma,bmi,bmi2,popcnt")))
+#define CPU_ISA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,avx2,fma,bmi,bmi2,popcnt")))
+#else
+#define CPU_ISA_TARGET_SSE42
+#define CPU_ISA_TARGET_AVX2
+#define CPU_ISA_TARGET_AVX512
+#endif
+
+// El cuerpo name##_body no lleva target: GCC lo puede expandir en cada versión
+// porque sus extensiones son un subconjunto de las de quien lo llama.
+#define CPU_ISA_CLONES(name, ret, params, args)                                     \
+    static ret name##_generic params { return name##_body args; }                   \
+    CPU_ISA_TARGET_SSE42 static ret name##_sse42 params { return name##_body args; } \
+    CPU_ISA_TARGET_AVX2 static ret name##_avx2 params { return name##_body args; }   \
+    CPU_ISA_TARGET_AVX512 static ret name##_avx512 params { return name##_body args; } \
+    static ret (*const name##_isa[CPU_ISA_COUNT]) params = {                        \
+        name##_generic, name##_sse42, name##_avx2, name##_avx512 };
+
+// Mayor nivel soportado por la CPU.
+static inline cpu_isa_t cpu_isa_detect(void) {
+#if defined(__x86_64__) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl") &&
+        __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+        __builtin_cpu_supports("bmi2")) {
+        return CPU_ISA_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("bmi2")) {
+        return CPU_ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+        return CPU_ISA_SSE42;
+    }
+#endif
+    return CPU_ISA_GENERIC;
+}
+
+// Nivel detectado, limitado por CPU_ISA.
+static inline cpu_isa_t cpu_isa_select(void) {
+    cpu_isa_t hw = cpu_isa_detect();
+    const char *s = getenv("CPU_ISA");
+    if (!s || !*s || strcmp(s, "native") == 0) return hw;
+    for (int i = 0; i < CPU_ISA_COUNT; i++) {
+        if (strcmp(s, cpu_isa_names[i]) != 0) continue;
+        if ((cpu_isa_t)i > hw) {
+            fprintf(stderr, "cpu_isa: esta CPU no soporta %s; se usa %s.\n", s, cpu_isa_names[hw]);
+            return hw;
+        }
+        return (cpu_isa_t)i;
+    }
+    fprintf(stderr, "cpu_isa: CPU_ISA=%s desconocido (generic|sse4.2|avx2|avx512|native); se usa %s.\n",
+            s, cpu_isa_names[hw]);
+    return hw;
+}
+
+// Nivel en uso en esta unidad de compilación, fijado antes de main (un solo
+// hilo, sin carreras al leerlo después desde regiones paralelas).
+static cpu_isa_t cpu_isa_level;
+
+__attribute__((constructor)) static void cpu_isa_init(void) {
+    cpu_isa_level = cpu_isa_select();
+}
+
+static inline const char *cpu_isa_name(void) {
+    return cpu_isa_names[cpu_isa_level];
+}
+#endif
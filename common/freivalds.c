@@ -0,0 +1,96 @@
+// freivalds.c — verificación probabilística de productos de matrices (ver freivalds.h).
+#include "freivalds.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int freivalds_trials(void) {
+    const char *s = getenv("VERIFY_TRIALS");
+    if (!s || !*s) return 2;
+    int t = atoi(s);
+    return t < 0 ? 0 : t;
+}
+
+static unsigned long long splitmix64(unsigned long long *s) {
+    unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// y = M x (o |M| x si absval)
+static void matvec(const double *M, const double *x, double *y, size_t n, int absval) {
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < n; i++) {
+        const double *Mi = &M[i * n];
+        double s = 0.0;
+        if (absval) {
+            for (size_t j = 0; j < n; j++) s += fabs(Mi[j]) * x[j];
+        } else {
+            for (size_t j = 0; j < n; j++) s += Mi[j] * x[j];
+        }
+        y[i] = s;
+    }
+}
+
+int freivalds_check(const double *A, const double *B, const double *C, size_t n,
+                    int trials, unsigned long long seed, freivalds_t *v) {
+    memset(v, 0, sizeof *v);
+    v->ok = 1;
+    if (trials <= 0 || n == 0) return 1;
+
+    double *x = (double *)malloc(n * sizeof(double));
+    double *y = (double *)malloc(n * sizeof(double));
+    double *ab = (double *)malloc(n * sizeof(double));
+    double *cx = (double *)malloc(n * sizeof(double));
+    double *mag = (double *)malloc(n * sizeof(double));
+    if (!x || !y || !ab || !cx || !mag) {
+        fprintf(stderr, "freivalds: error de memoria (n=%zu).\n", n);
+        free(x); free(y); free(ab); free(cx); free(mag);
+        v->ok = 0;
+        return 0;
+    }
+
+    // Escala de cada fila: |A| (|B| 1), la misma para todo x de ±1
+    for (size_t j = 0; j < n; j++) x[j] = 1.0;
+    matvec(B, x, y, n, 1);
+    matvec(A, y, mag, n, 1);
+    const double tol = 4.0 * ((double)n + 2.0) * DBL_EPSILON;
+
+    for (int t = 0; t < trials && v->ok; t++) {
+        v->trials++;
+        for (size_t j = 0; j < n; j++) x[j] = (splitmix64(&seed) >> 63) ? 1.0 : -1.0;
+        matvec(B, x, y, n, 0);
+        matvec(A, y, ab, n, 0);
+        matvec(C, x, cx, n, 0);
+        for (size_t i = 0; i < n; i++) {
+            double d = fabs(ab[i] - cx[i]);
+            double rel = mag[i] > 0.0 ? d / mag[i] : d;
+            if (rel > v->max_rel || rel != rel) v->max_rel = rel;
+            // !(<=) también atrapa NaN
+            if (v->ok && !(rel <= tol)) {
+                v->ok = 0;
+                v->bad_row = i;
+            }
+        }
+    }
+
+    free(x); free(y); free(ab); free(cx); free(mag);
+    return v->ok;
+}
+
+void freivalds_print(const freivalds_t *v) {
+    if (v->trials == 0) {
+        fprintf(stderr, "verify=off\n");
+    } else if (v->ok) {
+        fprintf(stderr, "verify=ok trials=%d max_rel=%.3g\n", v->trials, v->max_rel);
+    } else {
+        fprintf(stderr, "verify=FALLO trials=%d fila=%zu max_rel=%.3g\n",
+                v->trials, v->bad_row, v->max_rel);
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef FREIVALDS_H
+#define FREIVALDS_H
+// Verificación probabilística de C = A·B (Freivalds) en O(n^2) por prueba:
+// con x aleatorio de ±1 compara A(Bx) con Cx. Un C incorrecto pasa una prueba
+// con probabilidad <= 1/2 (en la práctica, casi nunca), así que con unas pocas
+// pruebas se puede dejar activa en los benchmarks a n = 8192 sin calcular una
+// referencia O(n^3).
+//
+//   freivalds_t v;
+//   if (!freivalds_check(A, B, C, n, freivalds_trials(), 42, &v)) ...
+//   freivalds_print(&v);     // verify=ok trials=2 max_rel=1.2e-17 (stderr)
+//
+// Las matrices son n x n en orden por filas y B es la original (no la
+// transpuesta): se comprueba el producto que el programa dice calcular.
+// Tolerancia por fila: 4 (n + 2) eps (|A| (|B| 1))_i, la cota del error de
+// redondeo de la suma en cualquier orden (también con -ffast-math o FMA);
+// un índice equivocado produce diferencias de orden (|A| |B| 1)_i.
+//
+// Variables de entorno:
+//   VERIFY_TRIALS  pruebas por verificación (2 por defecto; 0 la desactiva)
+// Compilar con -I<raíz>/common <raíz>/common/freivalds.c (con -fopenmp los
+// productos matriz-vector se reparten entre hilos).
+
+#include <stddef.h>
+
+typedef struct {
+    int trials;         // pruebas hechas (0: verificación desactivada)
+    int ok;
+    size_t bad_row;     // primera fila fuera de tolerancia (si !ok)
+    double max_rel;     // max_i |A(Bx) - Cx|_i / (|A| (|B| 1))_i
+} freivalds_t;
+
+// Lee VERIFY_TRIALS.
+int freivalds_trials(void);
+
+// 1 si C = A·B en las trials pruebas (o si trials <= 0); 0 si falla o si no
+// hay memoria para los vectores. seed fija los vectores aleatorios.
+int freivalds_check(const double *A, const double *B, const double *C, size_t n,
+                    int trials, unsigned long long seed, freivalds_t *v);
+
+// Resultado por stderr, en el formato clave=valor del checksum.
+void freivalds_print(const freivalds_t *v);
+#endif
@@ -0,0 +1,202 @@
+// perf_region.c — contadores de hardware por región (ver perf_region.h).
+#define _GNU_SOURCE
+#include "perf_region.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+static double perf_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+#ifdef __linux__
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} perf_events[PERF_NEV] = {
+    [PERF_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_LLC_REFS] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                (PERF_COUNT_HW_CACHE_RESULT_ACCESS << 16) },
+    [PERF_LLC_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    [PERF_DTLB_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    [PERF_TASK_CLOCK] = { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+};
+
+// Contador del hilo que llama (pid = 0, cualquier CPU), solo espacio de
+// usuario, activo desde que se abre: begin/end leen y restan.
+static int perf_open(int e) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof a);
+    a.size = sizeof a;
+    a.type = perf_events[e].type;
+    a.config = perf_events[e].config;
+    a.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+}
+
+static int perf_read(int fd, uint64_t out[3]) {
+    return read(fd, out, 3 * sizeof(uint64_t)) == (ssize_t)(3 * sizeof(uint64_t)) ? 0 : -1;
+}
+#else
+static int perf_open(int e) {
+    (void)e;
+    return -1;
+}
+
+static int perf_read(int fd, uint64_t out[3]) {
+    (void)fd;
+    (void)out;
+    return -1;
+}
+#endif
+
+int perf_region_init(perf_region_t *r, const char *name, int nthreads) {
+    memset(r, 0, sizeof *r);
+    snprintf(r->name, sizeof r->name, "%s", name);
+    const char *csv = getenv("PERF_CSV");
+    r->enabled = csv && *csv;
+    r->nthreads = nthreads < 1 ? 1 : nthreads;
+    r->t = (perf_thread_t *)calloc((size_t)r->nthreads, sizeof(perf_thread_t));
+    if (!r->t) {
+        fprintf(stderr, "perf_region: error de memoria.\n");
+        return -1;
+    }
+    for (int i = 0; i < r->nthreads; i++) {
+        for (int e = 0; e < PERF_NEV; e++) r->t[i].fd[e] = -1;
+    }
+    return 0;
+}
+
+void perf_region_begin(perf_region_t *r, int tid) {
+    if (!r || !r->t || tid < 0 || tid >= r->nthreads) return;
+    perf_thread_t *t = &r->t[tid];
+    if (r->enabled && !t->opened) {
+        for (int e = 0; e < PERF_NEV; e++) t->fd[e] = perf_open(e);
+        t->opened = 1;
+    }
+    for (int e = 0; e < PERF_NEV; e++) {
+        if (t->fd[e] >= 0 && perf_read(t->fd[e], t->b[e])) {
+            close(t->fd[e]);
+            t->fd[e] = -1;
+        }
+    }
+    t->t0 = perf_now();
+}
+
+void perf_region_end(perf_region_t *r, int tid) {
+    if (!r || !r->t || tid < 0 || tid >= r->nthreads) return;
+    perf_thread_t *t = &r->t[tid];
+    t->secs += perf_now() - t->t0;
+    t->calls++;
+    for (int e = 0; e < PERF_NEV; e++) {
+        uint64_t x[3];
+        if (t->fd[e] < 0 || perf_read(t->fd[e], x)) continue;
+        // Con multiplexación el evento solo estuvo activo parte del tramo
+        double en = (double)(x[1] - t->b[e][1]), run = (double)(x[2] - t->b[e][2]);
+        double d = (double)(x[0] - t->b[e][0]);
+        t->v[e] += (uint64_t)(run > 0.0 ? d * (en / run) : 0.0);
+    }
+}
+
+// Valor del evento o campo vacío si ningún hilo pudo abrirlo.
+static void put_count(FILE *f, int have, uint64_t v) {
+    if (have) fprintf(f, "%llu", (unsigned long long)v);
+    fputc(',', f);
+}
+
+static void put_row(FILE *f, const char *host, const char *impl, long long n, int threads, double secs, long rss_kb,
+                    const int have[PERF_NEV], const uint64_t v[PERF_NEV], double gflops, const char *region,
+                    int tid) {
+    fprintf(f, "%s,%s,%lld,%d,%.6f,", host, impl, n, threads, secs);
+    if (rss_kb > 0) fprintf(f, "%ld", rss_kb);
+    fputc(',', f);
+    if (have[PERF_CYCLES] && have[PERF_INSTRUCTIONS] && v[PERF_CYCLES] > 0) {
+        fprintf(f, "%.3f", (double)v[PERF_INSTRUCTIONS] / (double)v[PERF_CYCLES]);
+    }
+    fputc(',', f);
+    put_count(f, have[PERF_INSTRUCTIONS], v[PERF_INSTRUCTIONS]);
+    put_count(f, have[PERF_CYCLES], v[PERF_CYCLES]);
+    put_count(f, have[PERF_LLC_MISSES], v[PERF_LLC_MISSES]);
+    put_count(f, have[PERF_LLC_REFS], v[PERF_LLC_REFS]);
+    if (have[PERF_TASK_CLOCK]) fprintf(f, "%.2f", 1e-6 * (double)v[PERF_TASK_CLOCK]);
+    fputc(',', f);
+    if (gflops > 0.0) fprintf(f, "%.3f", gflops);
+    fprintf(f, ",%s", region);
+    if (tid >= 0) fprintf(f, "#%d", tid);
+    fputc(',', f);
+    if (have[PERF_DTLB_MISSES]) fprintf(f, "%llu", (unsigned long long)v[PERF_DTLB_MISSES]);
+    fputc('\n', f);
+}
+
+void perf_region_report(const perf_region_t *r, const char *impl, long long n, double flops) {
+    if (!r->enabled || !r->t) return;
+    const char *path = getenv("PERF_CSV");
+    FILE *f = fopen(path, "a");
+    if (!f) {
+        fprintf(stderr, "perf_region: no se puede abrir PERF_CSV='%s'.\n", path);
+        return;
+    }
+    if (ftell(f) == 0) {
+        fprintf(f, "host,impl,n,threads,elapsed_s,max_rss_kb,ipc,instructions,cycles,cache_misses,cache_refs,"
+                   "task_clock_ms,gflops,region,dtlb_misses\n");
+    }
+    char host[64] = "desconocido";
+    gethostname(host, sizeof host);
+    host[sizeof host - 1] = '\0';
+
+    int have_any[PERF_NEV] = { 0 }, active = 0;
+    uint64_t sum[PERF_NEV] = { 0 };
+    long calls = 0;
+    double slowest = 0.0;
+    for (int i = 0; i < r->nthreads; i++) {
+        const perf_thread_t *t = &r->t[i];
+        if (t->calls == 0) continue;
+        int have[PERF_NEV];
+        for (int e = 0; e < PERF_NEV; e++) {
+            have[e] = t->fd[e] >= 0;
+            have_any[e] |= have[e];
+            sum[e] += t->v[e];
+        }
+        put_row(f, host, impl, n, 1, t->secs, 0, have, t->v, 0.0, r->name, i);
+        active++;
+        if (t->secs > slowest) {
+            slowest = t->secs;
+            calls = t->calls;
+        }
+    }
+    struct rusage ru;
+    long rss_kb = getrusage(RUSAGE_SELF, &ru) == 0 ? ru.ru_maxrss : 0;
+    double gflops = (flops > 0.0 && slowest > 0.0) ? flops * (double)calls / slowest / 1e9 : 0.0;
+    put_row(f, host, impl, n, active, slowest, rss_kb, have_any, sum, gflops, r->name, -1);
+    fclose(f);
+
+    if (!have_any[PERF_CYCLES] && !have_any[PERF_INSTRUCTIONS]) {
+        fprintf(stderr, "[perf] %s: sin contadores de hardware (perf_event_open), solo tiempo.\n", r->name);
+    }
+}
+
+void perf_region_free(perf_region_t *r) {
+    if (!r->t) return;
+    for (int i = 0; i < r->nthreads; i++) {
+        for (int e = 0; e < PERF_NEV; e++) {
+            if (r->t[i].fd[e] >= 0) close(r->t[i].fd[e]);
+        }
+    }
+    free(r->t);
+    r->t = NULL;
+}
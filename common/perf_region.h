@@ -0,0 +1,80 @@
+#ifndef PERF_REGION_H
+#define PERF_REGION_H
+// Contadores de hardware por región y por hilo con perf_event_open (Linux).
+// A diferencia de `perf stat` sobre el binario completo, solo cuentan entre
+// perf_region_begin y perf_region_end: la reserva, el llenado aleatorio o la
+// transpuesta quedan fuera.
+//
+//   perf_region_t pr;
+//   perf_region_init(&pr, "mm_blocked", omp_get_max_threads());
+//   #pragma omp parallel
+//   {
+//       int tid = omp_get_thread_num();
+//       perf_region_begin(&pr, tid);
+//       #pragma omp for nowait
+//       ...
+//       perf_region_end(&pr, tid);
+//   }
+//   perf_region_report(&pr, "openmp_blocked", n, 2.0 * n * n * n);
+//   perf_region_free(&pr);
+//
+// Cada hilo abre sus propios contadores (pid = 0: solo el hilo que llama) la
+// primera vez que entra; los valores se escalan si el kernel multiplexa.
+// Eventos: ciclos, instrucciones, referencias y fallos de LLC, fallos de
+// dTLB (lectura) y task-clock. Un evento que no exista en la máquina queda
+// vacío en el CSV; si no se puede abrir ninguno (perf_event_paranoid, VM sin
+// PMU, otro SO) la región solo mide tiempo.
+//
+// Variables de entorno:
+//   PERF_CSV  archivo al que perf_region_report añade filas (con encabezado si
+//             es nuevo); sin ella las regiones no abren contadores y no
+//             informan nada. Columnas de profile_summary_all.csv más dos:
+//             host,impl,n,threads,elapsed_s,max_rss_kb,ipc,instructions,
+//             cycles,cache_misses,cache_refs,task_clock_ms,gflops,region,
+//             dtlb_misses
+//             con una fila por hilo (region = nombre#tid, threads = 1) y una
+//             fila total (region = nombre): suma de contadores, elapsed_s del
+//             hilo más lento y gflops = flops * llamadas / elapsed_s.
+// Compilar con -I<raíz>/common <raíz>/common/perf_region.c.
+
+#include <stdint.h>
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_REFS,
+    PERF_LLC_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_TASK_CLOCK,    // ns
+    PERF_NEV
+};
+
+typedef struct {
+    int fd[PERF_NEV];           // -1 si el evento no está disponible
+    int opened;
+    long calls;
+    double t0, secs;
+    uint64_t b[PERF_NEV][3];    // lectura al entrar: valor, t. habilitado, t. activo
+    uint64_t v[PERF_NEV];       // acumulado y escalado
+    char pad[64];               // hilos vecinos en líneas de caché distintas
+} perf_thread_t;
+
+typedef struct {
+    char name[64];
+    int enabled;            // PERF_CSV definido
+    int nthreads;
+    perf_thread_t *t;
+} perf_region_t;
+
+int perf_region_init(perf_region_t *r, const char *name, int nthreads);
+
+// tid en [0, nthreads); cada hilo solo toca su propia entrada. Con r = NULL
+// no hacen nada (p. ej. en las repeticiones de calentamiento).
+void perf_region_begin(perf_region_t *r, int tid);
+void perf_region_end(perf_region_t *r, int tid);
+
+// Filas en PERF_CSV. flops: trabajo de una llamada (0 deja gflops vacío).
+void perf_region_report(const perf_region_t *r, const char *impl, long long n, double flops);
+
+void perf_region_free(perf_region_t *r);
+#endif
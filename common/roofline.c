@@ -0,0 +1,167 @@
+// roofline.c — Techos del modelo roofline de la máquina: pico de FMA en
+// doble precisión y ancho de banda tipo STREAM (triad) por nivel de caché.
+// Compilar:  gcc -O3 -march=native -fopenmp roofline.c -o roofline
+// Uso:       ./roofline [threads] [salida.csv]
+// Notas:
+//  - Pico: cada hilo encadena FMA independientes sobre 64 acumuladores
+//    (suficientes para cubrir la latencia con AVX2 y AVX-512).
+//  - Ancho de banda: a[i] = b[i] + s*c[i] con arreglos privados por hilo de
+//    la mitad del nivel (L1, L2 por núcleo; L3 repartida entre los hilos) y
+//    4x la L3 (acotada) para la DRAM. Se cuentan 24 bytes por elemento, como STREAM
+//    (sin la lectura de la asignación en escritura).
+//  - Cada medida se repite hasta cubrir ~0.2 s y se queda la mejor.
+//  - La salida añade una fila a salida.csv (roofline_machine.csv por defecto):
+//    host,threads,peak_gflops,l1_gbs,l2_gbs,l3_gbs,dram_gbs
+//    que generate_summary.py --roofline combina con ROOFLINE_CSV (bench.h).
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <omp.h>
+
+#define ACC 64
+#define MIN_SECS 0.2
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Tamaño de un nivel de caché en bytes (glibc) o el valor por defecto.
+static long cache_bytes(int name, long def) {
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+    long v = sysconf(name);
+    return v > 0 ? v : def;
+#else
+    (void)name;
+    return def;
+#endif
+}
+
+// GFLOP/s de FMA con todos los hilos; cada iteración son 2*ACC flops.
+static double peak_gflops(int threads) {
+    double best = 0.0;
+    long iters = 1 << 16;
+    for (;;) {
+        double sink = 0.0;
+        double t0 = now_s();
+        #pragma omp parallel num_threads(threads) reduction(+:sink)
+        {
+            double acc[ACC];
+            const double a = 1.0 + 1e-9 * omp_get_thread_num(), c = 1e-9;
+            for (int j = 0; j < ACC; j++) acc[j] = (double)j;
+            for (long it = 0; it < iters; it++) {
+                #pragma omp simd
+                for (int j = 0; j < ACC; j++) acc[j] = acc[j] * a + c;
+            }
+            for (int j = 0; j < ACC; j++) sink += acc[j];
+        }
+        double secs = now_s() - t0;
+        if (sink == 42.0) fprintf(stderr, " ");    // que no se elimine el cálculo
+        double g = 2.0 * ACC * (double)iters * threads / secs / 1e9;
+        if (g > best) best = g;
+        if (secs >= MIN_SECS) break;
+        iters *= 2;
+    }
+    return best;
+}
+
+// GB/s de triad con arreglos privados de per_thread bytes (los tres) por hilo.
+static double triad_gbs(int threads, size_t per_thread) {
+    size_t n = per_thread / (3 * sizeof(double));
+    if (n < 64) n = 64;
+    double best = 0.0;
+    long reps = 1;
+    int fail = 0;
+    for (;;) {
+        double t0 = 0.0, secs = 0.0;
+        #pragma omp parallel num_threads(threads)
+        {
+            double *a = NULL, *b = NULL, *c = NULL;
+            int ok = posix_memalign((void **)&a, 64, n * sizeof(double)) == 0 &&
+                     posix_memalign((void **)&b, 64, n * sizeof(double)) == 0 &&
+                     posix_memalign((void **)&c, 64, n * sizeof(double)) == 0;
+            if (!ok) {
+                #pragma omp atomic write
+                fail = 1;
+            } else {
+                // Primer toque en el hilo que usará los datos
+                for (size_t i = 0; i < n; i++) {
+                    a[i] = 0.0;
+                    b[i] = 1.0;
+                    c[i] = 2.0;
+                }
+            }
+            #pragma omp barrier
+            #pragma omp master
+            t0 = now_s();
+            #pragma omp barrier
+            if (ok) {
+                const double s = 3.0;
+                for (long r = 0; r < reps; r++) {
+                    #pragma omp simd
+                    for (size_t i = 0; i < n; i++) a[i] = b[i] + s * c[i];
+                    __asm__ __volatile__("" : : "r"(a) : "memory");
+                }
+            }
+            #pragma omp barrier
+            #pragma omp master
+            secs = now_s() - t0;
+            free(a);
+            free(b);
+            free(c);
+        }
+        if (fail) return 0.0;
+        double g = 24.0 * (double)n * (double)reps * threads / secs / 1e9;
+        if (g > best) best = g;
+        if (secs >= MIN_SECS) break;
+        reps *= 2;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int threads = (argc > 1) ? atoi(argv[1]) : omp_get_max_threads();
+    const char *out = (argc > 2) ? argv[2] : "roofline_machine.csv";
+    if (threads < 1) threads = 1;
+
+    long l1 = cache_bytes(_SC_LEVEL1_DCACHE_SIZE, 32L << 10);
+    long l2 = cache_bytes(_SC_LEVEL2_CACHE_SIZE, 1L << 20);
+    long l3 = cache_bytes(_SC_LEVEL3_CACHE_SIZE, 32L << 20);
+
+    double peak = peak_gflops(threads);
+    double bw_l1 = triad_gbs(threads, (size_t)l1 / 2);
+    double bw_l2 = triad_gbs(threads, (size_t)l2 / 2);
+    double bw_l3 = triad_gbs(threads, (size_t)(l3 / 2 / threads));
+    // DRAM: 4x la L3 en total, entre 256 MB y 2 GB (algunas VM informan L3 enormes)
+    long dram = 4 * l3;
+    if (dram < (256L << 20)) dram = 256L << 20;
+    if (dram > (2048L << 20)) dram = 2048L << 20;
+    double bw_dram = triad_gbs(threads, (size_t)(dram / threads));
+
+    char host[64] = "desconocido";
+    gethostname(host, sizeof host);
+    host[sizeof host - 1] = '\0';
+
+    printf("host=%s, threads=%d\n", host, threads);
+    printf("Pico FMA: %.2f GFLOP/s\n", peak);
+    printf("Triad L1 (%ld KB): %.2f GB/s | L2 (%ld KB): %.2f GB/s | L3 (%ld KB): %.2f GB/s | DRAM: %.2f GB/s\n",
+           l1 >> 10, bw_l1, l2 >> 10, bw_l2, l3 >> 10, bw_l3, bw_dram);
+    printf("Punto de quiebre (DRAM): %.3f flop/byte\n", bw_dram > 0.0 ? peak / bw_dram : 0.0);
+
+    FILE *f = fopen(out, "a");
+    if (!f) {
+        fprintf(stderr, "No se puede abrir %s\n", out);
+        return 1;
+    }
+    if (ftell(f) == 0) {
+        fprintf(f, "host,threads,peak_gflops,l1_gbs,l2_gbs,l3_gbs,dram_gbs\n");
+    }
+    fprintf(f, "%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f\n", host, threads, peak, bw_l1, bw_l2, bw_l3, bw_dram);
+    fclose(f);
+    return 0;
+}
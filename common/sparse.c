@@ -0,0 +1,438 @@
+// sparse.c — matrices dispersas CSR/BSR, SpMV y SpMM (ver sparse.h).
+#include "sparse.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "cpu_isa.h"
+
+static unsigned long long splitmix64(unsigned long long *s) {
+    unsigned long long z = (*s += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniforme en [-1, 1)
+static double rand_val(unsigned long long *s) {
+    return (double)(splitmix64(s) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Reserva rowptr (nbrows + 1), col y val (nnzb * b * b, en cero si zero).
+static int sparse_alloc(sparse_t *A, size_t nrows, size_t ncols, int b, size_t nnzb, int zero) {
+    A->nrows = nrows;
+    A->ncols = ncols;
+    A->b = b;
+    A->nbrows = (nrows + (size_t)b - 1) / (size_t)b;
+    A->nnzb = nnzb;
+    size_t bb = (size_t)b * (size_t)b;
+    A->rowptr = (size_t *)arena_alloc((A->nbrows + 1) * sizeof(size_t));
+    A->col = (int *)arena_alloc((nnzb ? nnzb : 1) * sizeof(int));
+    A->val = zero ? (double *)arena_calloc(nnzb ? nnzb * bb : 1, sizeof(double))
+                  : (double *)arena_alloc((nnzb ? nnzb * bb : 1) * sizeof(double));
+    if (!A->rowptr || !A->col || !A->val) {
+        sparse_free(A);
+        return -1;
+    }
+    return 0;
+}
+
+// Con las longitudes de fila en rowptr[1..n], las acumula y llena cada fila
+// con columnas distintas al azar (Floyd) en orden creciente.
+static int fill_random_rows(sparse_t *A, size_t n, unsigned long long seed) {
+    A->rowptr[0] = 0;
+    for (size_t i = 0; i < n; i++) A->rowptr[i + 1] += A->rowptr[i];
+    size_t nnz = A->rowptr[n];
+    A->nnz = A->nnzb = nnz;
+    A->col = (int *)arena_alloc((nnz ? nnz : 1) * sizeof(int));
+    A->val = (double *)arena_alloc((nnz ? nnz : 1) * sizeof(double));
+    size_t *mark = (size_t *)malloc((n ? n : 1) * sizeof(size_t));
+    if (!A->col || !A->val || !mark) {
+        free(mark);
+        sparse_free(A);
+        return -1;
+    }
+    for (size_t j = 0; j < n; j++) mark[j] = SIZE_MAX;
+    for (size_t i = 0; i < n; i++) {
+        size_t len = A->rowptr[i + 1] - A->rowptr[i];
+        int *ci = &A->col[A->rowptr[i]];
+        size_t m = 0;
+        // Floyd: len columnas distintas de n con len sorteos
+        for (size_t j = n - len; j < n; j++) {
+            size_t t = (size_t)(splitmix64(&seed) % (j + 1));
+            size_t c = (mark[t] == i) ? j : t;
+            mark[c] = i;
+            ci[m++] = (int)c;
+        }
+        qsort(ci, len, sizeof(int), cmp_int);
+        for (size_t m2 = 0; m2 < len; m2++) A->val[A->rowptr[i] + m2] = rand_val(&seed);
+    }
+    free(mark);
+    return 0;
+}
+
+int sparse_random(sparse_t *A, size_t n, double per_row, double skew, unsigned long long seed) {
+    memset(A, 0, sizeof *A);
+    if (n > (size_t)INT32_MAX) return -1;
+    A->nrows = A->ncols = n;
+    A->b = 1;
+    A->nbrows = n;
+    A->rowptr = (size_t *)arena_calloc(n + 1, sizeof(size_t));
+    if (!A->rowptr) return -1;
+    if (per_row < 0.0) per_row = 0.0;
+    if (skew > 0.0) {
+        // Grado ~ c (i + 1)^-skew con c tal que el total sea n * per_row
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) sum += pow((double)(i + 1), -skew);
+        double c = sum > 0.0 ? per_row * (double)n / sum : 0.0;
+        for (size_t i = 0; i < n; i++) {
+            double len = floor(c * pow((double)(i + 1), -skew) + 0.5);
+            A->rowptr[i + 1] = len > (double)n ? n : (size_t)len;
+        }
+    } else {
+        unsigned long long span = (unsigned long long)floor(2.0 * per_row) + 1;
+        for (size_t i = 0; i < n; i++) {
+            size_t len = (size_t)(splitmix64(&seed) % span);
+            A->rowptr[i + 1] = len > n ? n : len;
+        }
+    }
+    return fill_random_rows(A, n, seed);
+}
+
+int sparse_banded(sparse_t *A, size_t n, size_t half_width, unsigned long long seed) {
+    memset(A, 0, sizeof *A);
+    if (n > (size_t)INT32_MAX) return -1;
+    if (half_width >= n) half_width = n ? n - 1 : 0;
+    size_t nnz = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t lo = i > half_width ? i - half_width : 0;
+        size_t hi = i + half_width < n ? i + half_width : n - 1;
+        nnz += hi - lo + 1;
+    }
+    if (sparse_alloc(A, n, n, 1, nnz, 0)) return -1;
+    A->nnz = nnz;
+    size_t p = 0;
+    A->rowptr[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t lo = i > half_width ? i - half_width : 0;
+        size_t hi = i + half_width < n ? i + half_width : n - 1;
+        for (size_t j = lo; j <= hi; j++) {
+            A->col[p] = (int)j;
+            A->val[p] = rand_val(&seed);
+            p++;
+        }
+        A->rowptr[i + 1] = p;
+    }
+    return 0;
+}
+
+int sparse_to_bsr(sparse_t *B, const sparse_t *A, int b) {
+    memset(B, 0, sizeof *B);
+    if (A->b != 1 || b < 1 || b > SPARSE_MAX_B) return -1;
+    size_t ub = (size_t)b, bb = ub * ub;
+    size_t nbrows = (A->nrows + ub - 1) / ub, nbcols = (A->ncols + ub - 1) / ub;
+    // mark[bc]: última fila de bloques que usó la columna de bloque bc;
+    // slot[bc]: su posición en la fila de bloques en curso
+    size_t *mark = (size_t *)malloc((nbcols ? nbcols : 1) * sizeof(size_t));
+    size_t *slot = (size_t *)malloc((nbcols ? nbcols : 1) * sizeof(size_t));
+    if (!mark || !slot) {
+        free(mark);
+        free(slot);
+        return -1;
+    }
+    for (size_t j = 0; j < nbcols; j++) mark[j] = SIZE_MAX;
+
+    // Primera pasada: bloques distintos por fila de bloques
+    size_t nnzb = 0;
+    for (size_t br = 0; br < nbrows; br++) {
+        size_t r1 = (br + 1) * ub < A->nrows ? (br + 1) * ub : A->nrows;
+        for (size_t r = br * ub; r < r1; r++) {
+            for (size_t p = A->rowptr[r]; p < A->rowptr[r + 1]; p++) {
+                size_t bc = (size_t)A->col[p] / ub;
+                if (mark[bc] != br) {
+                    mark[bc] = br;
+                    nnzb++;
+                }
+            }
+        }
+    }
+    if (sparse_alloc(B, A->nrows, A->ncols, b, nnzb, 1)) {
+        free(mark);
+        free(slot);
+        return -1;
+    }
+    B->nnz = A->nnz;
+
+    // Segunda pasada: columnas de bloque ordenadas y valores en su bloque
+    for (size_t j = 0; j < nbcols; j++) mark[j] = SIZE_MAX;
+    size_t q = 0;
+    B->rowptr[0] = 0;
+    for (size_t br = 0; br < nbrows; br++) {
+        size_t r1 = (br + 1) * ub < A->nrows ? (br + 1) * ub : A->nrows;
+        size_t q0 = q;
+        for (size_t r = br * ub; r < r1; r++) {
+            for (size_t p = A->rowptr[r]; p < A->rowptr[r + 1]; p++) {
+                size_t bc = (size_t)A->col[p] / ub;
+                if (mark[bc] != br) {
+                    mark[bc] = br;
+                    B->col[q++] = (int)bc;
+                }
+            }
+        }
+        qsort(&B->col[q0], q - q0, sizeof(int), cmp_int);
+        for (size_t s = q0; s < q; s++) slot[B->col[s]] = s;
+        for (size_t r = br * ub; r < r1; r++) {
+            for (size_t p = A->rowptr[r]; p < A->rowptr[r + 1]; p++) {
+                size_t c = (size_t)A->col[p];
+                B->val[slot[c / ub] * bb + (r % ub) * ub + c % ub] = A->val[p];
+            }
+        }
+        B->rowptr[br + 1] = q;
+    }
+    free(mark);
+    free(slot);
+    return 0;
+}
+
+void sparse_free(sparse_t *A) {
+    arena_free(A->rowptr);
+    arena_free(A->col);
+    arena_free(A->val);
+    A->rowptr = NULL;
+    A->col = NULL;
+    A->val = NULL;
+}
+
+// Trabajo de las filas de bloques [0, br): b^2 por bloque guardado más b por
+// fila (escribir Y y leer rowptr cuesta aunque la fila esté vacía)
+static double part_cost(const sparse_t *A, size_t br) {
+    return (double)A->rowptr[br] * A->b * A->b + (double)br * A->b;
+}
+
+int sparse_partition(sparse_part_t *p, const sparse_t *A, int parts, sparse_part_mode_t mode) {
+    if (parts < 1) parts = 1;
+    p->parts = parts;
+    p->bounds = (size_t *)malloc(((size_t)parts + 1) * sizeof(size_t));
+    if (!p->bounds) return -1;
+    p->bounds[0] = 0;
+    double total = part_cost(A, A->nbrows);
+    for (int t = 1; t < parts; t++) {
+        if (mode == SPARSE_PART_ROWS) {
+            p->bounds[t] = (size_t)t * A->nbrows / (size_t)parts;
+            continue;
+        }
+        // Primera fila de bloques donde el trabajo acumulado llega a t/parts
+        double target = total * t / parts;
+        size_t lo = p->bounds[t - 1], hi = A->nbrows;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (part_cost(A, mid) < target) lo = mid + 1; else hi = mid;
+        }
+        p->bounds[t] = lo;
+    }
+    p->bounds[parts] = A->nbrows;
+    return 0;
+}
+
+void sparse_part_free(sparse_part_t *p) {
+    free(p->bounds);
+    p->bounds = NULL;
+}
+
+double sparse_part_imbalance(const sparse_part_t *p, const sparse_t *A) {
+    double total = part_cost(A, A->nbrows), worst = 0.0;
+    if (total <= 0.0) return 1.0;
+    for (int t = 0; t < p->parts; t++) {
+        double w = part_cost(A, p->bounds[t + 1]) - part_cost(A, p->bounds[t]);
+        if (w > worst) worst = w;
+    }
+    return worst * p->parts / total;
+}
+
+// CSR, k = 1: producto punto de la fila con x (gather de x por col)
+static inline CPU_ISA_INLINE void csr_spmv_body(const sparse_t *A, size_t r0, size_t r1, const double *x,
+                                                double *y) {
+    const size_t *rp = A->rowptr;
+    const int *col = A->col;
+    const double *val = A->val;
+    for (size_t i = r0; i < r1; i++) {
+        double s = 0.0;
+        #pragma omp simd reduction(+:s)
+        for (size_t p = rp[i]; p < rp[i + 1]; p++) s += val[p] * x[col[p]];
+        y[i] = s;
+    }
+}
+CPU_ISA_CLONES(csr_spmv, void, (const sparse_t *A, size_t r0, size_t r1, const double *x, double *y),
+               (A, r0, r1, x, y))
+
+// CSR, k > 1: fila i de Y = sum a_ij * fila j de X (contiguas en k)
+static inline CPU_ISA_INLINE void csr_spmm_body(const sparse_t *A, size_t r0, size_t r1, const double *X,
+                                                size_t k, double *Y) {
+    const size_t *rp = A->rowptr;
+    for (size_t i = r0; i < r1; i++) {
+        double *Yi = &Y[i * k];
+        for (size_t c = 0; c < k; c++) Yi[c] = 0.0;
+        for (size_t p = rp[i]; p < rp[i + 1]; p++) {
+            const double a = A->val[p];
+            const double *Xj = &X[(size_t)A->col[p] * k];
+            #pragma omp simd
+            for (size_t c = 0; c < k; c++) Yi[c] += a * Xj[c];
+        }
+    }
+}
+CPU_ISA_CLONES(csr_spmm, void,
+               (const sparse_t *A, size_t r0, size_t r1, const double *X, size_t k, double *Y),
+               (A, r0, r1, X, k, Y))
+
+// BSR, k = 1: cada bloque de b x b por el tramo de b elementos de x. Se
+// expande con b constante (2, 4, 8) para que los bucles del bloque se
+// desenrollen; solo los bloques del borde derecho usan el ancho recortado.
+static inline CPU_ISA_INLINE void bsr_spmv_fixed(const sparse_t *A, size_t br0, size_t br1, const double *x,
+                                                 double *y, const size_t b) {
+    const size_t bb = b * b;
+    double acc[SPARSE_MAX_B];
+    for (size_t br = br0; br < br1; br++) {
+        size_t ih = (br + 1) * b <= A->nrows ? b : A->nrows - br * b;
+        for (size_t r = 0; r < b; r++) acc[r] = 0.0;
+        for (size_t p = A->rowptr[br]; p < A->rowptr[br + 1]; p++) {
+            size_t c0 = (size_t)A->col[p] * b;
+            const double *blk = &A->val[p * bb];
+            const double *xb = &x[c0];
+            if (c0 + b <= A->ncols) {
+                for (size_t r = 0; r < b; r++) {
+                    double s = 0.0;
+                    for (size_t j = 0; j < b; j++) s += blk[r * b + j] * xb[j];
+                    acc[r] += s;
+                }
+            } else {
+                size_t jw = A->ncols - c0;
+                for (size_t r = 0; r < b; r++) {
+                    for (size_t j = 0; j < jw; j++) acc[r] += blk[r * b + j] * xb[j];
+                }
+            }
+        }
+        for (size_t r = 0; r < ih; r++) y[br * b + r] = acc[r];
+    }
+}
+
+static inline CPU_ISA_INLINE void bsr_spmv_body(const sparse_t *A, size_t br0, size_t br1, const double *x,
+                                                double *y) {
+    switch (A->b) {
+    case 2: bsr_spmv_fixed(A, br0, br1, x, y, 2); break;
+    case 4: bsr_spmv_fixed(A, br0, br1, x, y, 4); break;
+    case 8: bsr_spmv_fixed(A, br0, br1, x, y, 8); break;
+    default: bsr_spmv_fixed(A, br0, br1, x, y, (size_t)A->b); break;
+    }
+}
+CPU_ISA_CLONES(bsr_spmv, void, (const sparse_t *A, size_t br0, size_t br1, const double *x, double *y),
+               (A, br0, br1, x, y))
+
+// BSR, k > 1: cada elemento del bloque escala una fila de X sobre una de Y
+static inline CPU_ISA_INLINE void bsr_spmm_fixed(const sparse_t *A, size_t br0, size_t br1, const double *X,
+                                                 size_t k, double *Y, const size_t b) {
+    const size_t bb = b * b;
+    for (size_t br = br0; br < br1; br++) {
+        size_t ih = (br + 1) * b <= A->nrows ? b : A->nrows - br * b;
+        double *Yb = &Y[br * b * k];
+        for (size_t c = 0; c < ih * k; c++) Yb[c] = 0.0;
+        for (size_t p = A->rowptr[br]; p < A->rowptr[br + 1]; p++) {
+            size_t c0 = (size_t)A->col[p] * b;
+            size_t jw = c0 + b <= A->ncols ? b : A->ncols - c0;
+            const double *blk = &A->val[p * bb];
+            for (size_t r = 0; r < ih; r++) {
+                double *Yr = &Yb[r * k];
+                for (size_t j = 0; j < jw; j++) {
+                    const double a = blk[r * b + j];
+                    const double *Xj = &X[(c0 + j) * k];
+                    #pragma omp simd
+                    for (size_t c = 0; c < k; c++) Yr[c] += a * Xj[c];
+                }
+            }
+        }
+    }
+}
+
+static inline CPU_ISA_INLINE void bsr_spmm_body(const sparse_t *A, size_t br0, size_t br1, const double *X,
+                                                size_t k, double *Y) {
+    switch (A->b) {
+    case 2: bsr_spmm_fixed(A, br0, br1, X, k, Y, 2); break;
+    case 4: bsr_spmm_fixed(A, br0, br1, X, k, Y, 4); break;
+    case 8: bsr_spmm_fixed(A, br0, br1, X, k, Y, 8); break;
+    default: bsr_spmm_fixed(A, br0, br1, X, k, Y, (size_t)A->b); break;
+    }
+}
+CPU_ISA_CLONES(bsr_spmm, void,
+               (const sparse_t *A, size_t br0, size_t br1, const double *X, size_t k, double *Y),
+               (A, br0, br1, X, k, Y))
+
+void sparse_rows(const sparse_t *A, size_t br0, size_t br1, const double *X, size_t k, double *Y) {
+    if (A->b == 1) {
+        if (k == 1) csr_spmv_isa[cpu_isa_level](A, br0, br1, X, Y);
+        else csr_spmm_isa[cpu_isa_level](A, br0, br1, X, k, Y);
+    } else {
+        if (k == 1) bsr_spmv_isa[cpu_isa_level](A, br0, br1, X, Y);
+        else bsr_spmm_isa[cpu_isa_level](A, br0, br1, X, k, Y);
+    }
+}
+
+void sparse_spmm(const sparse_t *A, const sparse_part_t *p, const double *X, size_t k, double *Y) {
+    // Parte t al hilo t: cada hilo toca siempre las mismas filas de Y
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(static, 1) num_threads(p->parts)
+#endif
+    for (int t = 0; t < p->parts; t++) {
+        sparse_rows(A, p->bounds[t], p->bounds[t + 1], X, k, Y);
+    }
+}
+
+void sparse_spmv(const sparse_t *A, const sparse_part_t *p, const double *x, double *y) {
+    sparse_spmm(A, p, x, 1, y);
+}
+
+double sparse_flops(const sparse_t *A, size_t k) {
+    return 2.0 * (double)A->nnz * (double)k;
+}
+
+double sparse_bytes(const sparse_t *A, size_t k) {
+    double bb = (double)A->b * A->b;
+    return 8.0 * A->nnzb * bb + 4.0 * A->nnzb + 8.0 * (A->nbrows + 1)
+         + 8.0 * A->ncols * k + 8.0 * A->nrows * k;
+}
+
+int sparse_check(const sparse_t *A, const double *X, size_t k, const double *Y, double *max_rel,
+                 size_t *bad_row) {
+    int ok = 1;
+    *max_rel = 0.0;
+    *bad_row = 0;
+    if (A->b != 1) return 0;
+    for (size_t i = 0; i < A->nrows; i++) {
+        size_t len = A->rowptr[i + 1] - A->rowptr[i];
+        double tol = 4.0 * ((double)len + 2.0) * DBL_EPSILON;
+        for (size_t c = 0; c < k; c++) {
+            double s = 0.0, mag = 0.0;
+            for (size_t p = A->rowptr[i]; p < A->rowptr[i + 1]; p++) {
+                double t = A->val[p] * X[(size_t)A->col[p] * k + c];
+                s += t;
+                mag += fabs(t);
+            }
+            double d = fabs(Y[i * k + c] - s);
+            double rel = mag > 0.0 ? d / mag : d;
+            if (rel > *max_rel || rel != rel) *max_rel = rel;
+            // !(<=) también atrapa NaN
+            if (ok && !(rel <= tol)) {
+                ok = 0;
+                *bad_row = i;
+            }
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,100 @@
+#ifndef SPARSE_H
+#define SPARSE_H
+// Matrices dispersas en CSR y en CSR por bloques (BSR) con productos
+// matriz-vector (SpMV) y matriz dispersa por densa (SpMM) repartidos entre
+// hilos OpenMP por número de no ceros, no por filas.
+//
+//   sparse_t A, Ab;
+//   sparse_random(&A, n, 16.0, 0.0, 42);     // CSR n x n, ~16 no ceros por fila
+//   sparse_to_bsr(&Ab, &A, 4);               // bloques de 4 x 4 (opcional)
+//   sparse_part_t p;
+//   sparse_partition(&p, &Ab, threads, SPARSE_PART_NNZ);
+//   sparse_spmm(&Ab, &p, X, k, Y);           // Y = A X, X de n x k por filas
+//   ...
+//   sparse_part_free(&p); sparse_free(&Ab); sparse_free(&A);
+//
+// Un solo tipo para los dos formatos: CSR es BSR con bloques de 1 x 1. rowptr
+// indexa filas de bloques y col guarda la columna de bloque (int: 4 B por no
+// cero en lugar de 8, el tráfico de índices pesa tanto como el de valores).
+// Cada bloque se guarda por filas y completo, con ceros de relleno donde la
+// matriz no tenía nada; los bloques del borde se recortan al calcular.
+//
+// El reparto por filas deja a un hilo todas las filas densas de una matriz de
+// grado sesgado (sparse_random con skew > 0); por no ceros cada hilo recibe
+// un tramo contiguo de filas con ~nnz/hilos de trabajo (búsqueda binaria
+// sobre rowptr). Con MPI el mismo reparto decide qué filas van a cada rank.
+//
+// Los arreglos salen del arena (arena.h): no es seguro entre hilos crear o
+// liberar matrices dentro de regiones paralelas.
+// Compilar con -I<raíz>/common <raíz>/common/sparse.c <raíz>/common/arena.c
+// (con -fopenmp los productos se reparten entre hilos).
+
+#include <stddef.h>
+
+#define SPARSE_MAX_B 64
+
+typedef struct {
+    size_t nrows, ncols;    // en elementos
+    int b;                  // lado del bloque: 1 = CSR
+    size_t nbrows;          // filas de bloques: ceil(nrows / b)
+    size_t nnzb;            // bloques guardados (= nnz con b = 1)
+    size_t nnz;             // no ceros de la matriz, sin el relleno de los bloques
+    size_t *rowptr;         // nbrows + 1
+    int *col;               // nnzb columnas de bloque, crecientes en cada fila
+    double *val;            // nnzb * b * b
+} sparse_t;
+
+typedef enum { SPARSE_PART_NNZ, SPARSE_PART_ROWS } sparse_part_mode_t;
+
+typedef struct {
+    int parts;
+    size_t *bounds;         // parts + 1 filas de bloques: la parte t es [bounds[t], bounds[t+1])
+} sparse_part_t;
+
+// CSR n x n con ~per_row no ceros por fila en columnas al azar y valores en
+// [-1, 1). skew = 0: cada fila con 0..2*per_row no ceros; skew > 0: la fila i
+// con un número proporcional a (i + 1)^-skew (las primeras, las más densas).
+// 0 si todo fue bien, -1 si no hay memoria.
+int sparse_random(sparse_t *A, size_t n, double per_row, double skew, unsigned long long seed);
+
+// CSR n x n con las diagonales |i - j| <= half_width y valores en [-1, 1).
+int sparse_banded(sparse_t *A, size_t n, size_t half_width, unsigned long long seed);
+
+// B = A (CSR) en bloques de b x b (1 <= b <= SPARSE_MAX_B). -1 si no hay
+// memoria, A no es CSR o b está fuera de rango.
+int sparse_to_bsr(sparse_t *B, const sparse_t *A, int b);
+
+void sparse_free(sparse_t *A);
+
+// Reparte las filas de bloques de A en parts tramos contiguos.
+int sparse_partition(sparse_part_t *p, const sparse_t *A, int parts, sparse_part_mode_t mode);
+
+void sparse_part_free(sparse_part_t *p);
+
+// Máximo trabajo de una parte sobre el promedio (1 = equilibrio perfecto),
+// contando no ceros guardados.
+double sparse_part_imbalance(const sparse_part_t *p, const sparse_t *A);
+
+// Filas de bloques [br0, br1) de Y = A X (X de ncols x k, Y de nrows x k, por
+// filas), en el hilo que llama. Con k = 1 es el SpMV.
+void sparse_rows(const sparse_t *A, size_t br0, size_t br1, const double *X, size_t k, double *Y);
+
+// Y = A X con una parte de p por hilo (el hilo t calcula la parte t).
+void sparse_spmm(const sparse_t *A, const sparse_part_t *p, const double *X, size_t k, double *Y);
+
+// y = A x.
+void sparse_spmv(const sparse_t *A, const sparse_part_t *p, const double *x, double *y);
+
+// Operaciones útiles de Y = A X: 2 nnz k (sin contar el relleno).
+double sparse_flops(const sparse_t *A, size_t k);
+
+// Tráfico mínimo de Y = A X: valores, índices y rowptr una vez, X leída y Y
+// escrita una vez cada una (X entera en caché). Con él, GB/s efectivos.
+double sparse_bytes(const sparse_t *A, size_t k);
+
+// Compara Y con A X (A en CSR) fila por fila con la tolerancia de
+// freivalds.h: 4 (nnz_fila + 2) eps (|A| |X|)_i. 1 si todas pasan; si no,
+// *bad_row es la primera que falla. *max_rel: el mayor error relativo.
+int sparse_check(const sparse_t *A, const double *X, size_t k, const double *Y, double *max_rel,
+                 size_t *bad_row);
+#endif
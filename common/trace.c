@@ -0,0 +1,270 @@
+// trace.c — línea de tiempo por hilo en formato Chrome trace (ver trace.h).
+#include "trace.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define TRACE_MAX_THREADS 1024
+
+enum { RING_FREE, RING_OWNED, RING_RETIRED };
+
+typedef struct {
+    uint64_t t;         // ciclos
+    const char *name;
+    char ph;
+} trace_ev_t;
+
+typedef struct {
+    trace_ev_t *ev;
+    uint64_t head;      // eventos escritos desde el registro (no se reinicia)
+    int state;
+    char name[48];
+    char pad[64];       // anillos vecinos en líneas de caché distintas
+} trace_ring_t;
+
+int trace_enabled;
+
+static trace_ring_t rings[TRACE_MAX_THREADS];
+static int nrings;              // anillos entregados (atómico)
+static long lost_threads;       // hilos sin anillo (atómico)
+static uint64_t cap = 1 << 16;  // eventos por anillo, potencia de 2
+static char process_name[64];
+static int process_pid;
+static uint64_t tick0;
+static double ns0;
+static __thread trace_ring_t *my_ring;
+// my_ring de los hilos que no consiguieron anillo: no vuelven a pedir uno
+static trace_ring_t no_ring;
+
+static double mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return 1e9 * (double)ts.tv_sec + (double)ts.tv_nsec;
+}
+
+static inline uint64_t ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)mono_ns();
+#endif
+}
+
+// Ciclos por µs medidos desde trace_init
+static double ticks_per_us(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    double dns = mono_ns() - ns0;
+    uint64_t dt = ticks() - tick0;
+    return dns > 0.0 ? 1e3 * (double)dt / dns : 1.0;
+#else
+    return 1e3;
+#endif
+}
+
+void trace_init(const char *process, int pid) {
+    const char *path = getenv("TRACE_JSON");
+    trace_enabled = path && *path;
+    if (!trace_enabled) return;
+    const char *s = getenv("TRACE_EVENTS");
+    if (s && *s) {
+        long long want = atoll(s);
+        cap = 1;
+        while ((long long)cap < want && cap < ((uint64_t)1 << 30)) cap <<= 1;
+    }
+    snprintf(process_name, sizeof process_name, "%s", process);
+    process_pid = pid;
+    ns0 = mono_ns();
+    tick0 = ticks();
+}
+
+static trace_ring_t *trace_register(void) {
+    // Primero un anillo que un hilo terminado haya soltado
+    int n = __atomic_load_n(&nrings, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < n && i < TRACE_MAX_THREADS; i++) {
+        int expect = RING_RETIRED;
+        if (__atomic_compare_exchange_n(&rings[i].state, &expect, RING_OWNED, 0, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED)) {
+            return my_ring = &rings[i];
+        }
+    }
+    int i = __atomic_fetch_add(&nrings, 1, __ATOMIC_ACQ_REL);
+    if (i >= TRACE_MAX_THREADS) {
+        __atomic_fetch_add(&lost_threads, 1, __ATOMIC_RELAXED);
+        my_ring = &no_ring;
+        return NULL;
+    }
+    trace_ring_t *r = &rings[i];
+    // El propio hilo reserva (y toca primero) su anillo
+    r->ev = (trace_ev_t *)calloc(cap, sizeof(trace_ev_t));
+    snprintf(r->name, sizeof r->name, "hilo %d", i);
+    __atomic_store_n(&r->state, RING_OWNED, __ATOMIC_RELEASE);
+    return my_ring = r;
+}
+
+void trace_event(const char *name, char ph) {
+    trace_ring_t *r = my_ring ? my_ring : trace_register();
+    if (!r || !r->ev) return;
+    trace_ev_t *e = &r->ev[r->head & (cap - 1)];
+    e->t = ticks();
+    e->name = name;
+    e->ph = ph;
+    r->head++;
+}
+
+void trace_thread_name(const char *fmt, ...) {
+    if (!trace_enabled) return;
+    trace_ring_t *r = my_ring ? my_ring : trace_register();
+    if (!r || r == &no_ring) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(r->name, sizeof r->name, fmt, ap);
+    va_end(ap);
+}
+
+void trace_thread_exit(void) {
+    if (!my_ring || my_ring == &no_ring) return;
+    __atomic_store_n(&my_ring->state, RING_RETIRED, __ATOMIC_RELEASE);
+    my_ring = NULL;
+}
+
+double trace_now_us(void) {
+    if (!trace_enabled) return 0.0;
+    return (double)(ticks() - tick0) / ticks_per_us();
+}
+
+typedef struct {
+    char *p;
+    size_t len, cap;
+    int fail;
+} sbuf_t;
+
+static void sb_printf(sbuf_t *b, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static void sb_printf(sbuf_t *b, const char *fmt, ...) {
+    if (b->fail) return;
+    for (;;) {
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(b->p ? b->p + b->len : NULL, b->p ? b->cap - b->len : 0, fmt, ap);
+        va_end(ap);
+        if (n < 0) {
+            b->fail = 1;
+            return;
+        }
+        if (b->p && b->len + (size_t)n < b->cap) {
+            b->len += (size_t)n;
+            return;
+        }
+        size_t ncap = b->cap ? 2 * b->cap : 1 << 16;
+        while (ncap <= b->len + (size_t)n) ncap *= 2;
+        char *np = (char *)realloc(b->p, ncap);
+        if (!np) {
+            b->fail = 1;
+            return;
+        }
+        b->p = np;
+        b->cap = ncap;
+    }
+}
+
+// Nombre como cadena JSON (sin comillas ni barras invertidas ni controles)
+static void sb_name(sbuf_t *b, const char *s) {
+    sb_printf(b, "\"");
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            sb_printf(b, "\\%c", c);
+        } else if (c < 0x20) {
+            sb_printf(b, "\\u%04x", c);
+        } else {
+            sb_printf(b, "%c", c);
+        }
+    }
+    sb_printf(b, "\"");
+}
+
+int trace_format(char **buf, size_t *len, double shift_us) {
+    sbuf_t b = { 0 };
+    double per_us = ticks_per_us();
+    int n = __atomic_load_n(&nrings, __ATOMIC_ACQUIRE);
+    if (n > TRACE_MAX_THREADS) n = TRACE_MAX_THREADS;
+
+    sb_printf(&b, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":", process_pid);
+    sb_name(&b, process_name);
+    sb_printf(&b, "}}");
+    for (int i = 0; i < n; i++) {
+        trace_ring_t *r = &rings[i];
+        if (!r->ev) continue;
+        sb_printf(&b, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":",
+                  process_pid, i);
+        sb_name(&b, r->name);
+        sb_printf(&b, "}}");
+        uint64_t first = r->head > cap ? r->head - cap : 0;
+        int depth = 0;
+        for (uint64_t k = first; k < r->head; k++) {
+            const trace_ev_t *e = &r->ev[k & (cap - 1)];
+            // Tras pisar el anillo pueden quedar finales sin su comienzo
+            if (e->ph == 'E') {
+                if (depth == 0) continue;
+                depth--;
+            } else {
+                depth++;
+            }
+            double ts = (double)(int64_t)(e->t - tick0) / per_us + shift_us;
+            sb_printf(&b, ",\n{\"name\":");
+            sb_name(&b, e->name);
+            sb_printf(&b, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d}", e->ph, ts, process_pid, i);
+        }
+    }
+    if (b.fail) {
+        free(b.p);
+        *buf = NULL;
+        *len = 0;
+        fprintf(stderr, "trace: error de memoria al formatear.\n");
+        return -1;
+    }
+    *buf = b.p;
+    *len = b.len;
+    return 0;
+}
+
+int trace_write(const char *body, size_t len) {
+    const char *path = getenv("TRACE_JSON");
+    if (!path || !*path) return 0;
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror("trace: TRACE_JSON");
+        return -1;
+    }
+    fputs("{\"traceEvents\":[\n", f);
+    fwrite(body, 1, len, f);
+    fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+    int rc = fclose(f) == 0 ? 0 : -1;
+
+    long events = 0, overwritten = 0;
+    int n = __atomic_load_n(&nrings, __ATOMIC_ACQUIRE);
+    if (n > TRACE_MAX_THREADS) n = TRACE_MAX_THREADS;
+    for (int i = 0; i < n; i++) {
+        events += (long)(rings[i].head < cap ? rings[i].head : cap);
+        if (rings[i].head > cap) overwritten += (long)(rings[i].head - cap);
+    }
+    fprintf(stderr, "trace: %s hilos=%d eventos=%ld pisados=%ld sin_anillo=%ld\n", path, n, events, overwritten,
+            lost_threads);
+    return rc;
+}
+
+int trace_dump(void) {
+    if (!trace_enabled) return 0;
+    char *body;
+    size_t len;
+    if (trace_format(&body, &len, 0.0) != 0) return -1;
+    int rc = trace_write(body, len);
+    free(body);
+    return rc;
+}
@@ -0,0 +1,142 @@
+#ifndef TRACE_H
+#define TRACE_H
+// Línea de tiempo por hilo en el formato de eventos de Chrome (se abre en
+// chrome://tracing o https://ui.perfetto.dev): cuándo calcula cada hilo o rank,
+// cuándo espera en una barrera y cuándo está bloqueado en comunicación.
+//
+//   trace_init("mm_blocked", 0);       // pid del proceso en el visor
+//   #pragma omp parallel
+//   {
+//       trace_thread_name("omp %d", omp_get_thread_num());
+//       TRACE_BEGIN("tiles");
+//       ...
+//       TRACE_END("tiles");
+//   }
+//   trace_dump();                      // escribe TRACE_JSON
+//
+// Cada hilo escribe en su propio anillo de eventos, sin cerrojos: se registra
+// la primera vez que emite (un fetch-and-add atómico) y desde ahí solo él
+// toca su anillo. Un evento son el contador de ciclos (rdtsc; reloj monótono
+// fuera de x86), el puntero al nombre y la fase: ~10 ns. Al llenarse el anillo
+// se pisan los eventos más viejos y queda el final de la corrida. Los ciclos
+// se pasan a µs con una calibración contra CLOCK_MONOTONIC entre trace_init y
+// el volcado (TSC invariante, como en toda CPU x86 reciente).
+//
+// Hilos efímeros (pthreads creados en cada repetición) llaman
+// trace_thread_exit() al terminar: su anillo queda libre y el siguiente hilo
+// que se registre lo reutiliza, en el mismo carril del visor.
+//
+// Con MPI, si mpi.h se incluye antes que este archivo, trace_dump_mpi(comm)
+// junta los eventos de todos los ranks en un solo archivo escrito por el rank
+// 0 (pid = rank), con los relojes alineados a la salida de una barrera.
+//
+// Variables de entorno:
+//   TRACE_JSON    archivo de salida; sin ella las macros solo leen una bandera
+//                 y trace_dump no hace nada
+//   TRACE_EVENTS  eventos por hilo (potencia de 2; 65536 por defecto, 24 B
+//                 cada uno)
+// Los nombres de los eventos deben vivir hasta el volcado (literales). Volcar
+// cuando ningún hilo esté emitiendo.
+// Compilar con -I<raíz>/common <raíz>/common/trace.c.
+
+#include <stddef.h>
+
+extern int trace_enabled;
+
+#define TRACE_BEGIN(name)                           \
+    do {                                            \
+        if (trace_enabled) trace_event((name), 'B'); \
+    } while (0)
+#define TRACE_END(name)                             \
+    do {                                            \
+        if (trace_enabled) trace_event((name), 'E'); \
+    } while (0)
+
+// process: nombre del proceso en el visor; pid: su número (rank MPI o 0).
+void trace_init(const char *process, int pid);
+
+// ph: 'B' (comienza) o 'E' (termina) un tramo del hilo que llama.
+void trace_event(const char *name, char ph);
+
+// Nombre del carril del hilo que llama (lo registra si hace falta).
+void trace_thread_name(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// El hilo ya no emitirá más: su anillo puede pasar a otro hilo.
+void trace_thread_exit(void);
+
+// µs desde trace_init.
+double trace_now_us(void);
+
+// Eventos de este proceso como objetos JSON separados por comas, con shift_us
+// sumado a cada marca de tiempo. *buf se libera con free. -1 si no hay memoria.
+int trace_format(char **buf, size_t *len, double shift_us);
+
+// Escribe {"traceEvents":[body]} en TRACE_JSON y resume por stderr.
+int trace_write(const char *body, size_t len);
+
+// trace_format + trace_write para un solo proceso.
+int trace_dump(void);
+
+#ifdef MPI_VERSION
+#include <stdlib.h>
+#include <string.h>
+
+static inline int trace_dump_mpi(MPI_Comm comm) {
+    if (!trace_enabled) return 0;
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Todos salen de la barrera casi a la vez: ese instante es el mismo en
+    // todos los relojes
+    MPI_Barrier(comm);
+    double now = trace_now_us(), root = now;
+    MPI_Bcast(&root, 1, MPI_DOUBLE, 0, comm);
+
+    // Cada rank trae al menos su metadato de proceso: los que no son el 0
+    // anteponen la coma que los separa del anterior
+    char *mine = NULL;
+    size_t len = 0;
+    if (trace_format(&mine, &len, root - now) != 0) len = 0;
+    if (rank > 0 && len > 0) {
+        char *p = (char *)realloc(mine, len + 1);
+        if (p) {
+            memmove(p + 1, p, len);
+            p[0] = ',';
+            mine = p;
+            len++;
+        } else {
+            len = 0;
+        }
+    }
+    int n = (int)len;
+    int *lens = NULL, *offs = NULL;
+    char *all = NULL;
+    if (rank == 0) {
+        lens = (int *)malloc((size_t)size * sizeof(int));
+        offs = (int *)malloc((size_t)size * sizeof(int));
+    }
+    MPI_Gather(&n, 1, MPI_INT, lens, 1, MPI_INT, 0, comm);
+    int total = 0;
+    if (rank == 0) {
+        for (int r = 0; r < size; r++) {
+            offs[r] = total;
+            total += lens[r];
+        }
+        all = (char *)malloc((size_t)total + 1);
+    }
+    MPI_Gatherv(mine, n, MPI_CHAR, all, lens, offs, MPI_CHAR, 0, comm);
+    free(mine);
+
+    int rc = 0;
+    if (rank == 0) {
+        rc = all ? trace_write(all, (size_t)total) : -1;
+        free(all);
+        free(lens);
+        free(offs);
+    }
+    MPI_Bcast(&rc, 1, MPI_INT, 0, comm);
+    return rc;
+}
+#endif
+#endif